@@ -1,11 +1,45 @@
 {
+    "target_defaults": {
+        "conditions": [
+            ['OS=="mac"', {
+              'xcode_settings': {
+                'GCC_ENABLE_CPP_EXCEPTIONS': 'YES'
+              }
+            }]
+          ],
+        "include_dirs": [
+            "xmrig-override",
+            "xmrig",
+            "xmrig/3rdparty/argon2/include",
+            "xmrig/3rdparty/argon2/lib"
+        ],
+        "cflags_c": [
+            '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=8" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=7" || echo "-march=native -DXMRIG_FEATURE_ASM"))',
+            '<!@(./check_cpu.sh intel && echo -DCPU_INTEL || (./check_cpu.sh amd && (./check_cpu.sh amdnew && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
+            '<!@(./check_cpu.sh avx2 && echo -DHAVE_AVX2 || echo)',
+            '<!@(./check_cpu.sh sse2 && echo -DHAVE_SSE2 || echo)',
+            '<!@(./check_cpu.sh ssse3 && echo -DHAVE_SSSE3 || echo)',
+            '<!@(./check_cpu.sh avx512f && echo -DHAVE_AVX512F || echo)',
+            '<!@(./check_cpu.sh xop && echo -DHAVE_XOP || echo)',
+            "-std=gnu11      -fPIC -DNDEBUG -Ofast -fno-fast-math -w"
+        ],
+        "cflags_cc": [
+            '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=8" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=7" || echo "-march=native -DXMRIG_FEATURE_ASM"))',
+            '<!@(./check_cpu.sh intel && echo -DCPU_INTEL || (./check_cpu.sh amd && (./check_cpu.sh amdnew && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
+            '<!@(./check_cpu.sh avx512f && echo -DHAVE_AVX512F || echo)',
+            "-std=gnu++11 -s -fPIC -DNDEBUG -Ofast -fno-fast-math -fexceptions -fno-rtti -Wno-class-memaccess -w"
+        ],
+        'cflags!': [ '-fexceptions' ]
+    },
     "targets": [
         {
-            "target_name": "cryptonight-hashing",
+            # Hashing code shared by the addon and the verification daemon
+            "target_name": "hashing",
+            "type": "static_library",
             "conditions": [
-                ['OS=="mac"', {
-                  'xcode_settings': {
-                    'GCC_ENABLE_CPP_EXCEPTIONS': 'YES'
+                ['OS=="linux"', {
+                  'link_settings': {
+                    'libraries': [ '-lrt' ]
                   }
                 }]
               ],
@@ -14,16 +48,24 @@
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/asm/CryptonightR_template.S" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/r/CryptonightR_gen.cpp" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && (./check_cpu.sh avx2 && echo "xmrig/crypto/cn/gpu/cn_gpu_avx.cpp" || echo) || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && (./check_cpu.sh avx512f && echo "xmrig/crypto/cn/gpu/cn_gpu_avx512.cpp" || echo) || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/gpu/cn_gpu_ssse3.cpp" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null || echo "xmrig/crypto/cn/gpu/cn_gpu_arm.cpp" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig-override/backend/cpu/platform/BasicCpuInfo.cpp" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null || echo "xmrig-override/backend/cpu/platform/BasicCpuInfo_arm.cpp" || echo)',
-                "multihashing.cc",
                 "xmrig-override/backend/cpu/Cpu.cpp",
                 "c29b.cc",
                 "c29i.cc",
                 "c29s.cc",
                 "c29v.cc",
+                "hashing.cc",
+                "rx_cache_store.cc",
+                "shm_cache.cc",
+                "numa.cc",
+                "scan.cc",
+                "warmup.cc",
+                "ring.cc",
+                "capture.cc",
                 "xmrig/crypto/cn/c_blake256.c",
                 "xmrig/crypto/cn/c_groestl.c",
                 "xmrig/crypto/cn/c_jh.c",
@@ -34,6 +76,7 @@
                 "xmrig/crypto/cn/CnCtx.cpp",
                 "xmrig/crypto/cn/CnHash.cpp",
                 "xmrig/crypto/common/MemoryPool.cpp",
+                "xmrig/crypto/common/HugePagesInfo.cpp",
                 "xmrig/crypto/common/VirtualMemory.cpp",
                 "xmrig/crypto/common/VirtualMemory_unix.cpp",
 
@@ -116,29 +159,34 @@
                 "xmrig/3rdparty/libethash/keccakf800.c",
                 "xmrig/3rdparty/libethash/ethash_internal.c",
             ],
+        },
+        {
+            "target_name": "cryptonight-hashing",
+            "dependencies": [ "hashing" ],
+            "sources": [
+                "multihashing.cc"
+            ],
             "include_dirs": [
-                "xmrig-override",
-                "xmrig",
-                "xmrig/3rdparty/argon2/include",
-                "xmrig/3rdparty/argon2/lib",
                 "<!(node -e \"require('nan')\")"
+            ]
+        },
+        {
+            "target_name": "cryptonight-hashd",
+            "type": "executable",
+            "dependencies": [ "hashing" ],
+            "sources": [
+                "hashd.cc"
             ],
-            "cflags_c": [
-                '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=8" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=7" || echo "-march=native -DXMRIG_FEATURE_ASM"))',
-                '<!@(./check_cpu.sh intel && echo -DCPU_INTEL || (./check_cpu.sh amd && (./check_cpu.sh amdnew && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
-                '<!@(./check_cpu.sh avx2 && echo -DHAVE_AVX2 || echo)',
-                '<!@(./check_cpu.sh sse2 && echo -DHAVE_SSE2 || echo)',
-                '<!@(./check_cpu.sh ssse3 && echo -DHAVE_SSSE3 || echo)',
-                '<!@(./check_cpu.sh avx512f && echo -DHAVE_AVX512F || echo)',
-                '<!@(./check_cpu.sh xop && echo -DHAVE_XOP || echo)',
-                "-std=gnu11      -fPIC -DNDEBUG -Ofast -fno-fast-math -w"
-            ],
-            "cflags_cc": [
-                '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=8" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=7" || echo "-march=native -DXMRIG_FEATURE_ASM"))',
-                '<!@(./check_cpu.sh intel && echo -DCPU_INTEL || (./check_cpu.sh amd && (./check_cpu.sh amdnew && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
-                "-std=gnu++11 -s -fPIC -DNDEBUG -Ofast -fno-fast-math -fexceptions -fno-rtti -Wno-class-memaccess -w"
+            "libraries": [ "-luv", "-lpthread" ]
+        },
+        {
+            "target_name": "cryptonight-replay",
+            "type": "executable",
+            "dependencies": [ "hashing" ],
+            "sources": [
+                "replay.cc"
             ],
-            'cflags!': [ '-fexceptions' ]
+            "libraries": [ "-luv", "-lpthread" ]
         }
     ]
 }
@@ -0,0 +1,118 @@
+#include "capture.h"
+
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+#include "hashing.h"
+
+std::atomic<bool> capture_active(false);
+
+// Buffered so a record costs a memcpy while capturing, the file is flushed on close
+static const size_t CAPTURE_BUFFER_SIZE = 1 << 20;
+
+namespace {
+
+struct Capture {
+    ~Capture() {
+        close();
+    }
+
+    void close() {
+        capture_active = false;
+        if (file) fclose(file);
+        file = nullptr;
+    }
+
+    std::mutex mutex;
+    FILE* file = nullptr;
+    bool first = true;
+    std::chrono::steady_clock::time_point last;
+};
+
+} // namespace
+
+static Capture capture;
+
+static bool has_height(const uint8_t family) {
+    return family <= FAMILY_CN_HEAVY || family == FAMILY_ETHASH || family == FAMILY_ETCHASH;
+}
+
+static inline void put_le(uint8_t* p, uint64_t v, const int bytes) {
+    for (int i = 0; i < bytes; ++i, v >>= 8) p[i] = static_cast<uint8_t>(v);
+}
+
+static inline uint64_t get_le(const uint8_t* p, const int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; --i) v = v << 8 | p[i];
+    return v;
+}
+
+bool capture_open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.close();
+    capture.file = fopen(path.c_str(), "wb");
+    if (!capture.file) return false;
+    setvbuf(capture.file, nullptr, _IOFBF, CAPTURE_BUFFER_SIZE);
+    fwrite(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC), 1, capture.file);
+    capture.first  = true;
+    capture_active = true;
+    return true;
+}
+
+void capture_close() {
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    capture.close();
+}
+
+void capture_hash(const uint8_t family, const int algo, const uint8_t* payload, const size_t size, const uint64_t height, const uint8_t* seed_hash) {
+    if (size > CAPTURE_MAX_PAYLOAD) return;
+
+    std::lock_guard<std::mutex> lock(capture.mutex);
+    if (!capture.file) return;
+
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const uint64_t delta = capture.first ? 0 : std::chrono::duration_cast<std::chrono::microseconds>(now - capture.last).count();
+    capture.first = false;
+    capture.last  = now;
+
+    uint8_t header[8 + 8 + 32];
+    size_t header_size = 8;
+    put_le(header, delta < UINT32_MAX ? delta : UINT32_MAX, 4);
+    header[4] = family;
+    header[5] = static_cast<uint8_t>(algo);
+    put_le(header + 6, size, 2);
+    if (has_height(family)) {
+        put_le(header + header_size, height, 8);
+        header_size += 8;
+    }
+    if (family == FAMILY_RANDOMX) {
+        memcpy(header + header_size, seed_hash, 32);
+        header_size += 32;
+    }
+    fwrite(header, header_size, 1, capture.file);
+    fwrite(payload, size, 1, capture.file);
+}
+
+bool capture_read_header(FILE* file) {
+    char magic[sizeof(CAPTURE_MAGIC)];
+    return fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, CAPTURE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool capture_read(FILE* file, CaptureRecord& record) {
+    uint8_t header[8];
+    if (fread(header, sizeof(header), 1, file) != 1) return false;
+    record.time  += get_le(header, 4);
+    record.family = header[4];
+    record.algo   = header[5];
+    record.payload.resize(get_le(header + 6, 2));
+
+    record.height = 0;
+    if (has_height(record.family)) {
+        uint8_t height[8];
+        if (fread(height, sizeof(height), 1, file) != 1) return false;
+        record.height = get_le(height, 8);
+    }
+    if (record.family == FAMILY_RANDOMX && fread(record.seed_hash, sizeof(record.seed_hash), 1, file) != 1) return false;
+    return record.payload.empty() || fread(record.payload.data(), record.payload.size(), 1, file) == 1;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// Share stream capture: while a capture is open every hash request is appended to a binary log,
+// which cryptonight-replay (replay.cc) hashes again to measure a build against real traffic.
+// All fields are little endian:
+//
+//   header  "CNHCAP01"
+//   record  u32 microseconds since the previous record, u8 family, u8 algo, u16 payload size,
+//           u64 height (cryptonight, cryptonight_light, cryptonight_heavy, ethash and etchash),
+//           u8[32] seed hash (randomx), payload
+//
+// Families are the HashFamily numbers, payloads those of the daemon protocol (hashd.cc): the
+// blob, header hash and nonce for ethash and etchash, header hash, nonce and mix hash for kawpow.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+const char CAPTURE_MAGIC[8]  = { 'C', 'N', 'H', 'C', 'A', 'P', '0', '1' };
+const size_t CAPTURE_MAX_PAYLOAD = 65535;
+
+struct CaptureRecord {
+    uint64_t time = 0;  // microseconds since the first record
+    uint8_t family = 0;
+    uint8_t algo   = 0;
+    uint64_t height = 0;
+    uint8_t seed_hash[32] = {};
+    std::vector<uint8_t> payload;
+};
+
+extern std::atomic<bool> capture_active;
+
+// Whether hash requests are being captured, cheap enough to check before every hash
+static inline bool capturing() {
+    return capture_active.load(std::memory_order_relaxed);
+}
+
+// Starts a new capture into the file, replacing an open one. False if the file can't be created.
+bool capture_open(const std::string& path);
+// Stops the capture and flushes the file, does nothing without one
+void capture_close();
+
+// Appends a request to the open capture, safe to call from any thread. seed_hash is only read for
+// randomx, payloads longer than CAPTURE_MAX_PAYLOAD are skipped.
+void capture_hash(uint8_t family, int algo, const uint8_t* payload, size_t size, uint64_t height, const uint8_t* seed_hash);
+
+// Reads the header of a capture file, false if it is not one
+bool capture_read_header(FILE* file);
+// Reads the next record, false at the end of the file or on a truncated one. Its time is that of the
+// record read before plus the delta, so the same record is passed in for the whole file.
+bool capture_read(FILE* file, CaptureRecord& record);
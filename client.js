@@ -0,0 +1,163 @@
+"use strict";
+// Thin client of cryptonight-hashd: the hash functions of the addon, answered by the daemon over
+// its Unix socket. Every call returns a promise, any number of calls can be in flight at once.
+// Calls made through a job(priority) share its priority and can be cancelled together.
+
+const net = require('net');
+
+const FAMILY = {
+	cryptonight:       0,
+	cryptonight_light: 1,
+	cryptonight_heavy: 2,
+	cryptonight_pico:  3,
+	argon2:            4,
+	astrobwt:          5,
+	k12:               6,
+	randomx:           7,
+	ethash:            8,
+	etchash:           9,
+	kawpow:            10,
+};
+
+const FAMILY_CANCEL = 255;
+
+// Possible block solutions are hashed before ordinary shares
+const PRIORITY = {
+	share: 0,
+	block: 1,
+};
+
+const REQUEST_HEADER_SIZE  = 20;
+const RESPONSE_HEADER_SIZE = 12;
+const STATUS_CANCELLED     = 2;
+
+class HashRequests {
+	cryptonight(blob, algo, height)       { return this._request(FAMILY.cryptonight, algo || 0, height, blob); }
+	cryptonight_light(blob, algo, height) { return this._request(FAMILY.cryptonight_light, algo || 0, height, blob); }
+	cryptonight_heavy(blob, algo, height) { return this._request(FAMILY.cryptonight_heavy, algo || 0, height, blob); }
+	cryptonight_pico(blob, algo)          { return this._request(FAMILY.cryptonight_pico, algo || 0, 0, blob); }
+	argon2(blob, algo)                    { return this._request(FAMILY.argon2, algo || 0, 0, blob); }
+	astrobwt(blob, algo)                  { return this._request(FAMILY.astrobwt, algo || 0, 0, blob); }
+	k12(blob)                             { return this._request(FAMILY.k12, 0, 0, blob); }
+	randomx(blob, seed_hash, algo)        { return this._request(FAMILY.randomx, algo || 0, 0, Buffer.concat([seed_hash, blob])); }
+	ethash(header_hash, nonce, height)    { return this._request(FAMILY.ethash, 0, height, Buffer.concat([header_hash, nonce])); }
+	etchash(header_hash, nonce, height)   { return this._request(FAMILY.etchash, 0, height, Buffer.concat([header_hash, nonce])); }
+	kawpow(header_hash, nonce, mix_hash)  { return this._request(FAMILY.kawpow, 0, 0, Buffer.concat([header_hash, nonce, mix_hash])); }
+}
+
+// Requests of one mining job, say: all at the same priority, cancelled together once the job is stale
+class HashJob extends HashRequests {
+	constructor(client, priority) {
+		super();
+		this.client   = client;
+		this.priority = priority;
+		this.ids      = new Set();
+	}
+
+	_request(family, algo, height, payload) {
+		return this.client._send(family, algo, height, payload, this.priority, this.ids);
+	}
+
+	// Resolves to the number of requests no worker had taken yet, which reject with a 'Cancelled' error
+	cancel() {
+		if (!this.ids.size) return Promise.resolve(0);
+		const payload = Buffer.alloc(this.ids.size * 4);
+		let offset = 0;
+		for (const id of this.ids) offset = payload.writeUInt32LE(id, offset);
+		return this.client._send(FAMILY_CANCEL, 0, 0, payload, PRIORITY.share, null).then(body => body.readUInt32LE(0));
+	}
+}
+
+class HashClient extends HashRequests {
+	constructor(socket) {
+		super();
+		this.socket  = socket;
+		this.next_id = 0;
+		this.pending = new Map();
+		this.input   = Buffer.alloc(0);
+
+		socket.on('data', data => this._receive(data));
+		socket.on('close', () => this._fail(new Error('Hash daemon connection closed')));
+		socket.on('error', err => this._fail(err));
+	}
+
+	_request(family, algo, height, payload) {
+		return this._send(family, algo, height, payload, PRIORITY.share, null);
+	}
+
+	_send(family, algo, height, payload, priority, ids) {
+		return new Promise((resolve, reject) => {
+			if (this.socket.destroyed) return reject(new Error('Hash daemon connection closed'));
+			const id = this.next_id;
+			this.next_id = (this.next_id + 1) >>> 0;
+
+			const header = Buffer.alloc(REQUEST_HEADER_SIZE);
+			header.writeUInt32LE(REQUEST_HEADER_SIZE - 4 + payload.length, 0);
+			header.writeUInt32LE(id, 4);
+			header.writeUInt8(family, 8);
+			header.writeUInt8(algo & 0xFF, 9);
+			header.writeUInt8(priority, 10);
+			header.writeBigUInt64LE(BigInt(height || 0), 12);
+
+			this.pending.set(id, { resolve, reject, family, ids });
+			if (ids) ids.add(id);
+			this.socket.write(Buffer.concat([header, payload]));
+		});
+	}
+
+	_receive(data) {
+		this.input = this.input.length ? Buffer.concat([this.input, data]) : data;
+		while (this.input.length >= 4) {
+			const size = this.input.readUInt32LE(0);
+			if (this.input.length < 4 + size) break;
+			const frame = this.input.subarray(4, 4 + size);
+			this.input  = this.input.subarray(4 + size);
+
+			const id = frame.readUInt32LE(0);
+			const request = this.pending.get(id);
+			if (!request) continue;
+			this.pending.delete(id);
+			if (request.ids) request.ids.delete(id);
+
+			const body = Buffer.from(frame.subarray(RESPONSE_HEADER_SIZE - 4));
+			if (frame.readUInt8(4) === STATUS_CANCELLED) {
+				request.reject(new Error('Cancelled'));
+			} else if (frame.readUInt8(4) !== 0) {
+				request.reject(new Error(body.toString()));
+			} else if (request.family === FAMILY.ethash || request.family === FAMILY.etchash) {
+				request.resolve([ body.subarray(0, 32), body.subarray(32, 64) ]);
+			} else {
+				request.resolve(body);
+			}
+		}
+	}
+
+	_fail(err) {
+		for (const request of this.pending.values()) request.reject(err);
+		this.pending.clear();
+	}
+
+	// job([priority]): requests sent through the returned object can be cancelled together
+	job(priority) {
+		return new HashJob(this, priority || PRIORITY.share);
+	}
+
+	close() {
+		this.socket.end();
+	}
+}
+
+// connect(socket path): resolves to a client once the daemon accepted the connection
+module.exports.connect = function(path) {
+	return new Promise((resolve, reject) => {
+		const socket = net.createConnection(path);
+		socket.once('error', reject);
+		socket.once('connect', () => {
+			socket.removeListener('error', reject);
+			resolve(new HashClient(socket));
+		});
+	});
+};
+
+module.exports.FAMILY   = FAMILY;
+module.exports.PRIORITY = PRIORITY;
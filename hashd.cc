@@ -0,0 +1,621 @@
+// Standalone verification daemon: serves the hashes of the addon over a Unix domain socket, so
+// the processes of a pool share one set of RandomX caches and VMs instead of each loading them.
+//
+// Every frame starts with its size as little-endian u32, not counting the size field itself.
+//   Request:  u32 id, u8 family, u8 algo, u8 priority, u8 reserved, u64 height, payload
+//   Response: u32 id, u8 status, u8[3] reserved, hash or error text
+// The payload is the blob, prefixed by the 32 byte seed hash for RandomX. Ethash and etchash take
+// header hash (32 bytes) and nonce (8 bytes) and answer hash and mix hash, kawpow takes header
+// hash, nonce and mix hash. Requests of the same family, algo and seed are hashed in batches by
+// a pool of workers with their own scratch state, responses may come out of order.
+//
+// Priority 1 marks possible block solutions, which are hashed before the shares (priority 0).
+// Family 255 cancels the requests of the connection whose u32 ids make up its payload as long as
+// no worker took them yet (a stale job's shares, say): each is answered with status 2 and no
+// data, the cancel request itself with the u32 count of them.
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "capture.h"
+#include "hashing.h"
+#include "numa.h"
+#include "crypto/kawpow/KPHash.h"
+#include "3rdparty/argon2.h"
+extern "C" {
+#include "crypto/randomx/panthera/KangarooTwelve.h"
+}
+
+const uint8_t STATUS_OK        = 0;
+const uint8_t STATUS_ERROR     = 1;
+const uint8_t STATUS_CANCELLED = 2;
+
+const uint8_t FAMILY_CANCEL = 255;
+
+const uint8_t PRIORITY_SHARE = 0;
+const uint8_t PRIORITY_BLOCK = 1;
+const int PRIORITY_COUNT     = 2;
+
+const size_t REQUEST_HEADER_SIZE = 16;
+const size_t MAX_FRAME_SIZE      = 1024 * 1024;
+
+static inline uint32_t get_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static inline uint64_t get_le64(const uint8_t* p) {
+    return static_cast<uint64_t>(get_le32(p)) | static_cast<uint64_t>(get_le32(p + 4)) << 32;
+}
+
+static inline void put_le32(uint8_t* p, const uint32_t v) {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+    p[2] = static_cast<uint8_t>(v >> 16);
+    p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// Client connection, written to by the workers which answer its requests
+struct Connection {
+    explicit Connection(const int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    void respond(const uint32_t id, const uint8_t status, const void* data, const size_t size) {
+        std::vector<uint8_t> frame(12 + size);
+        put_le32(&frame[0], static_cast<uint32_t>(frame.size() - 4));
+        put_le32(&frame[4], id);
+        frame[8] = status;
+        if (size) memcpy(&frame[12], data, size);
+
+        // A failed write means the client went away, its reader notices and drops the connection
+        std::lock_guard<std::mutex> lock(write_mutex);
+        for (size_t done = 0; done < frame.size();) {
+            const ssize_t n = send(fd, &frame[done], frame.size() - done, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return;
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    void error(const uint32_t id, const char* message) {
+        respond(id, STATUS_ERROR, message, strlen(message));
+    }
+
+    const int fd;
+    std::mutex write_mutex;
+};
+
+struct Job {
+    std::shared_ptr<Connection> conn;
+    uint32_t id;
+    uint8_t family;
+    uint8_t algo;
+    uint8_t priority;
+    uint64_t height;
+    std::string payload;
+};
+
+// Requests which can be hashed one after another without switching caches or VMs
+struct Batch {
+    std::string key;
+    uint8_t priority;
+    int algo_id;     // family and algo, for the concurrency cap
+    size_t memory;   // scratchpad a worker hashes it in, 0 for the algos without one
+    size_t domain;   // cache domain of the worker hashing it
+    std::vector<Job> jobs;
+};
+
+// Workers sharing a last level cache
+struct Domain {
+    size_t cache     = 0;  // bytes, workers * 2 MB when unknown
+    unsigned workers = 0;
+    std::map<int, size_t> running;  // batches being hashed by algo_id
+};
+
+// Batches wait in arrival order of their first request, later requests with the same key join
+// a waiting batch until it is full or a worker takes it. Workers take block candidates first,
+// and the oldest batch of its priority that fits:
+// - the workers of a cache domain hash as many batches of an algo at once as its scratchpads fit
+//   in their cache (8 of cn-heavy in 32 MB, 2 MB per worker where it is unknown), so they do not
+//   evict each other's scratchpads and cheap requests do not wait behind the expensive ones
+// - the scratchpads of the batches being hashed stay within the memory budget, unless a batch is
+//   the only one. A batch waiting for memory holds back the later ones which need memory too, so
+//   a stream of smaller scratchpads can not starve it.
+class Scheduler {
+public:
+    // workers are the threads of each cache domain, caches their sizes (0 when unknown)
+    Scheduler(const size_t batch_size, const std::vector<unsigned>& workers, const std::vector<size_t>& caches, const size_t memory_budget)
+        : m_batch_size(batch_size), m_memory_budget(memory_budget)
+    {
+        m_domains.resize(workers.size());
+        for (size_t i = 0; i < workers.size(); ++i) {
+            m_domains[i].workers = workers[i];
+            m_domains[i].cache   = caches[i] ? caches[i] : workers[i] * xmrig::Algorithm::l3(xmrig::Algorithm::CN_0);
+            m_threads += workers[i];
+        }
+    }
+
+    void push(Job&& job) {
+        const std::string key = batch_key(job);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::deque<std::unique_ptr<Batch>>& batches = m_batches[job.priority];
+            for (auto it = batches.rbegin(); it != batches.rend(); ++it) {
+                if ((*it)->key == key && (*it)->jobs.size() < m_batch_size) {
+                    (*it)->jobs.push_back(std::move(job));
+                    return;
+                }
+            }
+            std::unique_ptr<Batch> batch(new Batch());
+            batch->key      = key;
+            batch->priority = job.priority;
+            batch->algo_id  = job.family << 8 | job.algo;
+            batch->memory   = scratch_memory(job);
+            batch->jobs.reserve(m_batch_size);
+            batch->jobs.push_back(std::move(job));
+            batches.push_back(std::move(batch));
+        }
+        // A worker of another domain may be the only one its cap lets take it
+        if (m_domains.size() > 1) m_cond.notify_all();
+        else m_cond.notify_one();
+    }
+
+    // Next batch for a worker of the cache domain, nullptr once the scheduler is stopped or nothing
+    // came for idle_ms (0 waits forever). The worker hands it back to done() once hashed.
+    std::unique_ptr<Batch> pop(const size_t domain, const uint64_t idle_ms) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        std::deque<std::unique_ptr<Batch>>::iterator next;
+        int priority = 0;
+        auto ready = [this, domain, &next, &priority]() { return m_stopped || select(m_domains[domain], next, priority); };
+        if (idle_ms) {
+            if (!m_cond.wait_for(lock, std::chrono::milliseconds(idle_ms), ready)) return nullptr;
+        } else {
+            m_cond.wait(lock, ready);
+        }
+        if (m_stopped) return nullptr;
+        std::unique_ptr<Batch> batch = std::move(*next);
+        m_batches[priority].erase(next);
+        batch->domain = domain;
+        ++m_domains[domain].running[batch->algo_id];
+        m_memory += batch->memory;
+        return batch;
+    }
+
+    void done(const Batch& batch) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_domains[batch.domain].running[batch.algo_id];
+            m_memory -= batch.memory;
+        }
+        // Any waiting batch may fit now
+        m_cond.notify_all();
+    }
+
+    // Waiting requests of the connection with one of the ids, taken out of their batches
+    std::vector<Job> cancel(const Connection* conn, const std::vector<uint32_t>& ids) {
+        std::vector<Job> cancelled;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::deque<std::unique_ptr<Batch>>& batches : m_batches) {
+            for (auto it = batches.begin(); it != batches.end();) {
+                std::vector<Job>& jobs = (*it)->jobs;
+                auto keep = std::stable_partition(jobs.begin(), jobs.end(), [conn, &ids](const Job& job) {
+                    return job.conn.get() != conn || std::find(ids.begin(), ids.end(), job.id) == ids.end();
+                });
+                std::move(keep, jobs.end(), std::back_inserter(cancelled));
+                jobs.erase(keep, jobs.end());
+                if (jobs.empty()) it = batches.erase(it); else ++it;
+            }
+        }
+        return cancelled;
+    }
+
+    // Scratch memory a worker may keep between batches, 0 without a budget
+    size_t worker_share() const {
+        return m_memory_budget / m_threads;
+    }
+
+    bool stopped() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stopped;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_cond.notify_all();
+    }
+
+private:
+    bool select(Domain& domain, std::deque<std::unique_ptr<Batch>>::iterator& next, int& priority) {
+        bool memory_waits = false;
+        for (priority = PRIORITY_COUNT - 1; priority >= 0; --priority) {
+            for (auto it = m_batches[priority].begin(); it != m_batches[priority].end(); ++it) {
+                const Batch& batch = **it;
+                const size_t limit = batch.memory ? std::min<size_t>(domain.workers, std::max<size_t>(1, domain.cache / batch.memory)) : domain.workers;
+                if (domain.running[batch.algo_id] >= limit) continue;
+                if (batch.memory) {
+                    if (memory_waits) continue;
+                    if (m_memory_budget && m_memory && m_memory + batch.memory > m_memory_budget) {
+                        memory_waits = true;
+                        continue;
+                    }
+                }
+                next = it;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static size_t scratch_memory(const Job& job) {
+        switch (job.family) {
+            case FAMILY_RANDOMX: return xmrig::Algorithm(get_rx_algo(job.algo)).l3();
+            case FAMILY_K12:
+            case FAMILY_ETHASH:
+            case FAMILY_ETCHASH:
+            case FAMILY_KAWPOW:  return 0;
+            default:             return get_family_fn(job.family, job.algo).memory;
+        }
+    }
+
+    static std::string batch_key(const Job& job) {
+        std::string key;
+        key.push_back(static_cast<char>(job.priority));
+        key.push_back(static_cast<char>(job.family));
+        key.push_back(static_cast<char>(job.algo));
+        switch (job.family) {
+            case FAMILY_RANDOMX: key.append(job.payload, 0, 32); break;
+            case FAMILY_ETHASH:  key.append(std::to_string(job.height / ETHASH_EPOCH_LENGTH)); break;
+            case FAMILY_ETCHASH: {
+                int epoch_seed, epoch;
+                get_etchash_epoch(job.height, epoch_seed, epoch);
+                key.append(std::to_string(epoch_seed) + ":" + std::to_string(epoch));
+                break;
+            }
+        }
+        return key;
+    }
+
+    const size_t m_batch_size;
+    const size_t m_memory_budget;
+    unsigned m_threads = 0;
+    std::vector<Domain> m_domains;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<std::unique_ptr<Batch>> m_batches[PRIORITY_COUNT];
+    size_t m_memory = 0;
+    bool m_stopped = false;
+};
+
+// Checks the payload size of the family, returns the error text of a bad request
+static const char* check_job(const Job& job) {
+    if (job.family >= FAMILY_COUNT) return "Unknown hash family";
+    switch (job.family) {
+        case FAMILY_RANDOMX: return job.payload.size() < 32 ? "RandomX payload should start with the 32 byte seed hash" : nullptr;
+        case FAMILY_ETHASH:
+        case FAMILY_ETCHASH: return job.payload.size() != 40 ? "Ethash payload should be header hash (32 bytes) and nonce (8 bytes)" : nullptr;
+        case FAMILY_KAWPOW:  return job.payload.size() != 72 ? "KawPow payload should be header hash (32 bytes), nonce (8 bytes) and mix hash (32 bytes)" : nullptr;
+        default:             return nullptr;
+    }
+}
+
+static void hash_ethash(const Job& job) {
+    ethash_h256_t header_hash;
+    memcpy(&header_hash, job.payload.data(), sizeof(header_hash));
+    uint64_t nonce;
+    memcpy(&nonce, job.payload.data() + 32, sizeof(nonce));
+
+    const int height = static_cast<int>(job.height);
+    const ethash_light_t cache = job.family == FAMILY_ETHASH ? get_ethash_cache(height) : get_etchash_cache(height);
+    const ethash_return_value_t res = ethash_light_compute(cache, header_hash, __builtin_bswap64(nonce));
+
+    uint8_t output[64];
+    memcpy(output, res.result.b, 32);
+    memcpy(output + 32, res.mix_hash.b, 32);
+    job.conn->respond(job.id, STATUS_OK, output, sizeof(output));
+}
+
+static void hash_kawpow(const Job& job) {
+    uint32_t header_hash[8];
+    memcpy(header_hash, job.payload.data(), sizeof(header_hash));
+    uint64_t nonce;
+    memcpy(&nonce, job.payload.data() + 32, sizeof(nonce));
+    uint32_t mix_hash[8];
+    memcpy(mix_hash, job.payload.data() + 40, sizeof(mix_hash));
+
+    uint32_t output[8];
+    xmrig::KPHash::verify(header_hash, __builtin_bswap64(nonce), mix_hash, output);
+    job.conn->respond(job.id, STATUS_OK, output, sizeof(output));
+}
+
+// All jobs of a batch share the seed hash, equally sized blobs go through the VM two at a time
+static void hash_randomx(std::vector<Job>& jobs) {
+    const xmrig::Algorithm::Id algo = get_rx_algo(jobs[0].algo);
+    const uint8_t* seed_hash = reinterpret_cast<const uint8_t*>(jobs[0].payload.data());
+
+    std::vector<Job*> pending;
+    for (Job& job : jobs) pending.push_back(&job);
+
+    while (!pending.empty()) {
+        Job* first = pending.front();
+        pending.erase(pending.begin());
+        const size_t size = first->payload.size() - 32;
+
+        Job* second = nullptr;
+        for (auto it = pending.begin(); it != pending.end(); ++it) {
+            if ((*it)->payload.size() - 32 == size) {
+                second = *it;
+                pending.erase(it);
+                break;
+            }
+        }
+
+        uint8_t output[2][32];
+        try {
+            if (second) {
+                const uint8_t* const input[2] = { reinterpret_cast<const uint8_t*>(first->payload.data()) + 32, reinterpret_cast<const uint8_t*>(second->payload.data()) + 32 };
+                uint8_t* const out[2] = { output[0], output[1] };
+                rx_calculate_hash_2(seed_hash, algo, input, size, out);
+            } else {
+                rx_calculate_hash(seed_hash, algo, reinterpret_cast<const uint8_t*>(first->payload.data()) + 32, size, output[0]);
+            }
+        } catch (const std::exception& e) {
+            first->conn->error(first->id, e.what());
+            if (second) second->conn->error(second->id, e.what());
+            continue;
+        }
+        first->conn->respond(first->id, STATUS_OK, output[0], 32);
+        if (second) second->conn->respond(second->id, STATUS_OK, output[1], 32);
+    }
+}
+
+static void hash_batch(Batch& batch) {
+    const uint8_t family = batch.jobs[0].family;
+    const int algo       = batch.jobs[0].algo;
+
+    if (family == FAMILY_RANDOMX) return hash_randomx(batch.jobs);
+
+    // Each job is answered once: with its hash, or with the error that stopped it alone
+    const CnHashFn fn = get_family_fn(family, algo);
+    for (const Job& job : batch.jobs) {
+        const uint8_t* input = reinterpret_cast<const uint8_t*>(job.payload.data());
+        uint8_t output[32];
+        try {
+            switch (family) {
+                case FAMILY_ETHASH:
+                case FAMILY_ETCHASH: hash_ethash(job); continue;
+                case FAMILY_KAWPOW:  hash_kawpow(job); continue;
+                case FAMILY_K12:     KangarooTwelve(input, job.payload.size(), output, 32, 0, 0); break;
+                default:             fn(input, job.payload.size(), output, job.height);
+            }
+        } catch (const std::exception& e) {
+            job.conn->error(job.id, e.what());
+            continue;
+        }
+        job.conn->respond(job.id, STATUS_OK, output, sizeof(output));
+    }
+}
+
+static void worker_main(Scheduler* scheduler, const size_t domain) {
+    // Staying on the CPUs of the domain keeps the worker on its NUMA node and cache replica too
+    if (cache_domains().size() > 1) pin_thread_cpus(cache_domains()[domain].cpus);
+    std::unique_ptr<IsolateState> state(new IsolateState());
+    isolate_state = state.get();
+
+    for (;;) {
+        // An idle worker releases its scratch memory and caches instead of waiting for its next hash to do it
+        std::unique_ptr<Batch> batch = scheduler->pop(domain, get_idle_timeout());
+        if (!batch) {
+            if (scheduler->stopped()) break;
+            state->trim(get_idle_timeout());
+            continue;
+        }
+        try {
+            hash_batch(*batch);
+        } catch (const std::exception& e) {
+            // Only thrown before the first job of the batch was answered
+            for (const Job& job : batch->jobs) job.conn->error(job.id, e.what());
+        }
+        // A scratchpad beyond this worker's part of the memory budget goes right away
+        if (scheduler->worker_share() && state->ctx_size > scheduler->worker_share()) state->release_cn();
+        scheduler->done(*batch);
+    }
+
+    isolate_state = nullptr;
+}
+
+static bool read_full(const int fd, uint8_t* data, const size_t size) {
+    for (size_t done = 0; done < size;) {
+        const ssize_t n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static void cancel(Scheduler* scheduler, const Job& request) {
+    if (request.payload.size() % 4) return request.conn->error(request.id, "Cancel payload should be u32 request ids");
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i < request.payload.size(); i += 4) ids.push_back(get_le32(reinterpret_cast<const uint8_t*>(request.payload.data()) + i));
+
+    const std::vector<Job> cancelled = scheduler->cancel(request.conn.get(), ids);
+    for (const Job& job : cancelled) job.conn->respond(job.id, STATUS_CANCELLED, nullptr, 0);
+    uint8_t count[4];
+    put_le32(count, static_cast<uint32_t>(cancelled.size()));
+    request.conn->respond(request.id, STATUS_OK, count, sizeof(count));
+}
+
+// Reads the requests of a connection until the client closes it or sends a malformed frame
+static void connection_main(Scheduler* scheduler, const std::shared_ptr<Connection> conn) {
+    std::vector<uint8_t> frame;
+    uint8_t size_field[4];
+    while (read_full(conn->fd, size_field, sizeof(size_field))) {
+        const uint32_t size = get_le32(size_field);
+        if (size < REQUEST_HEADER_SIZE || size > MAX_FRAME_SIZE) break;
+        frame.resize(size);
+        if (!read_full(conn->fd, frame.data(), size)) break;
+
+        Job job;
+        job.conn    = conn;
+        job.id      = get_le32(&frame[0]);
+        job.family  = frame[4];
+        job.algo     = frame[5];
+        job.priority = frame[6] ? PRIORITY_BLOCK : PRIORITY_SHARE;
+        job.height   = get_le64(&frame[8]);
+        job.payload.assign(reinterpret_cast<const char*>(&frame[REQUEST_HEADER_SIZE]), size - REQUEST_HEADER_SIZE);
+
+        if (job.family == FAMILY_CANCEL) {
+            cancel(scheduler, job);
+            continue;
+        }
+        const char* error = check_job(job);
+        if (error) {
+            conn->error(job.id, error);
+            continue;
+        }
+        if (capturing()) {
+            const uint8_t* payload = reinterpret_cast<const uint8_t*>(job.payload.data());
+            if (job.family == FAMILY_RANDOMX) capture_hash(job.family, job.algo, payload + 32, job.payload.size() - 32, job.height, payload);
+            else capture_hash(job.family, job.algo, payload, job.payload.size(), job.height, nullptr);
+        }
+        scheduler->push(std::move(job));
+    }
+    shutdown(conn->fd, SHUT_RDWR);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s --socket <path> [--threads <n>] [--batch <n>] [--cache-dir <dir>] [--shared-caches <prefix>] [--idle-timeout <ms>] [--memory-budget <MB>] [--capture <path>] [--no-jit]\n", name);
+}
+
+int main(int argc, char** argv) {
+    std::string path, cache_dir, shared_prefix, capture_path;
+    unsigned threads  = std::thread::hardware_concurrency();
+    size_t batch_size = 16;
+    size_t memory_budget = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--no-jit") {
+            set_rx_jit(false);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (arg == "--socket") path = argv[++i];
+        else if (arg == "--threads") threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (arg == "--batch") batch_size = static_cast<size_t>(atoi(argv[++i]));
+        else if (arg == "--cache-dir") cache_dir = argv[++i];
+        else if (arg == "--shared-caches") shared_prefix = argv[++i];
+        else if (arg == "--idle-timeout") set_idle_timeout(strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--memory-budget") memory_budget = static_cast<size_t>(strtoull(argv[++i], nullptr, 10)) << 20;
+        else if (arg == "--capture") capture_path = argv[++i];
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    sockaddr_un addr = {};
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+    if (batch_size < 1) batch_size = 1;
+
+    signal(SIGPIPE, SIG_IGN);
+    // SIGINT and SIGTERM go to a thread of their own, which flushes the capture and removes the socket
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+    std::thread([stop_signals, path]() {
+        int received;
+        sigwait(&stop_signals, &received);
+        capture_close();
+        unlink(path.c_str());
+        _exit(0);
+    }).detach();
+    argon2_select_impl_by_features();
+    randomx_set_scratchpad_prefetch_mode(0);
+    randomx_set_huge_pages_jit(false);
+    if (!cache_dir.empty()) rx_cache_store_dir(cache_dir);
+    if (!shared_prefix.empty()) shm_cache_prefix(shared_prefix);
+    if (!capture_path.empty() && !capture_open(capture_path)) {
+        fprintf(stderr, "Can't create capture file %s: %s\n", capture_path.c_str(), strerror(errno));
+        return 1;
+    }
+
+    const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.data(), path.size());
+    unlink(path.c_str());
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listen_fd, 64) != 0) {
+        fprintf(stderr, "Can't listen on %s: %s\n", path.c_str(), strerror(errno));
+        return 1;
+    }
+
+    // Workers fill the cores of all cache domains before the SMT siblings of these cores
+    const std::vector<CacheDomain>& domains = cache_domains();
+    std::vector<size_t> slots;
+    for (size_t sibling = 0, added = 1; added; ++sibling) {
+        added = 0;
+        for (size_t core = 0, more = 1; more; ++core) {
+            more = 0;
+            for (size_t domain = 0; domain < domains.size(); ++domain) {
+                if (core >= domains[domain].cores.size()) continue;
+                more = 1;
+                if (sibling >= domains[domain].cores[core].size()) continue;
+                slots.push_back(domain);
+                ++added;
+            }
+        }
+    }
+    if (slots.empty()) slots.push_back(0);
+
+    std::vector<unsigned> domain_workers(domains.size(), 0);
+    std::vector<size_t> domain_caches;
+    for (unsigned i = 0; i < threads; ++i) ++domain_workers[slots[i % slots.size()]];
+    for (const CacheDomain& domain : domains) domain_caches.push_back(domain.size);
+    Scheduler scheduler(batch_size, domain_workers, domain_caches, memory_budget);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back(worker_main, &scheduler, slots[i % slots.size()]);
+
+    printf("Listening on %s with %u threads in %u cache domains\n", path.c_str(), threads, static_cast<unsigned>(domains.size()));
+    fflush(stdout);
+
+    for (;;) {
+        const int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            fprintf(stderr, "Can't accept connections: %s\n", strerror(errno));
+            break;
+        }
+        std::thread(connection_main, &scheduler, std::make_shared<Connection>(fd)).detach();
+    }
+
+    scheduler.stop();
+    for (std::thread& worker : workers) worker.join();
+    close(listen_fd);
+    unlink(path.c_str());
+    return 1;
+}
@@ -0,0 +1,547 @@
+#include "hashing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "crypto/cn/CryptoNight.h"
+#include "crypto/ghostrider/ghostrider.h"
+#include "3rdparty/argon2.h"
+#include "numa.h"
+
+#if defined(ASM_TYPE)
+  std::atomic<int> cn_assembly(ASM_TYPE);
+#else
+  std::atomic<int> cn_assembly(xmrig::Assembly::NONE);
+#endif
+
+SharedCache<RxCache>     rx_caches;
+SharedCache<EthashCache> ethash_caches;
+
+thread_local IsolateState* isolate_state = nullptr;
+
+static std::atomic<uint64_t> idle_timeout(0);
+
+// Idle checks of an isolate run at most this often
+static const uint64_t IDLE_CHECK_INTERVAL = 1000;
+
+static uint64_t now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void set_idle_timeout(const uint64_t ms) {
+    idle_timeout = ms;
+}
+
+uint64_t get_idle_timeout() {
+    return idle_timeout;
+}
+
+static std::atomic<bool> rx_jit(true);
+
+void set_rx_jit(const bool enabled) {
+    rx_jit = enabled;
+}
+
+bool get_rx_jit() {
+    return rx_jit;
+}
+
+// Called by every hash after it marked what it uses, so only the other parts can be released
+static void release_idle(IsolateState* state, const uint64_t now) {
+    const uint64_t timeout = idle_timeout.load(std::memory_order_relaxed);
+    if (!timeout || now - state->idle_checked < IDLE_CHECK_INTERVAL) return;
+    state->idle_checked = now;
+    state->trim(timeout);
+}
+
+// Bytes held by the last reference to a shared cache entry, the caller drops it
+template <typename T>
+static size_t last_reference(const std::shared_ptr<typename SharedCache<T>::Entry>& entry, const size_t size) {
+    return entry && entry.use_count() == 1 ? size : 0;
+}
+
+IsolateState::~IsolateState() {
+    release_cn();
+    for (int i = 0; i < MAXRX; ++i) release_rx(i);
+}
+
+cryptonight_ctx** IsolateState::cn_ctx(const size_t memory) {
+    cn_used = now_ms();
+    if (ctx_size < memory) {
+        uint8_t* grown = static_cast<uint8_t*>(my_malloc(memory, 4096));
+        if (!grown) throw std::domain_error("Can't allocate CryptoNight scratchpad");
+        if (!ctx) xmrig::CnCtx::create(&ctx, grown, memory, 1);
+        ctx->memory = grown;
+        if (ctx_memory) my_free(ctx_memory);
+        ctx_memory = grown;
+        ctx_size   = memory;
+    }
+    release_idle(this, cn_used);
+    return &ctx;
+}
+
+uint8_t* IsolateState::rx_scratchpad() {
+    if (!rx_mem) rx_mem.reset(new xmrig::VirtualMemory(RANDOMX_SCRATCHPAD_L3_MAX_SIZE, true, false, 0, 4096));
+    return rx_mem->scratchpad();
+}
+
+size_t IsolateState::release_cn() {
+    const size_t released = ctx_size;
+    if (ctx) {
+        xmrig::CnCtx::release(&ctx, 1);
+        ctx = nullptr;
+    }
+    if (ctx_memory) my_free(ctx_memory);
+    ctx_memory = nullptr;
+    ctx_size   = 0;
+    return released;
+}
+
+size_t IsolateState::release_rx(const int rxid) {
+    size_t released = 0;
+    if (rx_vm[rxid]) {
+        randomx_destroy_vm(rx_vm[rxid]);
+        rx_vm[rxid] = nullptr;
+    }
+    if (rx_cache[rxid]) {
+        released += last_reference<RxCache>(rx_cache[rxid], RANDOMX_CACHE_MAX_SIZE);
+        rx_cache[rxid].reset();
+    }
+    // One at a time, so a cache held twice counts once
+    while (!rx_warm[rxid].empty()) {
+        released += last_reference<RxCache>(rx_warm[rxid].back(), RANDOMX_CACHE_MAX_SIZE);
+        rx_warm[rxid].pop_back();
+    }
+    if (rxid == rx2id(xmrig::Algorithm::RX_XLA) && yespower_mem) {
+        released += yespower_mem->size();
+        yespower_mem.reset();
+    }
+
+    // The scratchpad goes with the last VM
+    bool vms = false;
+    for (int i = 0; i < MAXRX; ++i) vms = vms || rx_vm[i];
+    if (!vms && rx_mem) {
+        released += rx_mem->size();
+        rx_mem.reset();
+    }
+    return released;
+}
+
+static size_t release_light_cache(std::shared_ptr<SharedCache<EthashCache>::Entry>& current, std::vector<std::shared_ptr<SharedCache<EthashCache>::Entry>>& warm) {
+    size_t released = current ? last_reference<EthashCache>(current, ethash_get_cachesize(current->value->epoch)) : 0;
+    current.reset();
+    while (!warm.empty()) {
+        released += last_reference<EthashCache>(warm.back(), ethash_get_cachesize(warm.back()->value->epoch));
+        warm.pop_back();
+    }
+    return released;
+}
+
+size_t IsolateState::release_ethash() {
+    return release_light_cache(ethash_cache, ethash_warm);
+}
+
+size_t IsolateState::release_etchash() {
+    return release_light_cache(etchash_cache, etchash_warm);
+}
+
+size_t IsolateState::trim(const uint64_t idle_ms) {
+    const uint64_t now = now_ms();
+    auto idle = [now, idle_ms](const uint64_t used) { return now - used >= idle_ms; };
+
+    size_t released = 0;
+    if (ctx_size && idle(cn_used)) released += release_cn();
+    for (int i = 0; i < MAXRX; ++i) {
+        if ((rx_vm[i] || rx_cache[i] || !rx_warm[i].empty()) && idle(rx_used[i])) released += release_rx(i);
+    }
+    if ((ethash_cache || !ethash_warm.empty()) && idle(ethash_used)) released += release_ethash();
+    if ((etchash_cache || !etchash_warm.empty()) && idle(etchash_used)) released += release_etchash();
+    return released;
+}
+
+template <typename T>
+static void adopt_cache(std::shared_ptr<T>& current, std::vector<std::shared_ptr<T>>& warm, std::shared_ptr<T>& other_current, std::vector<std::shared_ptr<T>>& other_warm) {
+    // The same cache is adopted again by every scan() of a seed, it is held once
+    const auto add = [&current, &warm](std::shared_ptr<T>& entry) {
+        if (entry != current && std::find(warm.begin(), warm.end(), entry) == warm.end()) warm.push_back(std::move(entry));
+        entry.reset();
+    };
+    if (!current) current = std::move(other_current);
+    else if (other_current) add(other_current);
+    for (std::shared_ptr<T>& entry : other_warm) add(entry);
+    other_warm.clear();
+}
+
+void IsolateState::adopt(IsolateState& warm) {
+    if (warm.ctx_size > ctx_size) {
+        release_cn();
+        std::swap(ctx, warm.ctx);
+        std::swap(ctx_memory, warm.ctx_memory);
+        std::swap(ctx_size, warm.ctx_size);
+        cn_used = warm.cn_used;
+    }
+
+    // VMs hash in the scratchpad of their state, so they only move all together
+    bool vms = false;
+    for (int i = 0; i < MAXRX; ++i) vms = vms || rx_vm[i];
+    if (!vms) {
+        std::swap(rx_mem, warm.rx_mem);
+        std::swap(yespower_mem, warm.yespower_mem);
+        for (int i = 0; i < MAXRX; ++i) {
+            if (!warm.rx_vm[i]) continue;
+            std::swap(rx_vm[i], warm.rx_vm[i]);
+            memcpy(rx_seed_hash[i], warm.rx_seed_hash[i], sizeof(rx_seed_hash[i]));
+            rx_cache[i].swap(warm.rx_cache[i]);
+        }
+    }
+    for (int i = 0; i < MAXRX; ++i) {
+        if (!warm.rx_cache[i] && warm.rx_warm[i].empty()) continue;
+        if (!rx_cache[i]) memcpy(rx_seed_hash[i], warm.rx_seed_hash[i], sizeof(rx_seed_hash[i]));
+        adopt_cache(rx_cache[i], rx_warm[i], warm.rx_cache[i], warm.rx_warm[i]);
+        rx_used[i] = std::max(rx_used[i], warm.rx_used[i]);
+    }
+
+    if (warm.ethash_cache || !warm.ethash_warm.empty()) {
+        adopt_cache(ethash_cache, ethash_warm, warm.ethash_cache, warm.ethash_warm);
+        ethash_used = std::max(ethash_used, warm.ethash_used);
+    }
+    if (warm.etchash_cache || !warm.etchash_warm.empty()) {
+        adopt_cache(etchash_cache, etchash_warm, warm.etchash_cache, warm.etchash_warm);
+        etchash_used = std::max(etchash_used, warm.etchash_used);
+    }
+}
+
+int rx2id(xmrig::Algorithm::Id algo) {
+  switch (algo) {
+      case xmrig::Algorithm::RX_0:     return 0;
+      case xmrig::Algorithm::RX_WOW:   return 1;
+      case xmrig::Algorithm::RX_ARQ:   return 2;
+      case xmrig::Algorithm::RX_GRAFT: return 3;
+      case xmrig::Algorithm::RX_SFX:   return 4;
+      case xmrig::Algorithm::RX_KEVA:  return 5;
+      case xmrig::Algorithm::RX_XLA:   return MAXRX-1;
+      default: return 0;
+  }
+}
+
+const RandomX_ConfigurationBase& get_rx_config(xmrig::Algorithm::Id algo) {
+    switch (algo) {
+        case xmrig::Algorithm::RX_0:     return RandomX_MoneroConfig;
+        case xmrig::Algorithm::RX_WOW:   return RandomX_WowneroConfig;
+        case xmrig::Algorithm::RX_ARQ:   return RandomX_ArqmaConfig;
+        case xmrig::Algorithm::RX_GRAFT: return RandomX_GraftConfig;
+        case xmrig::Algorithm::RX_KEVA:  return RandomX_KevaConfig;
+        case xmrig::Algorithm::RX_XLA:   return RandomX_ScalaConfig;
+        default: throw std::domain_error("Unknown RandomX algo");
+    }
+}
+
+xmrig::Algorithm::Id get_rx_algo(const int algo) {
+    switch (algo) {
+        case 0:  return xmrig::Algorithm::RX_0;
+        //case 1:  return xmrig::Algorithm::RX_DEFYX;
+        case 2:  return xmrig::Algorithm::RX_ARQ;
+        case 3:  return xmrig::Algorithm::RX_XLA;
+        case 17: return xmrig::Algorithm::RX_WOW;
+        //case 18: return xmrig::Algorithm::RX_LOKI;
+        case 19: return xmrig::Algorithm::RX_KEVA;
+        case 20: return xmrig::Algorithm::RX_GRAFT;
+        default: return xmrig::Algorithm::RX_0;
+    }
+}
+
+// Copy of an initialised cache in memory of the given NUMA node, so its SuperscalarHash reads stay local
+static RxCache* rx_cache_replica(const std::shared_ptr<SharedCache<RxCache>::Entry>& source, const uint32_t node) {
+    std::unique_ptr<RxCache> replica(new RxCache());
+    replica->memory = static_cast<uint8_t*>(my_malloc(RANDOMX_CACHE_MAX_SIZE, 4096));
+    if (!replica->memory) throw std::domain_error("Can't create RandomX cache");
+    numa_bind_memory(replica->memory, RANDOMX_CACHE_MAX_SIZE, node);
+    memcpy(replica->memory, source->value->memory, static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024);
+
+    std::string programs(randomx_cache_programs_size(source->value->cache), '\0');
+    randomx_save_cache_programs(source->value->cache, &programs[0]);
+    replica->cache = randomx_create_cache(RANDOMX_FLAG_JIT, replica->memory);
+    if (!replica->cache || !randomx_load_cache_programs(replica->cache, programs.data(), programs.size())) {
+        throw std::domain_error("Can't create RandomX cache");
+    }
+
+    replica->argon2_impl = source->value->argon2_impl;
+    replica->node        = node;
+    replica->source      = source;
+    return replica.release();
+}
+
+// Cache in an object shared with other processes: cache memory, then the size of the serialized
+// programs and the programs. The creating process fills it from the store or initialises it.
+static RxCache* rx_cache_shared(const int rxid, const uint8_t* seed_hash) {
+    const size_t memory_size = static_cast<size_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+    std::unique_ptr<RxCache> rx_cache(new RxCache());
+    bool initialised = false;
+
+    rx_cache->shm = shm_cache_attach(rx_cache_name(rxid, seed_hash), memory_size + sizeof(uint64_t) + randomx_cache_programs_max_size(), [&](uint8_t* data) {
+        uint8_t* programs = data + memory_size + sizeof(uint64_t);
+        uint64_t programs_size;
+        std::unique_ptr<RxStoredCache> stored = rx_cache_store_load(rxid, seed_hash);
+        if (stored && stored->programs_size() <= randomx_cache_programs_max_size()) {
+            programs_size = stored->programs_size();
+            memcpy(data, stored->memory(), memory_size);
+            memcpy(programs, stored->programs(), programs_size);
+        } else {
+            rx_cache->cache = randomx_create_cache(RANDOMX_FLAG_JIT, data);
+            if (!rx_cache->cache) return false;
+            rx_cache->argon2_impl = argon2_get_impl_name();
+            randomx_init_cache(rx_cache->cache, seed_hash, 32);
+            programs_size = randomx_cache_programs_size(rx_cache->cache);
+            randomx_save_cache_programs(rx_cache->cache, programs);
+            rx_cache->save_pending = true;
+            initialised = true;
+        }
+        memcpy(data + memory_size, &programs_size, sizeof(programs_size));
+        return true;
+    });
+    if (!rx_cache->shm) return nullptr;
+
+    rx_cache->memory = rx_cache->shm->data();
+    if (!initialised) {
+        uint64_t programs_size;
+        memcpy(&programs_size, rx_cache->memory + memory_size, sizeof(programs_size));
+        rx_cache->cache = randomx_create_cache(RANDOMX_FLAG_JIT, rx_cache->memory);
+        if (!rx_cache->cache || programs_size > randomx_cache_programs_max_size() ||
+            !randomx_load_cache_programs(rx_cache->cache, rx_cache->memory + memory_size + sizeof(uint64_t), programs_size)) {
+            return nullptr;
+        }
+    }
+    return rx_cache.release();
+}
+
+randomx_vm* rx_get_vm(const uint8_t* seed_hash, const xmrig::Algorithm::Id algo) {
+    IsolateState* state = isolate_state;
+    const int rxid = rx2id(algo);
+    assert(rxid < MAXRX);
+
+    // Config is per thread, isolates can hash different variants at the same time
+    randomx_apply_config(get_rx_config(algo));
+    state->rx_used[rxid] = now_ms();
+    release_idle(state, state->rx_used[rxid]);
+
+    if (!state->rx_cache[rxid] || memcmp(state->rx_seed_hash[rxid], seed_hash, sizeof(state->rx_seed_hash[0])) != 0) {
+        std::string key(1, static_cast<char>(rxid));
+        key.append(reinterpret_cast<const char*>(seed_hash), sizeof(state->rx_seed_hash[0]));
+
+        const uint32_t node = numa_current_node();
+        std::shared_ptr<SharedCache<RxCache>::Entry> cache = rx_caches.get(key, [rxid, seed_hash, node]() {
+            if (shm_cache_enabled()) {
+                RxCache* shared = rx_cache_shared(rxid, seed_hash);
+                if (shared) {
+                    if (numa_node_count() < 2) shared->node = node;
+                    return shared;
+                }
+            }
+
+            std::unique_ptr<RxCache> rx_cache(new RxCache());
+            rx_cache->stored = rx_cache_store_load(rxid, seed_hash);
+            if (rx_cache->stored) {
+                rx_cache->memory = rx_cache->stored->memory();
+                rx_cache->cache  = randomx_create_cache(RANDOMX_FLAG_JIT, rx_cache->memory);
+                if (rx_cache->cache && randomx_load_cache_programs(rx_cache->cache, rx_cache->stored->programs(), rx_cache->stored->programs_size())) {
+                    return rx_cache.release();
+                }
+                rx_cache.reset(new RxCache());
+            }
+            rx_cache->memory = static_cast<uint8_t*>(my_malloc(RANDOMX_CACHE_MAX_SIZE, 4096));
+            rx_cache->cache  = randomx_create_cache(RANDOMX_FLAG_JIT, rx_cache->memory);
+            if (!rx_cache->cache) throw std::domain_error("Can't create RandomX cache");
+            if (numa_node_count() < 2 || numa_bind_memory(rx_cache->memory, RANDOMX_CACHE_MAX_SIZE, node)) rx_cache->node = node;
+            rx_cache->argon2_impl = argon2_get_impl_name();
+            randomx_init_cache(rx_cache->cache, seed_hash, 32);
+            rx_cache->save_pending = true;
+            return rx_cache.release();
+        });
+
+        if (cache->value->save_pending.exchange(false)) {
+            std::string programs(randomx_cache_programs_size(cache->value->cache), '\0');
+            randomx_save_cache_programs(cache->value->cache, &programs[0]);
+            rx_cache_store_save(rxid, seed_hash, cache->value->memory, std::move(programs), cache);
+        }
+
+        // On multi-socket hosts isolates on other nodes hash with a copy in their node's memory
+        if (numa_node_count() > 1 && cache->value->node != node) {
+            const std::shared_ptr<SharedCache<RxCache>::Entry> source = cache;
+            cache = rx_caches.get(key + "@" + std::to_string(node), [&source, node]() { return rx_cache_replica(source, node); });
+        }
+
+        // Switch the VM first, the previous cache may be released together with the old reference
+        if (state->rx_vm[rxid]) {
+            randomx_vm_set_cache(state->rx_vm[rxid], cache->value->cache);
+        }
+        state->rx_cache[rxid] = cache;
+        memcpy(state->rx_seed_hash[rxid], seed_hash, sizeof(state->rx_seed_hash[0]));
+    }
+
+    if (!state->rx_vm[rxid]) {
+        int flags = 0;
+#if !defined(__ARM_ARCH)
+        if (rx_jit) flags |= RANDOMX_FLAG_JIT;
+#endif
+#if !SOFT_AES
+        flags |= RANDOMX_FLAG_HARD_AES;
+#endif
+
+        state->rx_vm[rxid] = randomx_create_vm(static_cast<randomx_flags>(flags), state->rx_cache[rxid]->value->cache, nullptr, state->rx_scratchpad(), numa_current_node());
+        // Hosts that refuse executable memory still get the bytecode interpreter
+        if (!state->rx_vm[rxid] && (flags & RANDOMX_FLAG_JIT)) {
+            state->rx_vm[rxid] = randomx_create_vm(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_JIT), state->rx_cache[rxid]->value->cache, nullptr, state->rx_scratchpad(), numa_current_node());
+        }
+        if (!state->rx_vm[rxid]) throw std::domain_error("Can't create RandomX VM");
+
+        // The yespower stage of Scala runs in huge pages of this isolate rather than a per thread allocation
+        if (algo == xmrig::Algorithm::RX_XLA) {
+            if (!state->yespower_mem) state->yespower_mem.reset(new xmrig::VirtualMemory(randomx_yespower_arena_size(), true, false, 0, 4096));
+            randomx_vm_set_yespower_arena(state->rx_vm[rxid], state->yespower_mem->raw(), state->yespower_mem->size());
+        }
+    }
+
+    return state->rx_vm[rxid];
+}
+
+void rx_calculate_hash(const uint8_t* seed_hash, const xmrig::Algorithm::Id algo, const uint8_t* input, const size_t size, uint8_t* output) {
+    randomx_calculate_hash(rx_get_vm(seed_hash, algo), input, size, output, algo);
+}
+
+void rx_calculate_hash_2(const uint8_t* seed_hash, const xmrig::Algorithm::Id algo, const uint8_t* const input[2], const size_t size, uint8_t* const output[2]) {
+    randomx_calculate_hash_2(rx_get_vm(seed_hash, algo), reinterpret_cast<const void* const*>(input), size, reinterpret_cast<void* const*>(output), algo);
+}
+
+void reset_rx_vms() {
+    for (int i = 0; i < MAXRX; ++i) {
+        if (isolate_state->rx_vm[i]) {
+            randomx_destroy_vm(isolate_state->rx_vm[i]);
+            isolate_state->rx_vm[i] = nullptr;
+        }
+    }
+}
+
+static void ghostrider(const unsigned char* data, long unsigned int size, unsigned char* output, cryptonight_ctx** ctx, long unsigned int) {
+    xmrig::ghostrider::hash(data, size, output, ctx, nullptr);
+}
+
+// Scratchpad is the L3 size of the algo, AstroBWT's 20 MB included
+#define CN_HASH(algo)     CnHashFn{ FN(algo), xmrig::Algorithm(xmrig::Algorithm::algo).l3(), xmrig::Algorithm::algo, false }
+#define CN_HASH_ASM(algo) CnHashFn{ FNA(algo), xmrig::Algorithm(xmrig::Algorithm::algo).l3(), xmrig::Algorithm::algo, true }
+
+CnHashFn get_cn_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH(CN_0);
+    case 1:  return CN_HASH(CN_1);
+    case 4:  return CN_HASH(CN_FAST);
+    case 6:  return CN_HASH(CN_XAO);
+    case 7:  return CN_HASH(CN_RTO);
+    case 8:  return CN_HASH_ASM(CN_2);
+    case 9:  return CN_HASH_ASM(CN_HALF);
+    case 11: return CN_HASH(CN_GPU);
+    case 13: return CN_HASH_ASM(CN_R);
+    case 14: return CN_HASH_ASM(CN_RWZ);
+    case 15: return CN_HASH_ASM(CN_ZLS);
+    case 16: return CN_HASH_ASM(CN_DOUBLE);
+    case 17: return CN_HASH_ASM(CN_CCX);
+    case 18: return CnHashFn{ ghostrider, xmrig::Algorithm::l3(xmrig::Algorithm::GHOSTRIDER_RTM), xmrig::Algorithm::INVALID, false };
+    default: return CN_HASH(CN_R);
+  }
+}
+
+CnHashFn get_cn_lite_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH(CN_LITE_0);
+    case 1:  return CN_HASH(CN_LITE_1);
+    default: return CN_HASH(CN_LITE_1);
+  }
+}
+
+CnHashFn get_cn_heavy_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH(CN_HEAVY_0);
+    case 1:  return CN_HASH(CN_HEAVY_XHV);
+    case 2:  return CN_HASH(CN_HEAVY_TUBE);
+    default: return CN_HASH(CN_HEAVY_0);
+  }
+}
+
+CnHashFn get_cn_pico_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH_ASM(CN_PICO_0);
+    default: return CN_HASH_ASM(CN_PICO_0);
+  }
+}
+
+CnHashFn get_argon2_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH(AR2_CHUKWA);
+    case 1:  return CN_HASH(AR2_WRKZ);
+    case 2:  return CN_HASH(AR2_CHUKWA_V2);
+    default: return CN_HASH(AR2_CHUKWA);
+  }
+}
+
+CnHashFn get_astrobwt_fn(const int algo) {
+  switch (algo) {
+    case 0:  return CN_HASH(ASTROBWT_DERO);
+    case 1:  return CN_HASH(ASTROBWT_DERO_2);
+    default: return CN_HASH(ASTROBWT_DERO);
+  }
+}
+
+CnHashFn get_family_fn(const int family, const int algo) {
+    switch (family) {
+        case FAMILY_CN:       return get_cn_fn(algo);
+        case FAMILY_CN_LITE:  return get_cn_lite_fn(algo);
+        case FAMILY_CN_HEAVY: return get_cn_heavy_fn(algo);
+        case FAMILY_CN_PICO:  return get_cn_pico_fn(algo);
+        case FAMILY_ARGON2:   return get_argon2_fn(algo);
+        case FAMILY_ASTROBWT: return get_astrobwt_fn(algo);
+        default:              return CnHashFn{ nullptr, 0, xmrig::Algorithm::INVALID, false };
+    }
+}
+
+static ethash_light_t get_light_cache(std::shared_ptr<SharedCache<EthashCache>::Entry>& current, const int height, const int epoch_seed, const int epoch) {
+        if (!current || current->value->epoch_seed != epoch_seed || current->value->epoch != epoch) {
+            current = ethash_caches.get(std::to_string(epoch_seed) + ":" + std::to_string(epoch), [height, epoch_seed, epoch]() {
+                std::unique_ptr<EthashCache> cache(new EthashCache());
+                cache->epoch_seed = epoch_seed;
+                cache->epoch      = epoch;
+
+                // Light cache nodes of the epoch are the same in every process
+                const uint64_t size = ethash_get_cachesize(epoch);
+                cache->shm = shm_cache_attach("ethash-" + std::to_string(epoch_seed) + "-" + std::to_string(epoch), size, [epoch_seed, size](uint8_t* data) {
+                    const ethash_h256_t seedhash = ethash_get_seedhash(epoch_seed);
+                    return ethash_compute_cache_nodes(data, size, &seedhash);
+                });
+                cache->light = cache->shm ? ethash_light_new_external(height, epoch, cache->shm->data(), size) : ethash_light_new(height, epoch_seed, epoch);
+                return cache.release();
+            });
+        }
+        return current->value->light;
+}
+
+ethash_light_t get_ethash_cache(const int height) {
+        isolate_state->ethash_used = now_ms();
+        release_idle(isolate_state, isolate_state->ethash_used);
+        const int epoch = height / ETHASH_EPOCH_LENGTH;
+        return get_light_cache(isolate_state->ethash_cache, height, epoch, epoch);
+}
+
+void get_etchash_epoch(const int height, int& epoch_seed, int& epoch) {
+        const int epoch_length = height >= ETCHASH_EPOCH_HEIGHT ? ETCHASH_EPOCH_LENGTH : ETHASH_EPOCH_LENGTH;
+        epoch      = height / epoch_length;
+        epoch_seed = (epoch * epoch_length + 1) / ETHASH_EPOCH_LENGTH;
+}
+
+ethash_light_t get_etchash_cache(const int height) {
+        isolate_state->etchash_used = now_ms();
+        release_idle(isolate_state, isolate_state->etchash_used);
+        int epoch_seed, epoch;
+        get_etchash_epoch(height, epoch_seed, epoch);
+        return get_light_cache(isolate_state->etchash_cache, height, epoch_seed, epoch);
+}
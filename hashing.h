@@ -0,0 +1,249 @@
+#pragma once
+
+// Hashing state and algorithm dispatch shared by the addon (multihashing.cc) and the verification
+// daemon (hashd.cc). Nothing in here depends on node.
+
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "crypto/common/VirtualMemory.h"
+#include "crypto/cn/CnCtx.h"
+#include "crypto/cn/CnHash.h"
+#include "crypto/randomx/configuration.h"
+#include "crypto/randomx/randomx.h"
+#include "3rdparty/libethash/ethash.h"
+#include "rx_cache_store.h"
+#include "shm_cache.h"
+
+#if defined(__ARM_ARCH)
+  #define my_malloc(a, b) malloc(a)
+  #define my_free(a) free(a)
+#else
+  #define my_malloc(a, b) _mm_malloc(a, b)
+  #define my_free(a) _mm_free(a)
+#endif
+#if (defined(__AES__) && (__AES__ == 1)) || (defined(__ARM_FEATURE_CRYPTO) && (__ARM_FEATURE_CRYPTO == 1))
+  #define SOFT_AES false
+  #if defined(CPU_INTEL)
+    #warning Using IvyBridge assembler implementation
+    #define ASM_TYPE xmrig::Assembly::INTEL
+  #elif defined(CPU_AMD)
+    #warning Using Ryzen assembler implementation
+    #define ASM_TYPE xmrig::Assembly::RYZEN
+  #elif defined(CPU_AMD_OLD)
+    #warning Using Bulldozer assembler implementation
+    #define ASM_TYPE xmrig::Assembly::BULLDOZER
+  #elif !defined(__ARM_ARCH)
+    #error Unknown ASM implementation!
+  #endif
+#else
+  #warning Using software AES
+  #define SOFT_AES true
+#endif
+
+// CN asm variant, the build time guess until tune() measures it
+extern std::atomic<int> cn_assembly;
+
+#define FN(algo)  xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
+#define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, static_cast<xmrig::Assembly::Id>(cn_assembly.load(std::memory_order_relaxed)))
+
+
+const int MAXRX = 7;
+int rx2id(xmrig::Algorithm::Id algo);
+const RandomX_ConfigurationBase& get_rx_config(xmrig::Algorithm::Id algo);
+
+// RandomX variant of the algo number of the JS API
+xmrig::Algorithm::Id get_rx_algo(int algo);
+
+// Read-only heavy state (initialised RandomX caches, ethash light caches) is shared by reference
+// count between all threads that hash, so worker_threads do not duplicate it.
+template <typename T>
+class SharedCache {
+public:
+    struct Entry {
+        std::once_flag once;
+        std::unique_ptr<T> value;
+    };
+
+    template <typename F>
+    std::shared_ptr<Entry> get(const std::string& key, F create) {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                if (it->second.expired()) it = m_entries.erase(it); else ++it;
+            }
+            entry = m_entries[key].lock();
+            if (!entry) {
+                entry = std::make_shared<Entry>();
+                m_entries[key] = entry;
+            }
+        }
+        // Other isolates asking for the same key wait here until the first one has initialised it
+        std::call_once(entry->once, [&entry, &create]() { entry->value.reset(create()); });
+        return entry;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::map<std::string, std::weak_ptr<Entry>> m_entries;
+};
+
+const uint32_t RX_CACHE_ANY_NODE = UINT32_MAX;
+
+struct RxCache {
+    ~RxCache() {
+        if (cache) randomx_release_cache(cache);
+        if (memory && !stored && !shm) my_free(memory);
+    }
+
+    uint8_t* memory      = nullptr;
+    randomx_cache* cache = nullptr;
+    std::unique_ptr<RxStoredCache> stored;  // memory is mapped from the on-disk store
+    std::unique_ptr<ShmCache> shm;          // memory is shared with other processes
+    std::atomic<bool> save_pending{false};  // freshly initialised, not in the store yet
+    const char* argon2_impl = nullptr;      // fill_segment used to initialise it
+    uint32_t node = RX_CACHE_ANY_NODE;      // NUMA node memory is placed on
+    std::shared_ptr<const void> source;     // replicas keep the cache they were copied from
+};
+
+struct EthashCache {
+    ~EthashCache() {
+        if (light) ethash_light_delete(light);
+    }
+
+    int epoch_seed        = 0;
+    int epoch             = 0;
+    ethash_light_t light  = nullptr;
+    std::unique_ptr<ShmCache> shm;  // light cache nodes shared with other processes
+};
+
+extern SharedCache<RxCache>     rx_caches;
+extern SharedCache<EthashCache> ethash_caches;
+
+// Per-thread scratch state: the main thread and every worker_thread of the addon, and every
+// worker of the daemon, hash with their own CryptoNight context and RandomX VMs. Nothing is
+// allocated up front: the context grows to the largest scratchpad of the algos hashed so far,
+// the RandomX scratchpad comes with the first VM, and all of it can be released again.
+struct IsolateState {
+    ~IsolateState();
+
+    // Context with a scratchpad of at least the given size
+    cryptonight_ctx** cn_ctx(size_t memory);
+
+    // Scratchpad of the RandomX VMs, all variants share it
+    uint8_t* rx_scratchpad();
+
+    // These return the bytes released: scratch memory, and caches this isolate held the last reference to
+    size_t release_cn();
+    size_t release_rx(int rxid);
+    size_t release_ethash();
+    size_t release_etchash();
+
+    // Releases everything not used for the last idle_ms milliseconds
+    size_t trim(uint64_t idle_ms);
+
+    // Takes over what a state prepared on another thread has and this one lacks: a larger context,
+    // the RandomX VMs when there are none yet, and all caches. The rest goes with the other state.
+    void adopt(IsolateState& warm);
+
+    cryptonight_ctx* ctx = nullptr;
+    uint8_t* ctx_memory  = nullptr;
+    size_t ctx_size      = 0;
+
+    std::unique_ptr<xmrig::VirtualMemory> rx_mem;
+    std::unique_ptr<xmrig::VirtualMemory> yespower_mem;
+    randomx_vm* rx_vm[MAXRX]            = {};
+    uint8_t rx_seed_hash[MAXRX][32]     = {};
+    std::shared_ptr<SharedCache<RxCache>::Entry> rx_cache[MAXRX];
+
+    std::shared_ptr<SharedCache<EthashCache>::Entry> ethash_cache;
+    std::shared_ptr<SharedCache<EthashCache>::Entry> etchash_cache;
+
+    // Caches of other seeds and epochs than the current ones (the next seed, say) kept by warmup
+    std::vector<std::shared_ptr<SharedCache<RxCache>::Entry>> rx_warm[MAXRX];
+    std::vector<std::shared_ptr<SharedCache<EthashCache>::Entry>> ethash_warm;
+    std::vector<std::shared_ptr<SharedCache<EthashCache>::Entry>> etchash_warm;
+
+    // Last use of each part, in steady clock milliseconds
+    uint64_t cn_used           = 0;
+    uint64_t rx_used[MAXRX]    = {};
+    uint64_t ethash_used       = 0;
+    uint64_t etchash_used      = 0;
+    uint64_t idle_checked      = 0;
+};
+
+// What an isolate has not used for this long is released by its next hash, 0 (the default) keeps everything
+void set_idle_timeout(uint64_t ms);
+uint64_t get_idle_timeout();
+
+// Whether RandomX VMs created from now on compile their programs (not on ARM), off they run the
+// bytecode interpreter. VMs keep what they were created with until released or reset.
+void set_rx_jit(bool enabled);
+bool get_rx_jit();
+
+// Node runs every isolate on its own thread, so this is the state of the calling isolate or daemon worker
+extern thread_local IsolateState* isolate_state;
+
+// VM of the calling thread for the algo, switched to the cache of the seed hash
+randomx_vm* rx_get_vm(const uint8_t* seed_hash, xmrig::Algorithm::Id algo);
+
+void rx_calculate_hash(const uint8_t* seed_hash, xmrig::Algorithm::Id algo, const uint8_t* input, size_t size, uint8_t* output);
+
+// Two equally sized inputs with the same seed hash, interleaved where the algo supports it (Scala's yespower stage)
+void rx_calculate_hash_2(const uint8_t* seed_hash, xmrig::Algorithm::Id algo, const uint8_t* const input[2], size_t size, uint8_t* const output[2]);
+
+// Forgets the RandomX VMs of the calling thread, so the next hash creates them with the current JIT settings
+void reset_rx_vms();
+
+// CryptoNight style hash function of an algo number of the JS API and the scratchpad it needs.
+// algo and assembly tell scan() which multi-way kernels exist, INVALID when there are none.
+struct CnHashFn {
+    xmrig::cn_hash_fun fn;
+    size_t memory;
+    xmrig::Algorithm::Id algo;
+    bool assembly;
+
+    void operator()(const uint8_t* input, size_t size, uint8_t* output, uint64_t height) const {
+        fn(input, size, output, isolate_state->cn_ctx(memory), height);
+    }
+};
+
+CnHashFn get_cn_fn(int algo);
+CnHashFn get_cn_lite_fn(int algo);
+CnHashFn get_cn_heavy_fn(int algo);
+CnHashFn get_cn_pico_fn(int algo);
+CnHashFn get_argon2_fn(int algo);
+CnHashFn get_astrobwt_fn(int algo);
+
+// Hash families, numbered as in the daemon protocol
+enum HashFamily {
+    FAMILY_CN       = 0,
+    FAMILY_CN_LITE  = 1,
+    FAMILY_CN_HEAVY = 2,
+    FAMILY_CN_PICO  = 3,
+    FAMILY_ARGON2   = 4,
+    FAMILY_ASTROBWT = 5,
+    FAMILY_K12      = 6,
+    FAMILY_RANDOMX  = 7,
+    FAMILY_ETHASH   = 8,
+    FAMILY_ETCHASH  = 9,
+    FAMILY_KAWPOW   = 10,
+    FAMILY_COUNT
+};
+
+// Hash function of a CryptoNight style family, fn is nullptr for the others
+CnHashFn get_family_fn(int family, int algo);
+
+// Light caches of the epoch of the block height, shared like the RandomX caches
+ethash_light_t get_ethash_cache(int height);
+ethash_light_t get_etchash_cache(int height);
+
+// Seed and size epochs of the etchash light cache of a block height, epochs double in length
+// from ETCHASH_EPOCH_HEIGHT on
+void get_etchash_epoch(int height, int& epoch_seed, int& epoch);
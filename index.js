@@ -58,7 +58,8 @@ module.exports.autolykos2_hashes = function(coinbaseBuffer, height) {
   const i = BigIntBuffer.toBufferBE(BigIntBuffer.toBigIntBE(blake2b(coinbaseBuffer).slice(24, 32)) % N(height), 4);
   const e = blake2b(Buffer.concat([i, h, M])).slice(1, 32);
   const J = genIndexes(Buffer.concat([e, coinbaseBuffer]), height).map(item => BigIntBuffer.toBufferBE(BigInt(item), 4));
-  const f = J.map(item => BigIntBuffer.toBigIntBE(blake2b(Buffer.concat([item, h, M])).slice(1, 32))).reduce((a, b) => a + b);
+  // The 32 element hashes have equal length inputs, so they go through the native multi-buffer blake2b
+  const f = module.exports.blake2b_multi(J.map(item => Buffer.concat([item, h, M])), 32).map(item => BigIntBuffer.toBigIntBE(item.slice(1, 32))).reduce((a, b) => a + b);
   const hash = BigIntBuffer.toBufferBE(f, 32);
 
   return [ hash, blake2b(hash) ];
@@ -5,18 +5,13 @@
 #include <nan.h>
 #include <stdexcept>
 
-#if defined(__ARM_ARCH)
-  #define my_malloc(a, b) malloc(a)
-#else
-  #define my_malloc(a, b) _mm_malloc(a, b)
-#endif
-
 //#if (defined(__AES__) && (__AES__ == 1)) || defined(__APPLE__) || defined(__ARM_ARCH)
 //#else
 //#define _mm_aeskeygenassist_si128(a, b) a
 //#define _mm_aesenc_si128(a, b) a
 //#endif
 
+#include "backend/cpu/Cpu.h"
 #include "crypto/common/VirtualMemory.h"
 #include "crypto/cn/CnCtx.h"
 #include "crypto/cn/CnHash.h"
@@ -28,8 +23,19 @@
 #include "crypto/ghostrider/ghostrider.h"
 #include "3rdparty/equihash/equihash.h"
 #include "base/crypto/KeccakHash.h"
+#include "3rdparty/argon2.h"
 #include <vector>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
@@ -42,126 +48,23 @@ extern "C" {
 }
 
 #include "c29.h"
+#include "hashing.h"
+#include "rx_cache_store.h"
+#include "numa.h"
+#include "scan.h"
+#include "warmup.h"
+#include "ring.h"
+#include "capture.h"
 
-#if (defined(__AES__) && (__AES__ == 1)) || (defined(__ARM_FEATURE_CRYPTO) && (__ARM_FEATURE_CRYPTO == 1))
-  #define SOFT_AES false
-  #if defined(CPU_INTEL)
-    #warning Using IvyBridge assembler implementation
-    #define ASM_TYPE xmrig::Assembly::INTEL
-  #elif defined(CPU_AMD)
-    #warning Using Ryzen assembler implementation
-    #define ASM_TYPE xmrig::Assembly::RYZEN
-  #elif defined(CPU_AMD_OLD)
-    #warning Using Bulldozer assembler implementation
-    #define ASM_TYPE xmrig::Assembly::BULLDOZER
-  #elif !defined(__ARM_ARCH)
-    #error Unknown ASM implementation!
-  #endif
-#else
-  #warning Using software AES
-  #define SOFT_AES true
-#endif
-
-#define FN(algo)  xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
-#if defined(ASM_TYPE)
-  #define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, ASM_TYPE)
-#else
-  #define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
-#endif
-
-
-const size_t max_mem_size = 20 * 1024 * 1024;
-xmrig::VirtualMemory mem(max_mem_size, true, false, 0, 4096);
-static struct cryptonight_ctx* ctx = nullptr;
 const char* ToCString(const Nan::Utf8String& value) {
   return *value ? *value : "<string conversion failed>";
 }
-const int MAXRX = 7;
-int rx2id(xmrig::Algorithm::Id algo) {
-  switch (algo) {
-      case xmrig::Algorithm::RX_0:     return 0;
-      case xmrig::Algorithm::RX_WOW:   return 1;
-      case xmrig::Algorithm::RX_ARQ:   return 2;
-      case xmrig::Algorithm::RX_GRAFT: return 3;
-      case xmrig::Algorithm::RX_SFX:   return 4;
-      case xmrig::Algorithm::RX_KEVA:  return 5;
-      case xmrig::Algorithm::RX_XLA:   return MAXRX-1;
-      default: return 0;
-  }
-}
-
-static randomx_cache* rx_cache[MAXRX]         = {nullptr};
-static randomx_vm*    rx_vm[MAXRX]            = {nullptr};
-static uint8_t        rx_seed_hash[MAXRX][32] = {};
-
-struct InitCtx {
-    InitCtx() {
-        xmrig::CnCtx::create(&ctx, static_cast<uint8_t*>(my_malloc(max_mem_size, 4096)), max_mem_size, 1);
-    }
-} s;
-
-void init_rx(const uint8_t* seed_hash_data, xmrig::Algorithm::Id algo) {
-    bool update_cache = false;
-    const int rxid = rx2id(algo);
-    assert(rxid < MAXRX);
-
-    randomx_set_scratchpad_prefetch_mode(0);
-    randomx_set_huge_pages_jit(false);
-    //randomx_set_optimized_dataset_init(0);
-
-    if (!rx_cache[rxid]) {
-        uint8_t* const pmem = static_cast<uint8_t*>(my_malloc(RANDOMX_CACHE_MAX_SIZE, 4096));
-        rx_cache[rxid] = randomx_create_cache(RANDOMX_FLAG_JIT, pmem);
-        update_cache = true;
-    }
-    else if (memcmp(rx_seed_hash[rxid], seed_hash_data, sizeof(rx_seed_hash[0])) != 0) {
-        update_cache = true;
-    }
-
-    switch (algo) {
-        case xmrig::Algorithm::RX_0:
-            randomx_apply_config(RandomX_MoneroConfig);
-            break;
-        case xmrig::Algorithm::RX_WOW:
-            randomx_apply_config(RandomX_WowneroConfig);
-            break;
-        case xmrig::Algorithm::RX_ARQ:
-            randomx_apply_config(RandomX_ArqmaConfig);
-            break;
-        case xmrig::Algorithm::RX_GRAFT:
-            randomx_apply_config(RandomX_GraftConfig);
-            break;
-        case xmrig::Algorithm::RX_KEVA:
-            randomx_apply_config(RandomX_KevaConfig);
-            break;
-        case xmrig::Algorithm::RX_XLA:
-            randomx_apply_config(RandomX_ScalaConfig);
-            break;
-        default:
-            throw std::domain_error("Unknown RandomX algo");
-    }
-
-    if (update_cache) {
-        memcpy(rx_seed_hash[rxid], seed_hash_data, sizeof(rx_seed_hash[0]));
-        randomx_init_cache(rx_cache[rxid], rx_seed_hash[rxid], sizeof(rx_seed_hash[0]));
-        if (rx_vm[rxid]) {
-            randomx_vm_set_cache(rx_vm[rxid], rx_cache[rxid]);
-        }
-    }
 
-    if (!rx_vm[rxid]) {
-        int flags = 0;
-#if !defined(__ARM_ARCH)
-        flags |= RANDOMX_FLAG_JIT;
-#endif
-#if !SOFT_AES
-        flags |= RANDOMX_FLAG_HARD_AES;
-#endif
-
-        rx_vm[rxid] = randomx_create_vm(static_cast<randomx_flags>(flags), rx_cache[rxid], nullptr, mem.scratchpad(), 0);
-    }
+static void release_isolate_state(void* arg) {
+    IsolateState* state = static_cast<IsolateState*>(arg);
+    if (isolate_state == state) isolate_state = nullptr;
+    delete state;
 }
-
 #define THROW_ERROR_EXCEPTION(x) Nan::ThrowError(x)
 
 void callback(char* data, void* hint) {
@@ -172,6 +75,145 @@ using namespace node;
 using namespace v8;
 using namespace Nan;
 
+// Flags returned by the *_check variants
+const uint32_t CHECK_SHARE = 1;
+const uint32_t CHECK_BLOCK = 2;
+
+// Share/block target for the *_check variants: either the usual 64-bit pool target
+// (Number or BigInt) compared against the most significant hash word, or a full
+// 32 byte boundary in the same byte order as the hash itself.
+struct HashTarget {
+    bool     full;
+    uint64_t value;
+    uint8_t  boundary[32];
+};
+
+static bool get_target(const Local<Value>& arg, HashTarget& target) {
+    target.full = false;
+    if (arg->IsBigInt()) {
+        bool lossless = true;
+        target.value = arg.As<BigInt>()->Uint64Value(&lossless);
+        return lossless;
+    }
+    if (arg->IsNumber()) {
+        const double value = Nan::To<double>(arg).FromMaybe(0);
+        if (value < 0) return false;
+        target.value = value >= 18446744073709551615.0 ? UINT64_MAX : static_cast<uint64_t>(value);
+        return true;
+    }
+    if (Buffer::HasInstance(arg) && Buffer::Length(arg) == sizeof(target.boundary)) {
+        target.full = true;
+        memcpy(target.boundary, Buffer::Data(arg), sizeof(target.boundary));
+        return true;
+    }
+    return false;
+}
+
+// CryptoNote style hashes are little endian numbers, ethash and kawpow ones are big endian.
+// 64-bit targets use the strict "<" comparison of xmrig, full boundaries the "<=" one of ethash.
+static bool meets_target(const uint8_t* hash, const HashTarget& target, const bool big_endian) {
+    if (!target.full) {
+        uint64_t top = 0;
+        for (int i = 0; i < 8; ++i) top = (top << 8) | (big_endian ? hash[i] : hash[31 - i]);
+        return top < target.value;
+    }
+    for (int i = 0; i < 32; ++i) {
+        const int j = big_endian ? i : 31 - i;
+        if (hash[j] != target.boundary[j]) return hash[j] < target.boundary[j];
+    }
+    return true;
+}
+
+// Optional trailing output buffer: the hash is written there and the buffer itself is returned.
+static const char* get_output_arg(const Nan::FunctionCallbackInfo<v8::Value>& info, const int index, uint8_t*& out) {
+    out = nullptr;
+    if (info.Length() > index && !info[index]->IsUndefined()) {
+        if (!Buffer::HasInstance(info[index]) || Buffer::Length(info[index]) < 32) return "Hash output should be an at least 32 bytes long buffer object.";
+        out = reinterpret_cast<uint8_t*>(Buffer::Data(info[index]));
+    }
+    return nullptr;
+}
+
+static void set_hash_result(const Nan::FunctionCallbackInfo<v8::Value>& info, const int index, const uint8_t* hash, uint8_t* out) {
+    if (out) {
+        memcpy(out, hash, 32);
+        info.GetReturnValue().Set(info[index]);
+    } else {
+        info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<const char*>(hash), 32).ToLocalChecked());
+    }
+}
+
+// Parses the "share target, block target[, hash output buffer]" tail of the *_check variants.
+static const char* get_check_args(const Nan::FunctionCallbackInfo<v8::Value>& info, const int first, HashTarget& share, HashTarget& block, uint8_t*& out) {
+    if (!get_target(info[first], share)) return "Share target should be a number, a BigInt or a 32 bytes long buffer object.";
+    if (!get_target(info[first + 1], block)) return "Block target should be a number, a BigInt or a 32 bytes long buffer object.";
+    return get_output_arg(info, first + 2, out);
+}
+
+static uint32_t check_hash(const uint8_t* hash, const bool big_endian, const HashTarget& share, const HashTarget& block, uint8_t* out) {
+    if (out) memcpy(out, hash, 32);
+    uint32_t flags = 0;
+    if (meets_target(hash, share, big_endian)) flags |= CHECK_SHARE;
+    if (meets_target(hash, block, big_endian)) flags |= CHECK_BLOCK;
+    return flags;
+}
+
+// Appends the call to the open capture (capture.h), the payload being the buffers one after another
+static void capture_call(const uint8_t family, const int algo, const uint64_t height, const uint8_t* seed_hash, std::initializer_list<Local<Value>> buffers) {
+    if (!capturing()) return;
+    std::vector<uint8_t> payload;
+    for (const Local<Value>& buffer : buffers) payload.insert(payload.end(), Buffer::Data(buffer), Buffer::Data(buffer) + Buffer::Length(buffer));
+    capture_hash(family, algo, payload.data(), payload.size(), height, seed_hash);
+}
+
+// capture(path): appends every hash request from now on to a new capture file at the path, for
+// replaying it with cryptonight-replay. No argument stops the capture.
+NAN_METHOD(capture) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && !info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+
+    if (info.Length() < 1 || info[0]->IsUndefined()) return capture_close();
+    const std::string path = *Nan::Utf8String(info[0]);
+    if (!capture_open(path)) return THROW_ERROR_EXCEPTION(("Can't create capture file " + path).c_str());
+}
+
+// Enables the on-disk RandomX cache store in the given directory, no argument disables it
+NAN_METHOD(randomx_cache_dir) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && !info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+
+    rx_cache_store_dir(info.Length() >= 1 && info[0]->IsString() ? std::string(*Nan::Utf8String(info[0])) : std::string());
+}
+
+// Shares initialised RandomX and ethash light caches with other processes through shared memory
+// objects named with the given prefix, no argument disables it
+NAN_METHOD(shared_caches) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && !info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+
+    const std::string prefix = info.Length() >= 1 && info[0]->IsString() ? std::string(*Nan::Utf8String(info[0])) : std::string();
+    if (prefix.find('/') != std::string::npos) return THROW_ERROR_EXCEPTION("Argument 1 should not contain '/'.");
+    shm_cache_prefix(prefix);
+}
+
+// randomx_cache_timing(algo): how long initialising the current cache of the algo took in this
+// isolate, in milliseconds, undefined before the first hash
+NAN_METHOD(randomx_cache_timing) {
+    if (info.Length() < 1 || !info[0]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 1 should be a number");
+
+    const int rxid = rx2id(get_rx_algo(Nan::To<int>(info[0]).FromMaybe(0)));
+    if (!isolate_state->rx_cache[rxid]) return;
+
+    const RxCache* cache = isolate_state->rx_cache[rxid]->value.get();
+    const struct randomx_cache_timing timing = randomx_get_cache_timing(cache->cache);
+
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("stored").ToLocalChecked(), Nan::New(static_cast<bool>(cache->stored)));
+    Nan::Set(result, Nan::New("shared").ToLocalChecked(), Nan::New(static_cast<bool>(cache->shm)));
+    Nan::Set(result, Nan::New("argon2").ToLocalChecked(), Nan::New(timing.argon2 / 1e6));
+    Nan::Set(result, Nan::New("superscalar").ToLocalChecked(), Nan::New(timing.superscalar / 1e6));
+    Nan::Set(result, Nan::New("total").ToLocalChecked(), Nan::New(timing.total / 1e6));
+    if (cache->argon2_impl) Nan::Set(result, Nan::New("argon2_impl").ToLocalChecked(), Nan::New(cache->argon2_impl).ToLocalChecked());
+    info.GetReturnValue().Set(result);
+}
+
 NAN_METHOD(randomx) {
     if (info.Length() < 2) return THROW_ERROR_EXCEPTION("You must provide two arguments.");
 
@@ -181,7 +223,7 @@ NAN_METHOD(randomx) {
 
     Local<Object> seed_hash = info[1]->ToObject(isolate->GetCurrentContext()).ToLocalChecked();
     if (!Buffer::HasInstance(seed_hash)) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
-    if (Buffer::Length(seed_hash) != sizeof(rx_seed_hash[0])) return THROW_ERROR_EXCEPTION("Argument 2 size should be 32 bytes.");
+    if (Buffer::Length(seed_hash) != 32) return THROW_ERROR_EXCEPTION("Argument 2 size should be 32 bytes.");
 
     int algo = 0;
     if (info.Length() >= 3) {
@@ -189,96 +231,45 @@ NAN_METHOD(randomx) {
         algo = Nan::To<int>(info[2]).FromMaybe(0);
     }
 
-    xmrig::Algorithm xalgo;
-    switch (algo) {
-        case 0:  xalgo = xmrig::Algorithm::RX_0; break;
-        //case 1:  xalgo = xmrig::Algorithm::RX_DEFYX; break;
-        case 2:  xalgo = xmrig::Algorithm::RX_ARQ; break;
-        case 3:  xalgo = xmrig::Algorithm::RX_XLA; break;
-        case 17: xalgo = xmrig::Algorithm::RX_WOW; break;
-        //case 18: xalgo = xmrig::Algorithm::RX_LOKI; break;
-        case 19: xalgo = xmrig::Algorithm::RX_KEVA; break;
-        case 20: xalgo = xmrig::Algorithm::RX_GRAFT; break;
-        default: xalgo = xmrig::Algorithm::RX_0;
-    }
+    const xmrig::Algorithm xalgo = get_rx_algo(algo);
 
+    capture_call(FAMILY_RANDOMX, algo, 0, reinterpret_cast<const uint8_t*>(Buffer::Data(seed_hash)), { target });
+    char output[32];
     try {
-        init_rx(reinterpret_cast<const uint8_t*>(Buffer::Data(seed_hash)), xalgo);
+        rx_calculate_hash(reinterpret_cast<const uint8_t*>(Buffer::Data(seed_hash)), xalgo, reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output));
     } catch (const std::domain_error &e) {
         return THROW_ERROR_EXCEPTION(e.what());
     }
 
-    char output[32];
-    randomx_calculate_hash(rx_vm[rx2id(xalgo)], reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), xalgo);
-
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
 }
 
-void ghostrider(const unsigned char* data, long unsigned int size, unsigned char* output, cryptonight_ctx** ctx, long unsigned int) {
-    xmrig::ghostrider::hash(data, size, output, ctx, nullptr);
-}
-
-static xmrig::cn_hash_fun get_cn_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FN(CN_0);
-    case 1:  return FN(CN_1);
-    case 4:  return FN(CN_FAST);
-    case 6:  return FN(CN_XAO);
-    case 7:  return FN(CN_RTO);
-    case 8:  return FNA(CN_2);
-    case 9:  return FNA(CN_HALF);
-    case 11: return FN(CN_GPU);
-    case 13: return FNA(CN_R);
-    case 14: return FNA(CN_RWZ);
-    case 15: return FNA(CN_ZLS);
-    case 16: return FNA(CN_DOUBLE);
-    case 17: return FNA(CN_CCX);
-    case 18: return ghostrider;
-    default: return FN(CN_R);
-  }
-}
+NAN_METHOD(randomx_check) {
+    if (info.Length() < 5) return THROW_ERROR_EXCEPTION("You must provide at least five arguments: blob, seed hash, algo, share target, block target.");
 
-static xmrig::cn_hash_fun get_cn_lite_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FN(CN_LITE_0);
-    case 1:  return FN(CN_LITE_1);
-    default: return FN(CN_LITE_1);
-  }
-}
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    if (!Buffer::HasInstance(info[1])) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+    if (Buffer::Length(info[1]) != 32) return THROW_ERROR_EXCEPTION("Argument 2 size should be 32 bytes.");
+    if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
 
-static xmrig::cn_hash_fun get_cn_heavy_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FN(CN_HEAVY_0);
-    case 1:  return FN(CN_HEAVY_XHV);
-    case 2:  return FN(CN_HEAVY_TUBE);
-    default: return FN(CN_HEAVY_0);
-  }
-}
+    HashTarget share, block;
+    uint8_t* out;
+    const char* error = get_check_args(info, 3, share, block, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-static xmrig::cn_hash_fun get_cn_pico_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FNA(CN_PICO_0);
-    default: return FNA(CN_PICO_0);
-  }
-}
-static xmrig::cn_hash_fun get_argon2_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FN(AR2_CHUKWA);
-    case 1:  return FN(AR2_WRKZ);
-    case 2:  return FN(AR2_CHUKWA_V2);
-    default: return FN(AR2_CHUKWA);
-  }
-}
+    const xmrig::Algorithm xalgo = get_rx_algo(Nan::To<int>(info[2]).FromMaybe(0));
 
-static xmrig::cn_hash_fun get_astrobwt_fn(const int algo) {
-  switch (algo) {
-    case 0:  return FN(ASTROBWT_DERO);
-    case 1:  return FN(ASTROBWT_DERO_2);
-    default: return FN(ASTROBWT_DERO);
-  }
-}
+    capture_call(FAMILY_RANDOMX, Nan::To<int>(info[2]).FromMaybe(0), 0, reinterpret_cast<const uint8_t*>(Buffer::Data(info[1])), { info[0] });
+    uint8_t output[32];
+    try {
+        rx_calculate_hash(reinterpret_cast<const uint8_t*>(Buffer::Data(info[1])), xalgo, reinterpret_cast<const uint8_t*>(Buffer::Data(info[0])), Buffer::Length(info[0]), output);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
+    info.GetReturnValue().Set(Nan::New<Number>(check_hash(output, false, share, block, out)));
+}
 
 /*//////////////////////////////////////////////SHA3X**/
 
@@ -362,15 +353,47 @@ NAN_METHOD(cryptonight) {
 
     if ((algo == 12 || algo == 13) && !height_set) return THROW_ERROR_EXCEPTION("CryptonightR requires block template height as Argument 3");
 
-    const xmrig::cn_hash_fun fn = get_cn_fn(algo);
+    const CnHashFn fn = get_cn_fn(algo);
 
+    capture_call(FAMILY_CN, algo, height, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), height);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
 }
 
+NAN_METHOD(cryptonight_check) {
+    if (info.Length() < 5) return THROW_ERROR_EXCEPTION("You must provide at least five arguments: blob, algo, height, share target, block target.");
+
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
+    if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
+
+    HashTarget share, block;
+    uint8_t* out;
+    const char* error = get_check_args(info, 3, share, block, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    const int algo = Nan::To<int>(info[1]).FromMaybe(0);
+    const uint64_t height = Nan::To<uint32_t>(info[2]).FromMaybe(0);
+    const CnHashFn fn = get_cn_fn(algo);
+
+    capture_call(FAMILY_CN, algo, height, nullptr, { info[0] });
+    uint8_t output[32];
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(info[0])), Buffer::Length(info[0]), output, height);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
+
+    info.GetReturnValue().Set(Nan::New<Number>(check_hash(output, false, share, block, out)));
+}
+
 NAN_METHOD(cryptonight_light) {
     if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
@@ -391,10 +414,15 @@ NAN_METHOD(cryptonight_light) {
         height = Nan::To<unsigned int>(info[2]).FromMaybe(0);
     }
 
-    const xmrig::cn_hash_fun fn = get_cn_lite_fn(algo);
+    const CnHashFn fn = get_cn_lite_fn(algo);
 
+    capture_call(FAMILY_CN_LITE, algo, height, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), height);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
@@ -421,10 +449,15 @@ NAN_METHOD(cryptonight_heavy) {
     }
 
 
-    const xmrig::cn_hash_fun fn = get_cn_heavy_fn(algo);
+    const CnHashFn fn = get_cn_heavy_fn(algo);
 
+    capture_call(FAMILY_CN_HEAVY, algo, height, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), height);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
@@ -444,10 +477,15 @@ NAN_METHOD(cryptonight_pico) {
         algo = Nan::To<int>(info[1]).FromMaybe(0);
     }
 
-    const xmrig::cn_hash_fun fn = get_cn_pico_fn(algo);
+    const CnHashFn fn = get_cn_pico_fn(algo);
 
+    capture_call(FAMILY_CN_PICO, algo, 0, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, 0);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), 0);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
@@ -467,15 +505,44 @@ NAN_METHOD(argon2) {
         algo = Nan::To<int>(info[1]).FromMaybe(0);
     }
 
-    const xmrig::cn_hash_fun fn = get_argon2_fn(algo);
+    const CnHashFn fn = get_argon2_fn(algo);
 
+    capture_call(FAMILY_ARGON2, algo, 0, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, 0);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), 0);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
 }
 
+NAN_METHOD(argon2_check) {
+    if (info.Length() < 4) return THROW_ERROR_EXCEPTION("You must provide at least four arguments: blob, algo, share target, block target.");
+
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
+
+    HashTarget share, block;
+    uint8_t* out;
+    const char* error = get_check_args(info, 2, share, block, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    const CnHashFn fn = get_argon2_fn(Nan::To<int>(info[1]).FromMaybe(0));
+
+    capture_call(FAMILY_ARGON2, Nan::To<int>(info[1]).FromMaybe(0), 0, nullptr, { info[0] });
+    uint8_t output[32];
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(info[0])), Buffer::Length(info[0]), output, 0);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
+
+    info.GetReturnValue().Set(Nan::New<Number>(check_hash(output, false, share, block, out)));
+}
+
 NAN_METHOD(astrobwt) {
     if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
@@ -490,263 +557,310 @@ NAN_METHOD(astrobwt) {
         algo = Nan::To<int>(info[1]).FromMaybe(0);
     }
 
-    const xmrig::cn_hash_fun fn = get_astrobwt_fn(algo);
+    const CnHashFn fn = get_astrobwt_fn(algo);
 
+    capture_call(FAMILY_ASTROBWT, algo, 0, nullptr, { target });
     char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, 0);
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), 0);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
     v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
     info.GetReturnValue().Set(returnValue);
 }
 
-NAN_METHOD(k12) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+NAN_METHOD(astrobwt_check) {
+    if (info.Length() < 4) return THROW_ERROR_EXCEPTION("You must provide at least four arguments: blob, algo, share target, block target.");
 
-    v8::Isolate *isolate = v8::Isolate::GetCurrent();
-    Local<Object> target = info[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked();
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
 
-    if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    HashTarget share, block;
+    uint8_t* out;
+    const char* error = get_check_args(info, 2, share, block, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-    char output[32];
-    KangarooTwelve((const unsigned char *)Buffer::Data(target), Buffer::Length(target), (unsigned char *)output, 32, 0, 0);
-
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
-}
+    const CnHashFn fn = get_astrobwt_fn(Nan::To<int>(info[1]).FromMaybe(0));
 
-static void setsipkeys(const char *keybuf,siphash_keys *keys) {
-	keys->k0 = htole64(((uint64_t *)keybuf)[0]);
-	keys->k1 = htole64(((uint64_t *)keybuf)[1]);
-	keys->k2 = htole64(((uint64_t *)keybuf)[2]);
-	keys->k3 = htole64(((uint64_t *)keybuf)[3]);
-}
+    capture_call(FAMILY_ASTROBWT, Nan::To<int>(info[1]).FromMaybe(0), 0, nullptr, { info[0] });
+    uint8_t output[32];
+    try {
+        fn(reinterpret_cast<const uint8_t*>(Buffer::Data(info[0])), Buffer::Length(info[0]), output, 0);
+    } catch (const std::domain_error &e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
 
-static void c29_setheader(const char *header, const uint32_t headerlen, siphash_keys *keys) {
-	char hdrkey[32];
-	rx_blake2b((void *)hdrkey, sizeof(hdrkey), (const void *)header, headerlen);
-	setsipkeys(hdrkey,keys);
+    info.GetReturnValue().Set(Nan::New<Number>(check_hash(output, false, share, block, out)));
 }
 
-NAN_METHOD(c29s) {
-	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
-
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
-
-	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
+NAN_METHOD(k12) {
+    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
-	Local<Array> ring = Local<Array>::Cast(info[1]);
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
-	uint32_t edges[PROOFSIZE];
-	for (uint32_t n = 0; n < PROOFSIZE; n++)
-		edges[n]=ring->Get(Nan::GetCurrentContext(), n).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+    uint8_t* out;
+    const char* error = get_output_arg(info, 1, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-	int retval = c29s_verify(edges,&keys);
+    capture_call(FAMILY_K12, 0, 0, nullptr, { info[0] });
+    uint8_t output[32];
+    KangarooTwelve((const unsigned char *)Buffer::Data(info[0]), Buffer::Length(info[0]), output, 32, 0, 0);
 
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+    set_hash_result(info, 1, output, out);
 }
 
-NAN_METHOD(c29v) {
-	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
+NAN_METHOD(k12_check) {
+    if (info.Length() < 3) return THROW_ERROR_EXCEPTION("You must provide at least three arguments: blob, share target, block target.");
 
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
+    if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
-	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
-
-	Local<Array> ring = Local<Array>::Cast(info[1]);
-
-	uint32_t edges[PROOFSIZE];
-	for (uint32_t n = 0; n < PROOFSIZE; n++)
-		edges[n]=ring->Get(Nan::GetCurrentContext(), n).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+    HashTarget share, block;
+    uint8_t* out;
+    const char* error = get_check_args(info, 1, share, block, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-	int retval = c29v_verify(edges,&keys);
+    capture_call(FAMILY_K12, 0, 0, nullptr, { info[0] });
+    uint8_t output[32];
+    KangarooTwelve((const unsigned char *)Buffer::Data(info[0]), Buffer::Length(info[0]), output, 32, 0, 0);
 
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+    info.GetReturnValue().Set(Nan::New<Number>(check_hash(output, false, share, block, out)));
 }
 
-NAN_METHOD(c29i) {
-	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
+// Hashes an array of equal length buffers in parallel SIMD lanes and returns the array of their blake2b hashes.
+NAN_METHOD(blake2b_multi) {
+    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+    if (!info[0]->IsArray()) return THROW_ERROR_EXCEPTION("Argument 1 should be an array of buffer objects.");
 
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
+    uint32_t outlen = BLAKE2B_OUTBYTES;
+    if (info.Length() >= 2 && !info[1]->IsUndefined()) {
+        if (!info[1]->IsUint32()) return THROW_ERROR_EXCEPTION("Argument 2 should be a hash length from 1 to 64.");
+        outlen = Nan::To<uint32_t>(info[1]).FromJust();
+        if (outlen == 0 || outlen > BLAKE2B_OUTBYTES) return THROW_ERROR_EXCEPTION("Argument 2 should be a hash length from 1 to 64.");
+    }
 
-	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
+    Local<Array> buffers = info[0].As<Array>();
+    const uint32_t count = buffers->Length();
+    std::vector<const void*> in(count);
+    std::vector<void*> out(count);
+    std::vector<uint8_t> hashes(static_cast<size_t>(count) * outlen);
+    size_t inlen = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Local<Value> buffer = Nan::Get(buffers, i).ToLocalChecked();
+        if (!Buffer::HasInstance(buffer)) return THROW_ERROR_EXCEPTION("Argument 1 should be an array of buffer objects.");
+        if (i == 0) inlen = Buffer::Length(buffer);
+        else if (Buffer::Length(buffer) != inlen) return THROW_ERROR_EXCEPTION("Argument 1 buffers should all have the same length.");
+        in[i]  = Buffer::Data(buffer);
+        out[i] = &hashes[static_cast<size_t>(i) * outlen];
+    }
 
-	Local<Array> ring = Local<Array>::Cast(info[1]);
+    rx_blake2b_multi(out.data(), outlen, in.data(), inlen, count);
 
-	uint32_t edges[PROOFSIZEi];
-	for (uint32_t n = 0; n < PROOFSIZEi; n++)
-		edges[n]=ring->Get(Nan::GetCurrentContext(), n).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+    Local<Array> result = Nan::New<Array>(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Nan::Set(result, i, Nan::CopyBuffer(reinterpret_cast<const char*>(out[i]), outlen).ToLocalChecked());
+    }
+    info.GetReturnValue().Set(result);
+}
+
+static void setsipkeys(const char *keybuf,siphash_keys *keys) {
+	keys->k0 = htole64(((uint64_t *)keybuf)[0]);
+	keys->k1 = htole64(((uint64_t *)keybuf)[1]);
+	keys->k2 = htole64(((uint64_t *)keybuf)[2]);
+	keys->k3 = htole64(((uint64_t *)keybuf)[3]);
+}
 
-	int retval = c29i_verify(edges,&keys);
+static void c29_setheader(const char *header, const uint32_t headerlen, siphash_keys *keys) {
+	char hdrkey[32];
+	rx_blake2b((void *)hdrkey, sizeof(hdrkey), (const void *)header, headerlen);
+	setsipkeys(hdrkey,keys);
+}
 
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+// Reads a c29 proof either from a Uint32Array (one copy) or from a plain array of numbers.
+static bool get_ring(const Local<Value>& arg, uint32_t* edges, const uint32_t proofsize) {
+	if (arg->IsUint32Array()) {
+		Local<Uint32Array> ring = arg.As<Uint32Array>();
+		if (ring->Length() < proofsize) return false;
+		ring->CopyContents(edges, proofsize * sizeof(uint32_t));
+		return true;
+	}
+	if (!arg->IsArray()) return false;
+	Local<Array> ring = arg.As<Array>();
+	if (ring->Length() < proofsize) return false;
+	Local<Context> context = Nan::GetCurrentContext();
+	for (uint32_t n = 0; n < proofsize; n++) {
+		Local<Value> edge;
+		if (!ring->Get(context, n).ToLocal(&edge) || !edge->Uint32Value(context).To(&edges[n])) return false;
+	}
+	return true;
 }
 
-NAN_METHOD(c29b) {
+template <int PROOF_SIZE, int (*verify)(uint32_t*, siphash_keys*)>
+static void c29_verify(const Nan::FunctionCallbackInfo<v8::Value>& info) {
 	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
+	if (!Buffer::HasInstance(info[0])) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
+	uint32_t edges[PROOF_SIZE];
+	if (!get_ring(info[1], edges, PROOF_SIZE)) return THROW_ERROR_EXCEPTION("Argument 2 should be an array or Uint32Array with the proof edges.");
 
 	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
-
-	Local<Array> ring = Local<Array>::Cast(info[1]);
+	c29_setheader(Buffer::Data(info[0]), Buffer::Length(info[0]), &keys);
 
-	uint32_t edges[PROOFSIZEb];
-	for (uint32_t n = 0; n < PROOFSIZEb; n++)
-		edges[n]=ring->Get(Nan::GetCurrentContext(), n).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
-
-	int retval = c29b_verify(edges,&keys);
-
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+	info.GetReturnValue().Set(Nan::New<Number>(verify(edges, &keys)));
 }
 
+NAN_METHOD(c29s) {
+	c29_verify<PROOFSIZE, c29s_verify>(info);
+}
 
-NAN_METHOD(c29_cycle_hash) {
-	if (info.Length() != 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
-
-	Local<Array> ring = Local<Array>::Cast(info[0]);
+NAN_METHOD(c29v) {
+	c29_verify<PROOFSIZE, c29v_verify>(info);
+}
 
-	uint8_t hashdata[116]; // PROOFSIZE*EDGEBITS/8
-	memset(hashdata, 0, 116);
+NAN_METHOD(c29i) {
+	c29_verify<PROOFSIZEi, c29i_verify>(info);
+}
 
-	int bytepos = 0;
-	int bitpos = 0;
-	for(int i = 0; i < PROOFSIZE; i++){
+NAN_METHOD(c29b) {
+	c29_verify<PROOFSIZEb, c29b_verify>(info);
+}
 
-		uint32_t node = ring->Get(Nan::GetCurrentContext(), i).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+// Packs the EDGEBITS wide edges little endian bit by bit and returns the byte reversed blake2b of that.
+template <int PROOF_SIZE>
+static void c29_cycle_hash_common(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+	if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
 
-		for(int j = 0; j < EDGEBITS; j++) {
+	uint32_t edges[PROOF_SIZE];
+	if (!get_ring(info[0], edges, PROOF_SIZE)) return THROW_ERROR_EXCEPTION("Argument 1 should be an array or Uint32Array with the proof edges.");
 
-			if((node >> j) & 1U)
-				hashdata[bytepos] |= 1UL << bitpos;
+	uint8_t* out;
+	const char* error = get_output_arg(info, 1, out);
+	if (error) return THROW_ERROR_EXCEPTION(error);
 
-			bitpos++;
-			if(bitpos==8) {
-				bitpos=0;bytepos++;
-			}
-		}
+	uint8_t hashdata[PROOF_SIZE * EDGEBITS / 8];
+	uint64_t bits = 0;
+	int nbits = 0, bytepos = 0;
+	for (int i = 0; i < PROOF_SIZE; i++) {
+		bits |= static_cast<uint64_t>(edges[i] & ((1U << EDGEBITS) - 1)) << nbits;
+		for (nbits += EDGEBITS; nbits >= 8; nbits -= 8, bits >>= 8) hashdata[bytepos++] = static_cast<uint8_t>(bits);
 	}
 
-	unsigned char cyclehash[32];
-	rx_blake2b((void *)cyclehash, sizeof(cyclehash), (uint8_t *)hashdata, sizeof(hashdata));
+	uint8_t cyclehash[32];
+	rx_blake2b(cyclehash, sizeof(cyclehash), hashdata, sizeof(hashdata));
 
-	unsigned char rev_cyclehash[32];
-	for(int i = 0; i < 32; i++)
-		rev_cyclehash[i] = cyclehash[31-i];
+	uint8_t rev_cyclehash[32];
+	for (int i = 0; i < 32; i++) rev_cyclehash[i] = cyclehash[31 - i];
 
-	v8::Local<v8::Value> returnValue = Nan::CopyBuffer((char*)rev_cyclehash, 32).ToLocalChecked();
-	info.GetReturnValue().Set(returnValue);
+	set_hash_result(info, 1, rev_cyclehash, out);
 }
 
-NAN_METHOD(c29b_cycle_hash) {
-	if (info.Length() != 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
-
-	Local<Array> ring = Local<Array>::Cast(info[0]);
+NAN_METHOD(c29_cycle_hash) {
+	c29_cycle_hash_common<PROOFSIZE>(info);
+}
 
-	uint8_t hashdata[145]; // PROOFSIZEb*EDGEBITS/8
-	memset(hashdata, 0, 145);
+NAN_METHOD(c29b_cycle_hash) {
+	c29_cycle_hash_common<PROOFSIZEb>(info);
+}
 
-	int bytepos = 0;
-	int bitpos = 0;
-	for(int i = 0; i < PROOFSIZEb; i++){
+NAN_METHOD(c29i_cycle_hash) {
+	c29_cycle_hash_common<PROOFSIZEi>(info);
+}
 
-		uint32_t node = ring->Get(Nan::GetCurrentContext(), i).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+NAN_METHOD(kawpow) {
+	if (info.Length() < 3) return THROW_ERROR_EXCEPTION("You must provide 3 argument buffers: header hash (32 bytes), nonce (8 bytes), mixhash (32 bytes)");
 
-		for(int j = 0; j < EDGEBITS; j++) {
+	if (!Buffer::HasInstance(info[0]) || Buffer::Length(info[0]) != 32) return THROW_ERROR_EXCEPTION("Argument 1 should be a 32 bytes long buffer object.");
+	if (!Buffer::HasInstance(info[1]) || Buffer::Length(info[1]) != 8) return THROW_ERROR_EXCEPTION("Argument 2 should be a 8 bytes long buffer object.");
+	if (!Buffer::HasInstance(info[2]) || Buffer::Length(info[2]) != 32) return THROW_ERROR_EXCEPTION("Argument 3 should be a 32 bytes long buffer object.");
 
-			if((node >> j) & 1U)
-				hashdata[bytepos] |= 1UL << bitpos;
+	uint8_t* out;
+	const char* error = get_output_arg(info, 3, out);
+	if (error) return THROW_ERROR_EXCEPTION(error);
 
-			bitpos++;
-			if(bitpos==8) {
-				bitpos=0;bytepos++;
-			}
-		}
-	}
-
-	unsigned char cyclehash[32];
-	rx_blake2b((void *)cyclehash, sizeof(cyclehash), (uint8_t *)hashdata, sizeof(hashdata));
+	capture_call(FAMILY_KAWPOW, 0, 0, nullptr, { info[0], info[1], info[2] });
+	uint32_t header_hash[8];
+	memcpy(header_hash, Buffer::Data(info[0]), sizeof(header_hash));
+	uint64_t nonce;
+	memcpy(&nonce, Buffer::Data(info[1]), sizeof(nonce));
+	uint32_t mix_hash[8];
+	memcpy(mix_hash, Buffer::Data(info[2]), sizeof(mix_hash));
 
-	unsigned char rev_cyclehash[32];
-	for(int i = 0; i < 32; i++)
-		rev_cyclehash[i] = cyclehash[31-i];
+	uint32_t output[8];
+	xmrig::KPHash::verify(header_hash, __builtin_bswap64(nonce), mix_hash, output);
 
-	v8::Local<v8::Value> returnValue = Nan::CopyBuffer((char*)rev_cyclehash, 32).ToLocalChecked();
-	info.GetReturnValue().Set(returnValue);
+	set_hash_result(info, 3, reinterpret_cast<const uint8_t*>(output), out);
 }
 
-NAN_METHOD(c29i_cycle_hash) {
-	if (info.Length() != 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
-
-	Local<Array> ring = Local<Array>::Cast(info[0]);
+NAN_METHOD(kawpow_check) {
+	if (info.Length() < 5) return THROW_ERROR_EXCEPTION("You must provide at least five arguments: header hash (32 bytes), nonce (8 bytes), mixhash (32 bytes), share target, block target.");
 
-	uint8_t hashdata[174]; // PROOFSIZEi*EDGEBITS/8
-	memset(hashdata, 0, 174);
+	if (!Buffer::HasInstance(info[0]) || Buffer::Length(info[0]) != 32) return THROW_ERROR_EXCEPTION("Argument 1 should be a 32 bytes long buffer object.");
+	if (!Buffer::HasInstance(info[1]) || Buffer::Length(info[1]) != 8) return THROW_ERROR_EXCEPTION("Argument 2 should be a 8 bytes long buffer object.");
+	if (!Buffer::HasInstance(info[2]) || Buffer::Length(info[2]) != 32) return THROW_ERROR_EXCEPTION("Argument 3 should be a 32 bytes long buffer object.");
 
-	int bytepos = 0;
-	int bitpos = 0;
-	for(int i = 0; i < PROOFSIZEi; i++){
+	HashTarget share, block;
+	uint8_t* out;
+	const char* error = get_check_args(info, 3, share, block, out);
+	if (error) return THROW_ERROR_EXCEPTION(error);
 
-		uint32_t node = ring->Get(Nan::GetCurrentContext(), i).ToLocalChecked()->Uint32Value(Nan::GetCurrentContext()).FromJust();
+	capture_call(FAMILY_KAWPOW, 0, 0, nullptr, { info[0], info[1], info[2] });
+	uint32_t header_hash[8];
+	memcpy(header_hash, Buffer::Data(info[0]), sizeof(header_hash));
+	const uint64_t nonce = __builtin_bswap64(*(reinterpret_cast<const uint64_t*>(Buffer::Data(info[1]))));
+	uint32_t mix_hash[8];
+	memcpy(mix_hash, Buffer::Data(info[2]), sizeof(mix_hash));
 
-		for(int j = 0; j < EDGEBITS; j++) {
+	uint32_t output[8];
+	xmrig::KPHash::verify(header_hash, nonce, mix_hash, output);
 
-			if((node >> j) & 1U)
-				hashdata[bytepos] |= 1UL << bitpos;
+	info.GetReturnValue().Set(Nan::New<Number>(check_hash(reinterpret_cast<const uint8_t*>(output), true, share, block, out)));
+}
 
-			bitpos++;
-			if(bitpos==8) {
-				bitpos=0;bytepos++;
-			}
-		}
+// Shared by ethash_check and etchash_check: the cheap keccak over the submitted mix hash rejects
+// shares above the share target before the light DAG computation is used to validate the mix hash.
+// The hash output buffer gets the hash only once the mix hash is validated, zeroes otherwise.
+static void ethash_check_common(const Nan::FunctionCallbackInfo<v8::Value>& info, ethash_light_t (*get_cache)(int)) {
+	if (info.Length() < 6) return THROW_ERROR_EXCEPTION("You must provide at least six arguments: header hash (32 bytes), nonce (8 bytes), height (integer), mixhash (32 bytes), share target, block target.");
+
+	if (!Buffer::HasInstance(info[0]) || Buffer::Length(info[0]) != 32) return THROW_ERROR_EXCEPTION("Argument 1 should be a 32 bytes long buffer object.");
+	if (!Buffer::HasInstance(info[1]) || Buffer::Length(info[1]) != 8) return THROW_ERROR_EXCEPTION("Argument 2 should be a 8 bytes long buffer object.");
+	if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
+	if (!Buffer::HasInstance(info[3]) || Buffer::Length(info[3]) != 32) return THROW_ERROR_EXCEPTION("Argument 4 should be a 32 bytes long buffer object.");
+
+	HashTarget share, block;
+	uint8_t* out;
+	const char* error = get_check_args(info, 4, share, block, out);
+	if (error) return THROW_ERROR_EXCEPTION(error);
+
+	const int height = Nan::To<int>(info[2]).FromMaybe(0);
+	ethash_h256_t header_hash, mix_hash, result;
+	memcpy(&header_hash, Buffer::Data(info[0]), sizeof(header_hash));
+	memcpy(&mix_hash, Buffer::Data(info[3]), sizeof(mix_hash));
+	const uint64_t nonce = __builtin_bswap64(*(reinterpret_cast<const uint64_t*>(Buffer::Data(info[1]))));
+
+	capture_call(get_cache == get_ethash_cache ? FAMILY_ETHASH : FAMILY_ETCHASH, 0, height, nullptr, { info[0], info[1] });
+	ethash_quick_hash(&result, &header_hash, nonce, &mix_hash);
+	uint32_t flags = check_hash(result.b, true, share, block, nullptr);
+
+	if (flags) {
+		const ethash_return_value_t res = ethash_light_compute(get_cache(height), header_hash, nonce);
+		if (memcmp(&res.mix_hash, &mix_hash, sizeof(mix_hash)) != 0) flags = 0;
+	}
+	if (out) {
+		if (flags) memcpy(out, result.b, 32);
+		else memset(out, 0, 32);
 	}
 
-	unsigned char cyclehash[32];
-	rx_blake2b((void *)cyclehash, sizeof(cyclehash), (uint8_t *)hashdata, sizeof(hashdata));
-
-	unsigned char rev_cyclehash[32];
-	for(int i = 0; i < 32; i++)
-		rev_cyclehash[i] = cyclehash[31-i];
-
-	v8::Local<v8::Value> returnValue = Nan::CopyBuffer((char*)rev_cyclehash, 32).ToLocalChecked();
-	info.GetReturnValue().Set(returnValue);
+	info.GetReturnValue().Set(Nan::New<Number>(flags));
 }
 
-NAN_METHOD(kawpow) {
-	if (info.Length() != 3) return THROW_ERROR_EXCEPTION("You must provide 3 argument buffers: header hash (32 bytes), nonce (8 bytes), mixhash (32 bytes)");
-
-	v8::Isolate *isolate = v8::Isolate::GetCurrent();
-
-	Local<Object> header_hash_buff = info[0]->ToObject(isolate->GetCurrentContext()).ToLocalChecked();
-	if (!Buffer::HasInstance(header_hash_buff)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
-	if (Buffer::Length(header_hash_buff) != 32) return THROW_ERROR_EXCEPTION("Argument 1 should be a 32 bytes long buffer object.");
-
-	Local<Object> nonce_buff = info[1]->ToObject(isolate->GetCurrentContext()).ToLocalChecked();
-	if (!Buffer::HasInstance(nonce_buff)) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
-	if (Buffer::Length(nonce_buff) != 8) return THROW_ERROR_EXCEPTION("Argument 2 should be a 8 bytes long buffer object.");
-
-	Local<Object> mix_hash_buff = info[2]->ToObject(isolate->GetCurrentContext()).ToLocalChecked();
-	if (!Buffer::HasInstance(mix_hash_buff)) return THROW_ERROR_EXCEPTION("Argument 3 should be a buffer object.");
-	if (Buffer::Length(mix_hash_buff) != 32) return THROW_ERROR_EXCEPTION("Argument 3 should be a 8 bytes long buffer object.");
-
-	uint32_t header_hash[8];
-	memcpy(header_hash, reinterpret_cast<const uint8_t*>(Buffer::Data(header_hash_buff)), sizeof(header_hash));
-        const uint64_t nonce = __builtin_bswap64(*(reinterpret_cast<const uint64_t*>(Buffer::Data(nonce_buff))));
-        uint32_t mix_hash[8];
-	memcpy(mix_hash, reinterpret_cast<const uint8_t*>(Buffer::Data(mix_hash_buff)), sizeof(mix_hash));
-
-        uint32_t output[8];
-	xmrig::KPHash::verify(header_hash, nonce, mix_hash, output);
+NAN_METHOD(ethash_check) {
+	ethash_check_common(info, get_ethash_cache);
+}
 
-	v8::Local<v8::Value> returnValue = Nan::CopyBuffer((char*)output, 32).ToLocalChecked();
-	info.GetReturnValue().Set(returnValue);
+NAN_METHOD(etchash_check) {
+	ethash_check_common(info, get_etchash_cache);
 }
 
 NAN_METHOD(ethash) {
@@ -765,19 +879,12 @@ NAN_METHOD(ethash) {
         if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
         const int height = Nan::To<int>(info[2]).FromMaybe(0);
 
+	capture_call(FAMILY_ETHASH, 0, height, nullptr, { header_hash_buff, nonce_buff });
 	ethash_h256_t header_hash;
 	memcpy(&header_hash, reinterpret_cast<const uint8_t*>(Buffer::Data(header_hash_buff)), sizeof(header_hash));
         const uint64_t nonce = __builtin_bswap64(*(reinterpret_cast<const uint64_t*>(Buffer::Data(nonce_buff))));
 
-        static int prev_epoch = 0;
-        static ethash_light_t cache = nullptr;
-        const int epoch = height / ETHASH_EPOCH_LENGTH;
-        if (prev_epoch != epoch) {
-            if (cache) ethash_light_delete(cache);
-            cache = ethash_light_new(height, epoch, epoch);
-            prev_epoch = epoch;
-        }
-        ethash_return_value_t res = ethash_light_compute(cache, header_hash, nonce);
+        ethash_return_value_t res = ethash_light_compute(get_ethash_cache(height), header_hash, nonce);
 
         v8::Local<v8::Array> returnValue = New<v8::Array>(2);
         Nan::Set(returnValue, 0, Nan::CopyBuffer((char*)&res.result.b[0], 32).ToLocalChecked());
@@ -801,21 +908,12 @@ NAN_METHOD(etchash) {
         if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
         const int height = Nan::To<int>(info[2]).FromMaybe(0);
 
+	capture_call(FAMILY_ETCHASH, 0, height, nullptr, { header_hash_buff, nonce_buff });
 	ethash_h256_t header_hash;
 	memcpy(&header_hash, reinterpret_cast<const uint8_t*>(Buffer::Data(header_hash_buff)), sizeof(header_hash));
         const uint64_t nonce = __builtin_bswap64(*(reinterpret_cast<const uint64_t*>(Buffer::Data(nonce_buff))));
 
-        static int prev_epoch_seed = 0;
-        static ethash_light_t cache = nullptr;
-        const int epoch_length = height >= ETCHASH_EPOCH_HEIGHT ? ETCHASH_EPOCH_LENGTH : ETHASH_EPOCH_LENGTH;
-        const int epoch       = height / epoch_length;
-        const int epoch_seed  = (epoch * epoch_length + 1) / ETHASH_EPOCH_LENGTH;
-        if (prev_epoch_seed != epoch_seed) {
-            if (cache) ethash_light_delete(cache);
-            cache = ethash_light_new(height, epoch_seed, epoch);
-            prev_epoch_seed = epoch_seed;
-        }
-        ethash_return_value_t res = ethash_light_compute(cache, header_hash, nonce);
+        ethash_return_value_t res = ethash_light_compute(get_etchash_cache(height), header_hash, nonce);
 
         v8::Local<v8::Array> returnValue = New<v8::Array>(2);
         Nan::Set(returnValue, 0, Nan::CopyBuffer((char*)&res.result.b[0], 32).ToLocalChecked());
@@ -863,9 +961,9 @@ NAN_METHOD(equihash) {
 
   // Hash Input Data and Check if Valid Solution
   bool isValid;
-  crypto_generichash_blake2b_state state;
+  eh_HashState state;
   EhInitialiseState(N, K, state, personalizationString);
-  crypto_generichash_blake2b_update(&state, (const unsigned char*)hdr, 140);
+  rx_blake2b_update(&state, (const unsigned char*)hdr, 140);
   EhIsValidSolution(N, K, state, vecSolution, isValid);
   info.GetReturnValue().Set(isValid);
 }
@@ -928,25 +1026,655 @@ NAN_METHOD(validateMinerSubmission) {
     // 计算哈希和难度
     auto [hash, difficulty] = sha3x_difficulty_with_hash(nonce_to_le_bytes(nonce), mining_hash, pow_bytes);
 
-    // 验证哈希值是否匹配
-    std::stringstream ss;
-    for (uint8_t b : hash) {
-        ss << std::hex << std::setfill('0') << std::setw(2) << (int)b;
+    // 验证哈希值是否匹配（直接格式化为小写十六进制，避免 stringstream）
+    static const char hex_digits[] = "0123456789abcdef";
+    char actual_hash_hex[64];
+    for (size_t i = 0; i < 32; ++i) {
+        actual_hash_hex[i * 2]     = hex_digits[hash[i] >> 4];
+        actual_hash_hex[i * 2 + 1] = hex_digits[hash[i] & 0xF];
     }
-    std::string actual_hash_hex = ss.str();
 
-    bool hash_valid = (actual_hash_hex == hex_result);
+    bool hash_valid = hex_result.size() == sizeof(actual_hash_hex) && memcmp(actual_hash_hex, hex_result.data(), sizeof(actual_hash_hex)) == 0;
     bool difficulty_valid = (difficulty <= target_difficulty);
 
     // 返回布尔结果
     info.GetReturnValue().Set(Nan::New(hash_valid && difficulty_valid));
 }
+// Host tuning: the kernel options below can be switched at runtime, tune() measures them on this
+// CPU and keeps the fastest. They are process wide, so tune before the workers start hashing.
+struct TuneProfile {
+    int rx_prefetch        = 0;
+    bool rx_huge_pages_jit = false;
+    std::string argon2;
+    int cn_asm             = xmrig::Assembly::NONE;
+};
+
+static const char TUNE_PROFILE_VERSION[] = "1";
+static const char* const cn_asm_names[xmrig::Assembly::MAX] = { "none", "auto", "intel", "ryzen", "bulldozer" };
+
+static TuneProfile current_tuning() {
+    TuneProfile profile;
+    profile.rx_prefetch       = randomx_get_scratchpad_prefetch_mode();
+    profile.rx_huge_pages_jit = randomx_get_huge_pages_jit();
+    profile.argon2            = argon2_get_impl_name();
+    profile.cn_asm            = cn_assembly.load();
+    return profile;
+}
+
+// Changes nothing unless the whole profile is usable here
+static bool apply_tuning(const TuneProfile& profile) {
+    if (profile.rx_prefetch < 0 || profile.rx_prefetch > 3) return false;
+    if (profile.cn_asm < 0 || profile.cn_asm >= xmrig::Assembly::MAX || profile.cn_asm == xmrig::Assembly::AUTO) return false;
+    if (!argon2_select_impl_by_name(profile.argon2.c_str())) return false;
+
+    randomx_set_scratchpad_prefetch_mode(profile.rx_prefetch);
+    if (randomx_get_huge_pages_jit() != profile.rx_huge_pages_jit) {
+        randomx_set_huge_pages_jit(profile.rx_huge_pages_jit);
+        reset_rx_vms();
+    }
+    cn_assembly = profile.cn_asm;
+    return true;
+}
+
+// Profiles are "key value" lines, only valid for the CPU they were measured on
+static bool load_tuning(const std::string& path, TuneProfile& profile) {
+    std::ifstream file(path);
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t space = line.find(' ');
+        if (space != std::string::npos) values[line.substr(0, space)] = line.substr(space + 1);
+    }
+
+    if (values["version"] != TUNE_PROFILE_VERSION || values["cpu"] != xmrig::Cpu::info()->brand()) return false;
+    if (values["rx_prefetch"].size() != 1 || values["rx_huge_pages_jit"].size() != 1 || values["argon2"].empty()) return false;
+
+    profile.rx_prefetch       = values["rx_prefetch"][0] - '0';
+    profile.rx_huge_pages_jit = values["rx_huge_pages_jit"] == "1";
+    profile.argon2            = values["argon2"];
+    profile.cn_asm            = -1;
+    for (int i = 0; i < xmrig::Assembly::MAX; ++i) {
+        if (values["cn_asm"] == cn_asm_names[i]) profile.cn_asm = i;
+    }
+    return true;
+}
+
+static bool save_tuning(const std::string& path, const TuneProfile& profile) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        file << "version " << TUNE_PROFILE_VERSION << "\n"
+             << "cpu " << xmrig::Cpu::info()->brand() << "\n"
+             << "rx_prefetch " << profile.rx_prefetch << "\n"
+             << "rx_huge_pages_jit " << (profile.rx_huge_pages_jit ? 1 : 0) << "\n"
+             << "argon2 " << profile.argon2 << "\n"
+             << "cn_asm " << cn_asm_names[profile.cn_asm] << "\n";
+        if (!file.flush()) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// Best of several rounds per candidate, interleaved so clock changes hit all of them alike. The
+// first candidate is the current setting, the others have to beat it by 2% to replace it.
+template <typename S, typename R>
+static int tune_pick(const int count, S select, R run) {
+    std::vector<std::chrono::steady_clock::duration> best(count, std::chrono::steady_clock::duration::max());
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < count; ++i) {
+            select(i);
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            best[i] = std::min(best[i], std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    int winner = 0;
+    for (int i = 1; i < count; ++i) {
+        if (best[i].count() * 100 < best[winner].count() * 98) winner = i;
+    }
+    select(winner);
+    return winner;
+}
+
+static void tune_rx() {
+    static const uint8_t seed[32] = {};
+    uint8_t blob[76] = {}, hash[32];
+    auto run = [&blob, &hash]() {
+        for (uint8_t nonce = 0; nonce < 4; ++nonce) {
+            blob[39] = nonce;
+            rx_calculate_hash(seed, xmrig::Algorithm::RX_0, blob, sizeof(blob), hash);
+        }
+    };
+    // Also initialises the cache and the VM before anything is measured
+    auto warm_up = [&blob, &hash]() { rx_calculate_hash(seed, xmrig::Algorithm::RX_0, blob, sizeof(blob), hash); };
+
+    int modes[] = { 0, 1, 2, 3 };
+    std::swap(modes[0], modes[randomx_get_scratchpad_prefetch_mode() & 3]);
+    tune_pick(4, [&modes, &warm_up](const int i) { randomx_set_scratchpad_prefetch_mode(modes[i]); warm_up(); }, run);
+
+    const bool huge_pages[] = { randomx_get_huge_pages_jit(), !randomx_get_huge_pages_jit() };
+    tune_pick(2, [&huge_pages, &warm_up](const int i) {
+        if (randomx_get_huge_pages_jit() != huge_pages[i]) {
+            randomx_set_huge_pages_jit(huge_pages[i]);
+            reset_rx_vms();
+        }
+        warm_up();
+    }, run);
+}
+
+// Only variants which produce the reference hash of the portable code are candidates
+static void tune_cn_asm() {
+    const xmrig::cn_hash_fun reference = xmrig::CnHash::fn(xmrig::Algorithm::CN_HALF, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE);
+    uint8_t blob[76] = {}, expected[32], hash[32];
+    cryptonight_ctx** ctx = isolate_state->cn_ctx(xmrig::Algorithm::l3(xmrig::Algorithm::CN_HALF));
+    reference(blob, sizeof(blob), expected, ctx, 0);
+
+    std::vector<int> variants(1, cn_assembly.load());
+    std::vector<xmrig::cn_hash_fun> fns(1, FNA(CN_HALF));
+    const int all[] = { xmrig::Assembly::NONE, xmrig::Assembly::INTEL, xmrig::Assembly::RYZEN, xmrig::Assembly::BULLDOZER };
+    for (const int variant : all) {
+        const xmrig::cn_hash_fun fn = xmrig::CnHash::fn(xmrig::Algorithm::CN_HALF, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, static_cast<xmrig::Assembly::Id>(variant));
+        if (std::find(fns.begin(), fns.end(), fn) != fns.end()) continue;
+        fn(blob, sizeof(blob), hash, ctx, 0);
+        if (memcmp(hash, expected, sizeof(hash)) != 0) continue;
+        variants.push_back(variant);
+        fns.push_back(fn);
+    }
+
+    xmrig::cn_hash_fun fn = fns[0];
+    tune_pick(static_cast<int>(variants.size()), [&variants, &fns, &fn](const int i) { cn_assembly = variants[i]; fn = fns[i]; }, [&blob, &hash, &fn, ctx]() {
+        for (uint8_t nonce = 0; nonce < 4; ++nonce) {
+            blob[39] = nonce;
+            fn(blob, sizeof(blob), hash, ctx, 0);
+        }
+    });
+}
+
+// tune([profile path[, force]]): applies the profile if it was written on this CPU, otherwise (or
+// when forced) benchmarks RandomX prefetch modes and huge pages JIT, the Argon2 fill_segment
+// implementations and the CN asm variants, applies the winners and writes them to the profile.
+NAN_METHOD(tune) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && !info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+    if (info.Length() >= 2 && !info[1]->IsUndefined() && !info[1]->IsBoolean()) return THROW_ERROR_EXCEPTION("Argument 2 should be a boolean.");
+
+    const std::string path = info.Length() >= 1 && info[0]->IsString() ? std::string(*Nan::Utf8String(info[0])) : std::string();
+    const bool force       = info.Length() >= 2 && Nan::To<bool>(info[1]).FromMaybe(false);
+
+    TuneProfile profile;
+    bool loaded = false;
+    if (!path.empty() && !force && load_tuning(path, profile)) {
+        loaded = apply_tuning(profile);
+    }
+
+    if (!loaded) {
+        try {
+            tune_rx();
+        } catch (const std::exception& e) {
+            return THROW_ERROR_EXCEPTION(e.what());
+        }
+        argon2_select_impl();
+        tune_cn_asm();
+
+        profile = current_tuning();
+        if (!path.empty() && !save_tuning(path, profile)) return THROW_ERROR_EXCEPTION("Can't write the tuning profile.");
+    }
+
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, Nan::New("loaded").ToLocalChecked(), Nan::New(loaded));
+    Nan::Set(result, Nan::New("randomx_prefetch").ToLocalChecked(), Nan::New(profile.rx_prefetch));
+    Nan::Set(result, Nan::New("randomx_huge_pages_jit").ToLocalChecked(), Nan::New(profile.rx_huge_pages_jit));
+    Nan::Set(result, Nan::New("argon2").ToLocalChecked(), Nan::New(profile.argon2).ToLocalChecked());
+    Nan::Set(result, Nan::New("cn_asm").ToLocalChecked(), Nan::New(cn_asm_names[profile.cn_asm]).ToLocalChecked());
+    info.GetReturnValue().Set(result);
+}
+
+// numa_nodes(): the CPUs of every NUMA node, indexed by node number
+NAN_METHOD(numa_nodes) {
+    const std::vector<std::vector<int>>& topology = numa_topology();
+    Local<Array> result = Nan::New<Array>(topology.size());
+    for (size_t node = 0; node < topology.size(); ++node) {
+        Local<Array> cpus = Nan::New<Array>(topology[node].size());
+        for (size_t i = 0; i < topology[node].size(); ++i) Nan::Set(cpus, i, Nan::New(topology[node][i]));
+        Nan::Set(result, node, cpus);
+    }
+    info.GetReturnValue().Set(result);
+}
+
+// numa_pin(node): runs the calling isolate on the CPUs of the node from now on and moves its scratch
+// memory there. Its next RandomX hashes use VMs and a cache replica of that node.
+NAN_METHOD(numa_pin) {
+    if (info.Length() < 1 || !info[0]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 1 should be a number");
+
+    const int node = Nan::To<int>(info[0]).FromMaybe(-1);
+    if (node < 0 || static_cast<uint32_t>(node) >= numa_node_count() || numa_topology()[node].empty()) {
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a NUMA node with CPUs");
+    }
+    if (!numa_pin_thread(node)) return THROW_ERROR_EXCEPTION("Can't pin the thread to the NUMA node");
+
+    IsolateState* state = isolate_state;
+    if (state->ctx_memory) numa_bind_memory(state->ctx_memory, state->ctx_size, node);
+    if (state->rx_mem) numa_bind_memory(state->rx_mem->raw(), state->rx_mem->size(), node);
+    if (state->yespower_mem) numa_bind_memory(state->yespower_mem->raw(), state->yespower_mem->size(), node);
+
+    // VMs go back to the pool of their old node, caches are picked again with the next hash
+    reset_rx_vms();
+    for (int i = 0; i < MAXRX; ++i) state->rx_cache[i].reset();
+}
+
+// HashFamily of a family name of the JS API, -1 for unknown ones
+static int get_family(const std::string& name) {
+    static const char* const names[] = { "cryptonight", "cryptonight_light", "cryptonight_heavy", "cryptonight_pico", "argon2", "astrobwt", "k12", "randomx", "ethash", "etchash", "kawpow" };
+    for (int i = 0; i < static_cast<int>(sizeof(names) / sizeof(names[0])); ++i) {
+        if (name == names[i]) return i;
+    }
+    return -1;
+}
+
+// Background job of a JS call that returns a Promise. The async context of the call is created
+// here on the calling thread, settling the promise enters it, so AsyncLocalStorage and async_hooks
+// see the reactions as part of that call.
+class PromiseWorker : public Nan::AsyncWorker {
+public:
+    explicit PromiseWorker(const char* name) : Nan::AsyncWorker(nullptr, name), m_isolate(v8::Isolate::GetCurrent()) {
+        Local<Object> resource = Nan::New<Object>();
+        m_resource.Reset(m_isolate, resource);
+        m_context = node::EmitAsyncInit(m_isolate, resource, name);
+        SaveToPersistent("resolver", v8::Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked());
+    }
+
+    ~PromiseWorker() {
+        node::EmitAsyncDestroy(m_isolate, m_context);
+        m_resource.Reset();
+    }
+
+    Local<v8::Promise> promise() {
+        return resolver()->GetPromise();
+    }
+
+protected:
+    // Back on the JS thread after Execute() succeeded: what the promise resolves to
+    virtual Local<Value> Result() = 0;
+
+    void HandleOKCallback() override {
+        Nan::HandleScope scope;
+        node::CallbackScope callback_scope(m_isolate, m_resource.Get(m_isolate), m_context);  // runs the then() callbacks
+        resolver()->Resolve(Nan::GetCurrentContext(), Result()).FromJust();
+    }
+
+    void HandleErrorCallback() override {
+        Nan::HandleScope scope;
+        node::CallbackScope callback_scope(m_isolate, m_resource.Get(m_isolate), m_context);
+        resolver()->Reject(Nan::GetCurrentContext(), Nan::Error(ErrorMessage())).FromJust();
+    }
+
+private:
+    Local<v8::Promise::Resolver> resolver() {
+        return GetFromPersistent("resolver").As<v8::Promise::Resolver>();
+    }
+
+    v8::Isolate* m_isolate;
+    v8::Global<Object> m_resource;
+    node::async_context m_context;
+};
+
+class ScanWorker : public PromiseWorker {
+public:
+    ScanWorker(const ScanJob& job, unsigned threads, IsolateState* target) : PromiseWorker("cryptonight-hashing:scan"), m_job(job), m_threads(threads), m_target(target) {}
+
+    void Execute() override {
+        try {
+            m_results = scan_nonces(m_job, m_threads, m_state);
+        } catch (const std::exception& e) {
+            SetErrorMessage(e.what());
+        }
+    }
+
+protected:
+    Local<Value> Result() override {
+        m_target->adopt(m_state);  // the RandomX cache and VM of the scan stay with the caller
+        Local<Array> array = Nan::New<Array>(m_results.size());
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            Local<Object> result = Nan::New<Object>();
+            Nan::Set(result, Nan::New("nonce").ToLocalChecked(), Nan::New<Number>(m_results[i].nonce));
+            Nan::Set(result, Nan::New("hash").ToLocalChecked(), Nan::CopyBuffer(reinterpret_cast<const char*>(m_results[i].hash), 32).ToLocalChecked());
+            Nan::Set(array, i, result);
+        }
+        return array;
+    }
+
+private:
+    const ScanJob m_job;
+    const unsigned m_threads;
+    IsolateState* m_target;
+    IsolateState m_state;
+    std::vector<ScanResult> m_results;
+};
+
+// scan(family, blob, nonce offset, start nonce, count, target[, threads[, options]]): hashes the
+// blob with every 32-bit nonce of [start nonce, start nonce + count) at the offset, on the given
+// number of threads (all CPUs by default). Options are the algo number of the family ("algo"),
+// the block height ("height") and the RandomX seed hash ("seed_hash"). Returns a Promise of the
+// nonces whose hash meets the target, in order, as { nonce, hash } objects; the threads run off
+// the event loop and the RandomX cache of the scan is kept by the calling isolate.
+NAN_METHOD(scan) {
+    if (info.Length() < 6) return THROW_ERROR_EXCEPTION("You must provide at least six arguments: family, blob, nonce offset, start nonce, count, target.");
+
+    if (!info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+    if (!Buffer::HasInstance(info[1])) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+    for (int i = 2; i < 5; ++i) {
+        if (!info[i]->IsNumber() || Nan::To<double>(info[i]).FromMaybe(-1) < 0) return THROW_ERROR_EXCEPTION(("Argument " + std::to_string(i + 1) + " should be a non-negative number").c_str());
+    }
+    HashTarget target;
+    if (!get_target(info[5], target)) return THROW_ERROR_EXCEPTION("Target should be a number, a BigInt or a 32 bytes long buffer object.");
+    if (info.Length() >= 7 && !info[6]->IsUndefined() && (!info[6]->IsNumber() || Nan::To<int>(info[6]).FromMaybe(0) < 1)) return THROW_ERROR_EXCEPTION("Argument 7 should be a positive number");
+    if (info.Length() >= 8 && !info[7]->IsUndefined() && !info[7]->IsObject()) return THROW_ERROR_EXCEPTION("Argument 8 should be an object");
+
+    ScanJob job;
+    job.family = get_family(*Nan::Utf8String(info[0]));
+    if (job.family < 0 || job.family > FAMILY_RANDOMX) return THROW_ERROR_EXCEPTION("Argument 1 should be cryptonight, cryptonight_light, cryptonight_heavy, cryptonight_pico, argon2, astrobwt, k12 or randomx.");
+    job.blob.assign(Buffer::Data(info[1]), Buffer::Length(info[1]));
+    job.nonce_offset = static_cast<size_t>(Nan::To<double>(info[2]).FromMaybe(0));
+    job.start_nonce  = static_cast<uint32_t>(std::min(Nan::To<double>(info[3]).FromMaybe(0), 4294967295.0));
+    job.count        = static_cast<uint64_t>(std::min(Nan::To<double>(info[4]).FromMaybe(0), 4294967296.0));
+    // More threads than CPUs would only compete for them
+    const unsigned cpus    = std::max(1U, std::thread::hardware_concurrency());
+    const unsigned threads = info.Length() >= 7 && info[6]->IsNumber() ? std::min(Nan::To<uint32_t>(info[6]).FromMaybe(1), cpus) : cpus;
+    bool seed_set = false;
+
+    if (info.Length() >= 8 && info[7]->IsObject()) {
+        Local<Object> options = info[7].As<Object>();
+        Local<Value> algo   = Nan::Get(options, Nan::New("algo").ToLocalChecked()).ToLocalChecked();
+        Local<Value> height = Nan::Get(options, Nan::New("height").ToLocalChecked()).ToLocalChecked();
+        Local<Value> seed   = Nan::Get(options, Nan::New("seed_hash").ToLocalChecked()).ToLocalChecked();
+        if (!algo->IsUndefined() && !algo->IsNumber()) return THROW_ERROR_EXCEPTION("Option algo should be a number");
+        if (!height->IsUndefined() && !height->IsNumber()) return THROW_ERROR_EXCEPTION("Option height should be a number");
+        if (!seed->IsUndefined() && (!Buffer::HasInstance(seed) || Buffer::Length(seed) != sizeof(job.seed_hash))) return THROW_ERROR_EXCEPTION("Option seed_hash should be a 32 bytes long buffer object.");
+        if (algo->IsNumber()) job.algo = Nan::To<int>(algo).FromMaybe(0);
+        if (height->IsNumber()) job.height = Nan::To<uint32_t>(height).FromMaybe(0);
+        if (!seed->IsUndefined()) {
+            memcpy(job.seed_hash, Buffer::Data(seed), sizeof(job.seed_hash));
+            seed_set = true;
+        }
+    }
+    if (job.family == FAMILY_RANDOMX && !seed_set) return THROW_ERROR_EXCEPTION("RandomX scans require the seed_hash option");
+
+    job.accept = [target](const uint8_t* hash) { return meets_target(hash, target, false); };
+
+    try {
+        scan_check(job);
+    } catch (const std::exception& e) {
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
+
+    ScanWorker* worker = new ScanWorker(job, threads, isolate_state);
+    info.GetReturnValue().Set(worker->promise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+// trim([idle ms]): releases the scratch memory and caches the calling isolate has not used for the
+// given time, everything with no argument. Returns the bytes released; caches shared with other
+// isolates only count (and are only freed) when the last of them lets go.
+NAN_METHOD(trim) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && (!info[0]->IsNumber() || Nan::To<double>(info[0]).FromMaybe(-1) < 0)) {
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a non-negative number");
+    }
+
+    const uint64_t idle_ms = info.Length() >= 1 && info[0]->IsNumber() ? static_cast<uint64_t>(Nan::To<double>(info[0]).FromMaybe(0)) : 0;
+    info.GetReturnValue().Set(Nan::New<Number>(static_cast<double>(isolate_state->trim(idle_ms))));
+}
+
+// release(family[, algo]): releases what the calling isolate holds for "cryptonight" (every
+// CryptoNight style family shares one context), "randomx" (one variant with the algo number,
+// otherwise all), "ethash" or "etchash". Returns the bytes released like trim().
+NAN_METHOD(release) {
+    if (info.Length() < 1 || !info[0]->IsString()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string.");
+    if (info.Length() >= 2 && !info[1]->IsUndefined() && !info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
+
+    const std::string family = *Nan::Utf8String(info[0]);
+    IsolateState* state = isolate_state;
+    size_t released = 0;
+    if (family == "cryptonight") {
+        released = state->release_cn();
+    } else if (family == "randomx") {
+        if (info.Length() >= 2 && info[1]->IsNumber()) {
+            released = state->release_rx(rx2id(get_rx_algo(Nan::To<int>(info[1]).FromMaybe(0))));
+        } else {
+            for (int i = 0; i < MAXRX; ++i) released += state->release_rx(i);
+        }
+    } else if (family == "ethash") {
+        released = state->release_ethash();
+    } else if (family == "etchash") {
+        released = state->release_etchash();
+    } else {
+        return THROW_ERROR_EXCEPTION("Argument 1 should be cryptonight, randomx, ethash or etchash.");
+    }
+    info.GetReturnValue().Set(Nan::New<Number>(static_cast<double>(released)));
+}
+
+// idle_timeout([ms]): from now on every isolate releases what it has not used for ms milliseconds
+// when it hashes next, no argument or 0 turns it off. Returns the previous timeout.
+NAN_METHOD(idle_timeout) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && (!info[0]->IsNumber() || Nan::To<double>(info[0]).FromMaybe(-1) < 0)) {
+        return THROW_ERROR_EXCEPTION("Argument 1 should be a non-negative number");
+    }
+
+    const uint64_t previous = get_idle_timeout();
+    set_idle_timeout(info.Length() >= 1 && info[0]->IsNumber() ? static_cast<uint64_t>(Nan::To<double>(info[0]).FromMaybe(0)) : 0);
+    info.GetReturnValue().Set(Nan::New<Number>(static_cast<double>(previous)));
+}
+
+// randomx_jit([enabled]): whether RandomX VMs created from now on use the JIT compiler rather than
+// the bytecode interpreter, release("randomx") switches the VMs of an isolate. Returns the previous setting.
+NAN_METHOD(randomx_jit) {
+    if (info.Length() >= 1 && !info[0]->IsUndefined() && !info[0]->IsBoolean()) return THROW_ERROR_EXCEPTION("Argument 1 should be a boolean.");
+
+    const bool previous = get_rx_jit();
+    if (info.Length() >= 1 && info[0]->IsBoolean()) set_rx_jit(Nan::To<bool>(info[0]).FromMaybe(true));
+    info.GetReturnValue().Set(Nan::New(previous));
+}
+
+class WarmupWorker : public PromiseWorker {
+public:
+    WarmupWorker(const WarmupJob& job, IsolateState* target) : PromiseWorker("cryptonight-hashing:warmup"), m_job(job), m_target(target) {}
+
+    void Execute() override {
+        try {
+            m_state = warmup_state(m_job);
+        } catch (const std::exception& e) {
+            SetErrorMessage(e.what());
+        }
+    }
+
+protected:
+    Local<Value> Result() override {
+        m_target->adopt(*m_state);
+        return Nan::Undefined();
+    }
+
+private:
+    const WarmupJob m_job;
+    IsolateState* m_target;
+    std::unique_ptr<IsolateState> m_state;
+};
+
+// warmup({ algos, seeds, heights }): prepares the first hashes of the algos on background threads
+// and returns a Promise resolved once the calling isolate has it all. Algos are family names or
+// { family, algo } objects, seeds the RandomX seed hashes and heights the block heights of the
+// ethash epochs and CryptoNight R programs; the last seed and height are the ones hashed first,
+// caches of the others are kept for later (the next seed, say) until trim() or release().
+NAN_METHOD(warmup) {
+    if (info.Length() < 1 || !info[0]->IsObject()) return THROW_ERROR_EXCEPTION("Argument 1 should be an object");
+
+    Local<Object> options = info[0].As<Object>();
+    Local<Value> algos   = Nan::Get(options, Nan::New("algos").ToLocalChecked()).ToLocalChecked();
+    Local<Value> seeds   = Nan::Get(options, Nan::New("seeds").ToLocalChecked()).ToLocalChecked();
+    Local<Value> heights = Nan::Get(options, Nan::New("heights").ToLocalChecked()).ToLocalChecked();
+    if (!algos->IsArray()) return THROW_ERROR_EXCEPTION("Option algos should be an array");
+    if (!seeds->IsUndefined() && !seeds->IsArray()) return THROW_ERROR_EXCEPTION("Option seeds should be an array");
+    if (!heights->IsUndefined() && !heights->IsArray()) return THROW_ERROR_EXCEPTION("Option heights should be an array");
+
+    WarmupJob job;
+    Local<Array> list = algos.As<Array>();
+    for (uint32_t i = 0; i < list->Length(); ++i) {
+        Local<Value> item = Nan::Get(list, i).ToLocalChecked();
+        Local<Value> family = item;
+        Local<Value> algo   = Nan::Undefined();
+        if (item->IsObject()) {
+            family = Nan::Get(item.As<Object>(), Nan::New("family").ToLocalChecked()).ToLocalChecked();
+            algo   = Nan::Get(item.As<Object>(), Nan::New("algo").ToLocalChecked()).ToLocalChecked();
+        }
+        if (!family->IsString()) return THROW_ERROR_EXCEPTION("Algos should be family names or { family, algo } objects");
+        if (!algo->IsUndefined() && !algo->IsNumber()) return THROW_ERROR_EXCEPTION("Algo numbers should be numbers");
+        WarmupAlgo warm;
+        warm.family = get_family(*Nan::Utf8String(family));
+        if (warm.family < 0) return THROW_ERROR_EXCEPTION(("Unknown hash family " + std::string(*Nan::Utf8String(family))).c_str());
+        warm.algo = algo->IsNumber() ? Nan::To<int>(algo).FromMaybe(0) : 0;
+        job.algos.push_back(warm);
+    }
+    if (seeds->IsArray()) {
+        list = seeds.As<Array>();
+        for (uint32_t i = 0; i < list->Length(); ++i) {
+            Local<Value> seed = Nan::Get(list, i).ToLocalChecked();
+            if (!Buffer::HasInstance(seed) || Buffer::Length(seed) != 32) return THROW_ERROR_EXCEPTION("Seeds should be 32 bytes long buffer objects.");
+            job.seeds.emplace_back();
+            memcpy(job.seeds.back().data(), Buffer::Data(seed), 32);
+        }
+    }
+    if (heights->IsArray()) {
+        list = heights.As<Array>();
+        for (uint32_t i = 0; i < list->Length(); ++i) {
+            Local<Value> height = Nan::Get(list, i).ToLocalChecked();
+            if (!height->IsNumber() || Nan::To<double>(height).FromMaybe(-1) < 0) return THROW_ERROR_EXCEPTION("Heights should be non-negative numbers");
+            job.heights.push_back(static_cast<uint64_t>(Nan::To<double>(height).FromMaybe(0)));
+        }
+    }
+
+    WarmupWorker* worker = new WarmupWorker(job, isolate_state);
+    info.GetReturnValue().Set(worker->promise());
+    Nan::AsyncQueueWorker(worker);
+}
+
+// Native side of a ring: the workers wake the isolate's event loop through the async handle,
+// which calls the completion callback once for all the completions added since
+struct RingHandle {
+    uv_async_t async;
+    v8::Isolate* isolate;
+    Nan::Callback callback;
+    std::unique_ptr<Nan::AsyncResource> resource;
+    std::shared_ptr<v8::BackingStore> memory;  // keeps the SharedArrayBuffer alive while workers use it
+    std::unique_ptr<HashRing> ring;
+    v8::Global<Object> self;
+};
+
+static void ring_completed(uv_async_t* async) {
+    RingHandle* handle = static_cast<RingHandle*>(async->data);
+    if (!handle->ring) return;
+    Nan::HandleScope scope;
+    handle->callback.Call(0, nullptr, handle->resource.get());
+}
+
+// Stops the workers and lets go of the memory, what is left is freed once the ring object is collected
+static void close_ring(void* arg) {
+    RingHandle* handle = static_cast<RingHandle*>(arg);
+    if (!handle->ring) return;
+    handle->ring.reset();
+    node::RemoveEnvironmentCleanupHook(handle->isolate, close_ring, handle);
+    handle->memory.reset();
+    handle->callback.Reset();
+    uv_close(reinterpret_cast<uv_handle_t*>(&handle->async), [](uv_handle_t* async) {
+        RingHandle* closed = static_cast<RingHandle*>(async->data);
+        if (closed->self.IsEmpty()) delete closed;
+        else async->data = nullptr;
+    });
+}
+
+static RingHandle* ring_handle(const Nan::FunctionCallbackInfo<v8::Value>& info) {
+    return static_cast<RingHandle*>(info.Data().As<Object>()->GetAlignedPointerFromInternalField(0));
+}
+
+NAN_METHOD(ring_notify) {
+    RingHandle* handle = ring_handle(info);
+    if (handle->ring) handle->ring->notify();
+}
+
+NAN_METHOD(ring_close) {
+    close_ring(ring_handle(info));
+}
+
+// ring(shared array buffer, entries, threads, callback): starts native workers which hash the
+// submissions JavaScript writes into the buffer and write the results into its completion ring
+// (layout in ring.h, ring.js wraps it). Returns { notify(), close() }: notify() wakes the workers
+// after new submissions or once completions were read, the callback runs when there are new ones.
+NAN_METHOD(ring) {
+    if (info.Length() < 4) return THROW_ERROR_EXCEPTION("You must provide four arguments: shared array buffer, entries, threads, callback.");
+    if (!info[0]->IsSharedArrayBuffer()) return THROW_ERROR_EXCEPTION("Argument 1 should be a SharedArrayBuffer");
+    if (!info[1]->IsUint32()) return THROW_ERROR_EXCEPTION("Argument 2 should be a power of two");
+    if (!info[2]->IsUint32() || Nan::To<uint32_t>(info[2]).FromMaybe(0) < 1) return THROW_ERROR_EXCEPTION("Argument 3 should be a positive number");
+    if (!info[3]->IsFunction()) return THROW_ERROR_EXCEPTION("Argument 4 should be a function");
+
+    std::unique_ptr<RingHandle> handle(new RingHandle());
+    handle->isolate = v8::Isolate::GetCurrent();
+    handle->memory  = info[0].As<v8::SharedArrayBuffer>()->GetBackingStore();
+    handle->callback.Reset(info[3].As<v8::Function>());
+    handle->resource.reset(new Nan::AsyncResource("cryptonight-hashing:ring"));
+    handle->async.data = handle.get();
+    uv_async_init(node::GetCurrentEventLoop(handle->isolate), &handle->async, ring_completed);
+
+    // Workers beyond the CPUs would only compete for them
+    const unsigned threads = std::min(Nan::To<uint32_t>(info[2]).FromMaybe(1), std::max(1U, std::thread::hardware_concurrency()));
+    uv_async_t* async = &handle->async;
+    try {
+        handle->ring.reset(new HashRing(static_cast<uint8_t*>(handle->memory->Data()), handle->memory->ByteLength(), Nan::To<uint32_t>(info[1]).FromMaybe(0), threads, [async]() { uv_async_send(async); }));
+    } catch (const std::exception& e) {
+        uv_close(reinterpret_cast<uv_handle_t*>(async), [](uv_handle_t* closed) { delete static_cast<RingHandle*>(closed->data); });
+        handle.release();
+        return THROW_ERROR_EXCEPTION(e.what());
+    }
+
+    RingHandle* ring = handle.release();
+    node::AddEnvironmentCleanupHook(ring->isolate, close_ring, ring);
+    // Its functions keep the object alive, the handle goes with it once the ring is closed
+    Local<v8::ObjectTemplate> object = v8::ObjectTemplate::New(ring->isolate);
+    object->SetInternalFieldCount(1);
+    Local<Object> result = object->NewInstance(Nan::GetCurrentContext()).ToLocalChecked();
+    result->SetAlignedPointerInInternalField(0, ring);
+    Nan::Set(result, Nan::New("notify").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(ring_notify, result)).ToLocalChecked());
+    Nan::Set(result, Nan::New("close").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(ring_close, result)).ToLocalChecked());
+
+    ring->self.Reset(ring->isolate, result);
+    ring->self.SetWeak(ring, [](const v8::WeakCallbackInfo<RingHandle>& data) {
+        RingHandle* collected = data.GetParameter();
+        collected->self.Reset();
+        if (!collected->ring && !collected->async.data) delete collected;
+    }, v8::WeakCallbackType::kParameter);
+    info.GetReturnValue().Set(result);
+}
+
+// Process wide defaults, set once so workers loading the addon later keep what tune() chose
+static std::once_flag defaults_once;
+
 NAN_MODULE_INIT(init) {
+    std::call_once(defaults_once, []() {
+        argon2_select_impl_by_features();
+        randomx_set_scratchpad_prefetch_mode(0);
+        randomx_set_huge_pages_jit(false);
+        //randomx_set_optimized_dataset_init(0);
+    });
+
+    if (!isolate_state) {
+        isolate_state = new IsolateState();
+        node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), release_isolate_state, isolate_state);
+    }
+
     Nan::Set(target, Nan::New("cryptonight").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight)).ToLocalChecked());
     Nan::Set(target, Nan::New("cryptonight_light").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_light)).ToLocalChecked());
     Nan::Set(target, Nan::New("cryptonight_heavy").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_heavy)).ToLocalChecked());
     Nan::Set(target, Nan::New("cryptonight_pico").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_pico)).ToLocalChecked());
     Nan::Set(target, Nan::New("randomx").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_cache_timing").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_cache_timing)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_jit").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_jit)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_cache_dir").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_cache_dir)).ToLocalChecked());
+    Nan::Set(target, Nan::New("shared_caches").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(shared_caches)).ToLocalChecked());
     Nan::Set(target, Nan::New("argon2").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(argon2)).ToLocalChecked());
     Nan::Set(target, Nan::New("astrobwt").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(astrobwt)).ToLocalChecked());
     Nan::Set(target, Nan::New("k12").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(k12)).ToLocalChecked());
@@ -961,8 +1689,30 @@ NAN_MODULE_INIT(init) {
     Nan::Set(target, Nan::New("ethash").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(ethash)).ToLocalChecked());
     Nan::Set(target, Nan::New("etchash").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(etchash)).ToLocalChecked());
     Nan::Set(target, Nan::New("equihash").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(equihash)).ToLocalChecked());
+    Nan::Set(target, Nan::New("tune").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(tune)).ToLocalChecked());
+    Nan::Set(target, Nan::New("numa_nodes").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(numa_nodes)).ToLocalChecked());
+    Nan::Set(target, Nan::New("numa_pin").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(numa_pin)).ToLocalChecked());
+    Nan::Set(target, Nan::New("scan").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(scan)).ToLocalChecked());
+    Nan::Set(target, Nan::New("trim").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(trim)).ToLocalChecked());
+    Nan::Set(target, Nan::New("release").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(release)).ToLocalChecked());
+    Nan::Set(target, Nan::New("idle_timeout").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(idle_timeout)).ToLocalChecked());
+    Nan::Set(target, Nan::New("warmup").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(warmup)).ToLocalChecked());
+    Nan::Set(target, Nan::New("capture").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(capture)).ToLocalChecked());
+    Nan::Set(target, Nan::New("ring").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(ring)).ToLocalChecked());
     Nan::Set(target, Nan::New("validateMinerSubmission").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(validateMinerSubmission)).ToLocalChecked());
 
+    Nan::Set(target, Nan::New("cryptonight_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("argon2_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(argon2_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("astrobwt_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(astrobwt_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("k12_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(k12_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("blake2b_multi").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(blake2b_multi)).ToLocalChecked());
+    Nan::Set(target, Nan::New("kawpow_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(kawpow_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("ethash_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(ethash_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("etchash_check").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(etchash_check)).ToLocalChecked());
+    Nan::Set(target, Nan::New("CHECK_SHARE").ToLocalChecked(), Nan::New<Number>(CHECK_SHARE));
+    Nan::Set(target, Nan::New("CHECK_BLOCK").ToLocalChecked(), Nan::New<Number>(CHECK_BLOCK));
+
 }
 
-NODE_MODULE(cryptonight, init)
+NAN_MODULE_WORKER_ENABLED(cryptonight, init)
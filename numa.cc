@@ -0,0 +1,190 @@
+#include "numa.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+
+#ifdef __linux__
+// From linux/mempolicy.h, which is not always installed
+static const int NUMA_MPOL_PREFERRED = 1;
+static const unsigned NUMA_MPOL_MF_MOVE = 1 << 1;
+
+// Parses a sysfs CPU list such as "0-3,8,10-11"
+static std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    const char* p = list.c_str();
+    while (*p >= '0' && *p <= '9') {
+        char* end;
+        const long first = strtol(p, &end, 10);
+        long last = first;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+        for (long cpu = first; cpu <= last; ++cpu) cpus.push_back(static_cast<int>(cpu));
+        p = *end == ',' ? end + 1 : end;
+    }
+    return cpus;
+}
+#endif
+
+static std::vector<std::vector<int>> read_topology() {
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    if (DIR* dir = opendir("/sys/devices/system/node")) {
+        while (const dirent* entry = readdir(dir)) {
+            char* end;
+            if (strncmp(entry->d_name, "node", 4) != 0) continue;
+            const unsigned long node = strtoul(entry->d_name + 4, &end, 10);
+            if (end == entry->d_name + 4 || *end || node >= 1024) continue;
+
+            std::ifstream file(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist");
+            std::string list;
+            std::getline(file, list);
+            if (nodes.size() <= node) nodes.resize(node + 1);
+            nodes[node] = parse_cpu_list(list);
+        }
+        closedir(dir);
+    }
+#endif
+    if (nodes.empty()) nodes.resize(1);
+    return nodes;
+}
+
+const std::vector<std::vector<int>>& numa_topology() {
+    static const std::vector<std::vector<int>> topology = read_topology();
+    return topology;
+}
+
+uint32_t numa_node_count() {
+    return static_cast<uint32_t>(numa_topology().size());
+}
+
+uint32_t numa_current_node() {
+#ifdef __linux__
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return node;
+#endif
+    return 0;
+}
+
+bool pin_thread_cpus(const std::vector<int>& cpus) {
+    if (cpus.empty()) return false;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool numa_pin_thread(const uint32_t node) {
+    if (node >= numa_node_count()) return false;
+    return pin_thread_cpus(numa_topology()[node]);
+}
+
+#ifdef __linux__
+static std::string read_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+// Sizes such as "32768K"
+static size_t parse_size(const std::string& text) {
+    char* end;
+    size_t size = strtoull(text.c_str(), &end, 10);
+    if (*end == 'K') size <<= 10;
+    else if (*end == 'M') size <<= 20;
+    return size;
+}
+#endif
+
+static std::vector<CacheDomain> read_cache_domains() {
+    std::vector<CacheDomain> domains;
+#ifdef __linux__
+    // The unified cache of the highest level each online CPU has, keyed by the CPUs sharing it
+    std::map<std::string, CacheDomain> shared;
+    std::map<std::string, std::vector<int>> cores;
+    for (const int cpu : parse_cpu_list(read_line("/sys/devices/system/cpu/online"))) {
+        const std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        int level = 0;
+        std::string cpus, size;
+        for (int index = 0;; ++index) {
+            const std::string cache = dir + "/cache/index" + std::to_string(index);
+            const std::string cache_level = read_line(cache + "/level");
+            if (cache_level.empty()) break;
+            if (read_line(cache + "/type") == "Instruction" || atoi(cache_level.c_str()) <= level) continue;
+            level = atoi(cache_level.c_str());
+            cpus  = read_line(cache + "/shared_cpu_list");
+            size  = read_line(cache + "/size");
+        }
+        if (cpus.empty()) return std::vector<CacheDomain>();
+
+        CacheDomain& domain = shared[cpus];
+        if (domain.cpus.empty()) {
+            domain.cpus = parse_cpu_list(cpus);
+            domain.size = parse_size(size);
+        }
+        std::string siblings = read_line(dir + "/topology/thread_siblings_list");
+        if (siblings.empty()) siblings = std::to_string(cpu);
+        if (cores.emplace(siblings, parse_cpu_list(siblings)).second) domain.cores.push_back(cores[siblings]);
+    }
+    for (auto& entry : shared) domains.push_back(std::move(entry.second));
+#endif
+    return domains;
+}
+
+const std::vector<CacheDomain>& cache_domains() {
+    static const std::vector<CacheDomain> domains = []() {
+        std::vector<CacheDomain> domains = read_cache_domains();
+        if (domains.empty()) {
+            for (const std::vector<int>& cpus : numa_topology()) {
+                if (cpus.empty()) continue;
+                domains.emplace_back();
+                domains.back().cpus = cpus;
+                for (const int cpu : cpus) domains.back().cores.push_back(std::vector<int>(1, cpu));
+            }
+            if (domains.empty()) domains.emplace_back();
+        }
+        std::sort(domains.begin(), domains.end(), [](const CacheDomain& a, const CacheDomain& b) { return a.cpus < b.cpus; });
+        for (CacheDomain& domain : domains) {
+            for (uint32_t node = 0; node < numa_node_count() && !domain.cpus.empty(); ++node) {
+                const std::vector<int>& cpus = numa_topology()[node];
+                if (std::find(cpus.begin(), cpus.end(), domain.cpus[0]) != cpus.end()) domain.node = node;
+            }
+        }
+        return domains;
+    }();
+    return domains;
+}
+
+bool numa_bind_memory(void* memory, const size_t size, const uint32_t node) {
+    if (!memory || !size || node >= numa_node_count() || numa_node_count() < 2) return false;
+#ifdef __linux__
+    // mbind works on whole pages
+    const uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(memory) & ~(page - 1);
+    const uintptr_t end   = reinterpret_cast<uintptr_t>(memory) + size;
+
+    const size_t bits = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(numa_node_count() / bits + 1, 0);
+    mask[node / bits] |= 1UL << (node % bits);
+
+    // The kernel reads maxnode - 1 bits of the mask
+    return syscall(SYS_mbind, start, end - start, NUMA_MPOL_PREFERRED, mask.data(), mask.size() * bits + 1, NUMA_MPOL_MF_MOVE) == 0;
+#else
+    return false;
+#endif
+}
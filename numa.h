@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// NUMA topology read from sysfs, and placement of threads and memory on nodes. Without kernel
+// NUMA support, or off Linux, there is a single node 0 with no CPU list and nothing is moved.
+
+// CPUs of every node, indexed by node number, nodes without CPUs have an empty list
+const std::vector<std::vector<int>>& numa_topology();
+
+// Number of nodes, at least 1
+uint32_t numa_node_count();
+
+// Node of the CPU the calling thread runs on
+uint32_t numa_current_node();
+
+// Restricts the calling thread to the CPUs of the node
+bool numa_pin_thread(uint32_t node);
+
+// Makes the node the preferred one for the pages of the range and migrates the pages already there
+bool numa_bind_memory(void* memory, size_t size, uint32_t node);
+
+// CPUs sharing a last level cache (L3, or L2 where that is the last level)
+struct CacheDomain {
+    std::vector<int> cpus;
+    std::vector<std::vector<int>> cores;  // SMT siblings of each core, by their first CPU
+    size_t size   = 0;                    // bytes, 0 when unknown
+    uint32_t node = 0;                    // NUMA node of the first CPU
+};
+
+// Cache domains by their first CPU. Without cache information in sysfs every node with CPUs is a
+// domain of unknown size, and there is a single one with no CPU list where nodes are unknown too.
+const std::vector<CacheDomain>& cache_domains();
+
+// Restricts the calling thread to the CPUs
+bool pin_thread_cpus(const std::vector<int>& cpus);
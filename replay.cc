@@ -0,0 +1,185 @@
+// Replays a share stream capture (capture.h) for performance regression tests against real
+// traffic: the requests of the addon or daemon are hashed again on a pool of threads.
+//
+// At the original speed a request is not hashed before the time it arrived at, counted from the
+// first one, and its latency counts from then, so it includes waiting for a free thread. At max
+// speed the threads hash the requests back to back and the latency is the hash alone. Printed
+// per family and algo: requests, failures, hashes per second over the replay, latency percentiles.
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "capture.h"
+#include "hashing.h"
+#include "crypto/kawpow/KPHash.h"
+#include "3rdparty/argon2.h"
+extern "C" {
+#include "crypto/randomx/panthera/KangarooTwelve.h"
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* const FAMILY_NAMES[FAMILY_COUNT] = {
+    "cryptonight", "cryptonight_light", "cryptonight_heavy", "cryptonight_pico", "argon2", "astrobwt",
+    "k12", "randomx", "ethash", "etchash", "kawpow"
+};
+
+struct Result {
+    double latency = 0;  // milliseconds
+    bool ok = false;
+};
+
+static bool replay_hash(const CaptureRecord& record) {
+    const uint8_t* payload = record.payload.data();
+    const size_t size = record.payload.size();
+    uint8_t output[32];
+    switch (record.family) {
+        case FAMILY_K12:     KangarooTwelve(payload, size, output, 32, 0, 0); return true;
+        case FAMILY_RANDOMX: rx_calculate_hash(record.seed_hash, get_rx_algo(record.algo), payload, size, output); return true;
+        case FAMILY_ETHASH:
+        case FAMILY_ETCHASH: {
+            if (size != 40) return false;
+            ethash_h256_t header_hash;
+            memcpy(&header_hash, payload, sizeof(header_hash));
+            uint64_t nonce;
+            memcpy(&nonce, payload + 32, sizeof(nonce));
+            const int height = static_cast<int>(record.height);
+            ethash_light_compute(record.family == FAMILY_ETHASH ? get_ethash_cache(height) : get_etchash_cache(height), header_hash, __builtin_bswap64(nonce));
+            return true;
+        }
+        case FAMILY_KAWPOW: {
+            if (size != 72) return false;
+            uint32_t header_hash[8], mix_hash[8], hash[8];
+            uint64_t nonce;
+            memcpy(header_hash, payload, sizeof(header_hash));
+            memcpy(&nonce, payload + 32, sizeof(nonce));
+            memcpy(mix_hash, payload + 40, sizeof(mix_hash));
+            xmrig::KPHash::verify(header_hash, __builtin_bswap64(nonce), mix_hash, hash);
+            return true;
+        }
+        default: {
+            const CnHashFn fn = get_family_fn(record.family, record.algo);
+            if (!fn.fn) return false;
+            fn(payload, size, output, record.height);
+            return true;
+        }
+    }
+}
+
+static void replay_main(const std::vector<CaptureRecord>* records, std::vector<Result>* results, std::atomic<size_t>* next, const Clock::time_point start, const bool original_speed) {
+    IsolateState state;
+    isolate_state = &state;
+
+    for (size_t i; (i = next->fetch_add(1)) < records->size();) {
+        const CaptureRecord& record = (*records)[i];
+        Clock::time_point begin = Clock::now();
+        if (original_speed) {
+            const Clock::time_point arrival = start + std::chrono::microseconds(record.time);
+            std::this_thread::sleep_until(arrival);
+            begin = arrival;
+        }
+        try {
+            (*results)[i].ok = replay_hash(record);
+        } catch (const std::exception&) {}
+        (*results)[i].latency = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    }
+
+    isolate_state = nullptr;
+}
+
+// Nearest rank percentile of sorted latencies
+static double percentile(const std::vector<double>& sorted, const double p) {
+    const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static void usage(const char* name) {
+    fprintf(stderr, "Usage: %s --log <path> [--threads <n>] [--speed original|max]\n", name);
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    unsigned threads = std::thread::hardware_concurrency();
+    bool original_speed = true;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--log") path = value;
+        else if (arg == "--threads") threads = static_cast<unsigned>(atoi(value.c_str()));
+        else if (arg == "--speed" && (value == "original" || value == "max")) original_speed = value == "original";
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1) threads = 1;
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Can't open %s: %s\n", path.c_str(), strerror(errno));
+        return 1;
+    }
+    if (!capture_read_header(file)) {
+        fprintf(stderr, "%s is not a capture file\n", path.c_str());
+        fclose(file);
+        return 1;
+    }
+    std::vector<CaptureRecord> records;
+    CaptureRecord record;
+    while (capture_read(file, record)) records.push_back(record);
+    fclose(file);
+
+    argon2_select_impl_by_features();
+    randomx_set_scratchpad_prefetch_mode(0);
+    randomx_set_huge_pages_jit(false);
+
+    std::vector<Result> results(records.size());
+    std::atomic<size_t> next(0);
+    const Clock::time_point start = Clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; ++i) workers.emplace_back(replay_main, &records, &results, &next, start, original_speed);
+    for (std::thread& worker : workers) worker.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::map<std::pair<uint8_t, uint8_t>, std::vector<double>> latencies;
+    std::map<std::pair<uint8_t, uint8_t>, size_t> failures;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const std::pair<uint8_t, uint8_t> key(records[i].family, records[i].algo);
+        latencies[key].push_back(results[i].latency);
+        if (!results[i].ok) ++failures[key];
+    }
+
+    printf("%u requests in %.3f s on %u threads at %s speed\n", static_cast<unsigned>(records.size()), seconds, threads, original_speed ? "original" : "max");
+    printf("%-18s %4s %9s %7s %10s %9s %9s %9s %9s\n", "family", "algo", "requests", "failed", "H/s", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    for (auto& entry : latencies) {
+        std::vector<double>& sorted = entry.second;
+        std::sort(sorted.begin(), sorted.end());
+        const uint8_t family = entry.first.first;
+        printf("%-18s %4u %9u %7u %10.2f %9.3f %9.3f %9.3f %9.3f\n",
+               family < FAMILY_COUNT ? FAMILY_NAMES[family] : "unknown", entry.first.second,
+               static_cast<unsigned>(sorted.size()), static_cast<unsigned>(failures[entry.first]), sorted.size() / seconds,
+               percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99), sorted.back());
+    }
+    return 0;
+}
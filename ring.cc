@@ -0,0 +1,195 @@
+#include "ring.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include "capture.h"
+#include "hashing.h"
+extern "C" {
+#include "crypto/randomx/panthera/KangarooTwelve.h"
+}
+
+// Submissions a worker takes at once, and completions it adds at once
+static const uint32_t RING_BATCH = 16;
+
+struct HashRing::Request {
+    uint32_t user_data;
+    uint8_t family;
+    uint8_t algo;
+    uint64_t height;
+    uint32_t size;
+    bool valid;
+    uint8_t seed_hash[32];
+    uint8_t boundary[32];
+    uint8_t blob[RING_MAX_BLOB];
+    uint8_t status;
+    uint8_t hash[32];
+};
+
+static inline uint32_t* ring_index(uint8_t* memory, const size_t offset) {
+    return reinterpret_cast<uint32_t*>(memory + offset);
+}
+
+static inline uint32_t load_index(uint8_t* memory, const size_t offset) {
+    return __atomic_load_n(ring_index(memory, offset), __ATOMIC_ACQUIRE);
+}
+
+static inline bool in_memory(const uint32_t offset, const uint32_t size, const size_t memory_size) {
+    return static_cast<uint64_t>(offset) + size <= memory_size;
+}
+
+HashRing::HashRing(uint8_t* memory, const size_t size, const uint32_t entries, const unsigned threads, std::function<void()> completed)
+    : m_memory(memory), m_size(size), m_entries(entries), m_completed(std::move(completed))
+{
+    if (!entries || (entries & (entries - 1))) throw std::domain_error("Ring entries should be a power of two");
+    if (RING_HEADER_SIZE + static_cast<uint64_t>(entries) * (RING_SUBMISSION_SIZE + RING_COMPLETION_SIZE) > size) throw std::domain_error("Ring memory is too small for the entries");
+    try {
+        for (unsigned i = 0; i < std::max(1U, threads); ++i) m_threads.emplace_back(&HashRing::worker, this);
+    } catch (const std::system_error& e) {
+        // No destructor runs for a ring that failed to construct, the started workers go here
+        stop();
+        throw std::domain_error(std::string("Can't start ring worker: ") + e.what());
+    }
+}
+
+HashRing::~HashRing() {
+    stop();
+}
+
+void HashRing::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+    m_cond.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+void HashRing::notify() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_sleeping) m_cond.notify_all();
+}
+
+bool HashRing::submissions() const {
+    return load_index(m_memory, RING_SUBMISSION_TAIL) != load_index(m_memory, RING_SUBMISSION_HEAD);
+}
+
+bool HashRing::completion_space(const size_t count) const {
+    return load_index(m_memory, RING_COMPLETION_TAIL) - load_index(m_memory, RING_COMPLETION_HEAD) + count <= m_entries;
+}
+
+// Copies the next submissions, then claims them: JavaScript may reuse their slots and bytes right after
+size_t HashRing::take(std::vector<Request>& requests) {
+    uint32_t head = load_index(m_memory, RING_SUBMISSION_HEAD);
+    for (;;) {
+        const uint32_t count = std::min(load_index(m_memory, RING_SUBMISSION_TAIL) - head, RING_BATCH);
+        if (!count) return 0;
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint8_t* entry = m_memory + RING_HEADER_SIZE + static_cast<size_t>((head + i) & (m_entries - 1)) * RING_SUBMISSION_SIZE;
+            Request& request = requests[i];
+            uint32_t blob_offset, seed_offset;
+            memcpy(&request.user_data, entry, 4);
+            request.family = entry[4];
+            request.algo   = entry[5];
+            memcpy(&blob_offset, entry + 8, 4);
+            memcpy(&request.size, entry + 12, 4);
+            memcpy(&request.height, entry + 16, 8);
+            memcpy(&seed_offset, entry + 24, 4);
+            memcpy(request.boundary, entry + 32, 32);
+
+            request.valid = request.size <= RING_MAX_BLOB && in_memory(blob_offset, request.size, m_size);
+            if (request.valid) memcpy(request.blob, m_memory + blob_offset, request.size);
+            if (request.family == FAMILY_RANDOMX) {
+                request.valid = request.valid && in_memory(seed_offset, 32, m_size);
+                if (request.valid) memcpy(request.seed_hash, m_memory + seed_offset, 32);
+            }
+        }
+
+        if (__atomic_compare_exchange_n(ring_index(m_memory, RING_SUBMISSION_HEAD), &head, head + count, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return count;
+        // Another worker took them first, head is its new value now
+    }
+}
+
+static bool hash_request(const uint8_t family, const uint8_t algo, const uint8_t* blob, const uint32_t size, const uint64_t height, const uint8_t* seed_hash, uint8_t* hash) {
+    switch (family) {
+        case FAMILY_K12:     KangarooTwelve(blob, size, hash, 32, 0, 0); return true;
+        case FAMILY_RANDOMX: rx_calculate_hash(seed_hash, get_rx_algo(algo), blob, size, hash); return true;
+        default: {
+            const CnHashFn fn = get_family_fn(family, algo);
+            if (!fn.fn) return false;
+            fn(blob, size, hash, height);
+            return true;
+        }
+    }
+}
+
+static bool meets_boundary(const uint8_t* hash, const uint8_t* boundary) {
+    for (int i = 31; i >= 0; --i) {
+        if (hash[i] != boundary[i]) return hash[i] < boundary[i];
+    }
+    return true;
+}
+
+void HashRing::complete(const std::vector<Request>& requests, const size_t count) {
+    {
+        // One writer at a time, waiting until JavaScript made room
+        std::lock_guard<std::mutex> writer(m_completion_mutex);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            ++m_sleeping;
+            m_cond.wait(lock, [this, count]() { return m_stopped || completion_space(count); });
+            --m_sleeping;
+            if (m_stopped) return;
+        }
+
+        const uint32_t tail = load_index(m_memory, RING_COMPLETION_TAIL);
+        uint8_t* completions = m_memory + RING_HEADER_SIZE + static_cast<size_t>(m_entries) * RING_SUBMISSION_SIZE;
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t* entry = completions + static_cast<size_t>((tail + i) & (m_entries - 1)) * RING_COMPLETION_SIZE;
+            memcpy(entry, &requests[i].user_data, 4);
+            entry[4] = requests[i].status;
+            entry[5] = entry[6] = entry[7] = 0;
+            memcpy(entry + 8, requests[i].hash, 32);
+        }
+        __atomic_store_n(ring_index(m_memory, RING_COMPLETION_TAIL), tail + static_cast<uint32_t>(count), __ATOMIC_RELEASE);
+    }
+    m_completed();
+}
+
+void HashRing::worker() {
+    IsolateState state;
+    isolate_state = &state;
+
+    std::vector<Request> requests(RING_BATCH);
+    for (;;) {
+        const size_t count = take(requests);
+        if (!count) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stopped) break;
+            ++m_sleeping;
+            m_cond.wait(lock, [this]() { return m_stopped || submissions(); });
+            --m_sleeping;
+            continue;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            Request& request = requests[i];
+            request.status = RING_ERROR;
+            memset(request.hash, 0, sizeof(request.hash));
+            if (!request.valid) continue;
+            if (capturing()) capture_hash(request.family, request.algo, request.blob, request.size, request.height, request.seed_hash);
+            try {
+                if (hash_request(request.family, request.algo, request.blob, request.size, request.height, request.seed_hash, request.hash)) {
+                    request.status = meets_boundary(request.hash, request.boundary) ? RING_MEETS_TARGET : RING_ABOVE_TARGET;
+                }
+            } catch (const std::exception&) {}
+        }
+        complete(requests, count);
+    }
+
+    isolate_state = nullptr;
+}
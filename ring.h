@@ -0,0 +1,75 @@
+#pragma once
+
+// Submission and completion rings in memory shared with JavaScript (a SharedArrayBuffer), so
+// hashing small requests needs no per-request object or allocation on either side. All fields are
+// little endian, the four ring indexes are u32 counters on cache lines of their own which only
+// ever grow (wrapping at 2^32), the entry of counter i is at i % entries:
+//
+//   0       u32 submission head    (native workers, entries taken)
+//   64      u32 submission tail    (JavaScript, entries written)
+//   128     u32 completion head    (JavaScript, entries read)
+//   192     u32 completion tail    (native workers, entries written)
+//   256     submissions, entries x 64 bytes:
+//             u32 user data, u8 family, u8 algo, u16 reserved, u32 blob offset, u32 blob size,
+//             u64 height, u32 seed hash offset (RandomX), u32 reserved, u8[32] boundary
+//   ...     completions, entries x 40 bytes:
+//             u32 user data, u8 status, u8[3] reserved, u8[32] hash
+//   ...     free for the blobs and seed hashes the offsets point to
+//
+// Blob and seed hash are copied when a worker takes the entry, so their bytes can be reused as
+// soon as the submission head passed it. Status is 1 when the hash is at most the 32 byte little
+// endian boundary, 0 when it is above and 2 for a bad entry or a failed hash.
+
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+const size_t RING_SUBMISSION_HEAD = 0;
+const size_t RING_SUBMISSION_TAIL = 64;
+const size_t RING_COMPLETION_HEAD = 128;
+const size_t RING_COMPLETION_TAIL = 192;
+const size_t RING_HEADER_SIZE     = 256;
+const size_t RING_SUBMISSION_SIZE = 64;
+const size_t RING_COMPLETION_SIZE = 40;
+const size_t RING_MAX_BLOB        = 256;
+
+const uint8_t RING_ABOVE_TARGET = 0;
+const uint8_t RING_MEETS_TARGET = 1;
+const uint8_t RING_ERROR        = 2;
+
+class HashRing {
+public:
+    // entries is a power of two, memory holds at least the header and both rings.
+    // completed is called from the workers each time they added completions.
+    HashRing(uint8_t* memory, size_t size, uint32_t entries, unsigned threads, std::function<void()> completed);
+    ~HashRing();
+
+    // Wakes the workers after new submissions or once completions were read
+    void notify();
+
+private:
+    struct Request;
+
+    void worker();
+    void stop();
+    size_t take(std::vector<Request>& requests);
+    void complete(const std::vector<Request>& requests, size_t count);
+    bool submissions() const;
+    bool completion_space(size_t count) const;
+
+    uint8_t* const m_memory;
+    const size_t m_size;
+    const uint32_t m_entries;
+    const std::function<void()> m_completed;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    unsigned m_sleeping = 0;
+    uint64_t m_notified = 0;
+    bool m_stopped      = false;
+    std::mutex m_completion_mutex;
+    std::vector<std::thread> m_threads;
+};
@@ -0,0 +1,109 @@
+"use strict";
+// Submission and completion rings shared with native hash workers (layout in ring.h): requests are
+// written into a SharedArrayBuffer and answered in it, nothing is allocated per request.
+//
+//   const ring = new HashRing({ entries: 4096, threads: 8 }, (user_data, status, hash_offset) => ...);
+//   ring.set_seed(0, seed_hash);
+//   ring.submit(id, FAMILY.randomx, 0, blob, 0, 0, boundary);  // false while the ring is full
+//   ring.flush();                                             // wakes the workers
+//
+// Status is 1 when the hash is at most the 32 byte little endian boundary, 0 when it is above and 2
+// for a bad request. The hash is ring.bytes[hash_offset .. hash_offset + 32], valid during the call.
+
+const os           = require('os');
+const multiHashing = require('bindings')('cryptonight-hashing.node');
+const FAMILY       = require('./client').FAMILY;
+
+const SUBMISSION_HEAD = 0;   // Uint32Array indexes of the counters
+const SUBMISSION_TAIL = 16;
+const COMPLETION_HEAD = 32;
+const COMPLETION_TAIL = 48;
+const HEADER_SIZE     = 256;
+const SUBMISSION_SIZE = 64;
+const COMPLETION_SIZE = 40;
+const MAX_BLOB        = 256;
+
+const STATUS = {
+	above_target: 0,
+	meets_target: 1,
+	error:        2,
+};
+
+class HashRing {
+	// options: entries (a power of two), threads, seeds (RandomX seed hash slots)
+	constructor(options, on_complete) {
+		options = options || {};
+		this.entries     = options.entries || 4096;
+		this.seed_slots  = options.seeds || 16;
+		this.on_complete = on_complete;
+
+		this.submissions = HEADER_SIZE;
+		this.completions = this.submissions + this.entries * SUBMISSION_SIZE;
+		this.blobs       = this.completions + this.entries * COMPLETION_SIZE;
+		this.seeds       = this.blobs + this.entries * MAX_BLOB;
+
+		this.buffer = new SharedArrayBuffer(this.seeds + this.seed_slots * 32);
+		this.index  = new Uint32Array(this.buffer, 0, HEADER_SIZE / 4);
+		this.bytes  = Buffer.from(this.buffer);
+		this.view   = new DataView(this.buffer);
+		this.native = multiHashing.ring(this.buffer, this.entries, options.threads || os.cpus().length, () => this._complete());
+	}
+
+	set_seed(slot, seed_hash) {
+		if (slot >= this.seed_slots || seed_hash.length !== 32) throw new Error('Bad seed hash slot or size');
+		seed_hash.copy(this.bytes, this.seeds + slot * 32);
+	}
+
+	// Writes a request for the next flush(), false while the ring is full. Without a boundary every hash meets it.
+	submit(user_data, family, algo, blob, height, seed_slot, boundary) {
+		const tail = this.index[SUBMISSION_TAIL];
+		if (((tail - Atomics.load(this.index, SUBMISSION_HEAD)) >>> 0) >= this.entries) return false;
+		if (blob.length > MAX_BLOB) throw new Error('Blob is longer than ' + MAX_BLOB + ' bytes');
+
+		const slot  = tail & (this.entries - 1);
+		const entry = this.submissions + slot * SUBMISSION_SIZE;
+		const blob_offset = this.blobs + slot * MAX_BLOB;
+		blob.copy(this.bytes, blob_offset);
+		height = height || 0;
+
+		this.view.setUint32(entry, user_data, true);
+		this.view.setUint8(entry + 4, family);
+		this.view.setUint8(entry + 5, algo || 0);
+		this.view.setUint32(entry + 8, blob_offset, true);
+		this.view.setUint32(entry + 12, blob.length, true);
+		this.view.setUint32(entry + 16, height % 0x100000000, true);
+		this.view.setUint32(entry + 20, Math.floor(height / 0x100000000), true);
+		this.view.setUint32(entry + 24, this.seeds + ((seed_slot || 0) % this.seed_slots) * 32, true);
+		if (boundary) boundary.copy(this.bytes, entry + 32, 0, 32);
+		else this.bytes.fill(0xFF, entry + 32, entry + 64);
+
+		Atomics.store(this.index, SUBMISSION_TAIL, (tail + 1) >>> 0);
+		return true;
+	}
+
+	// Wakes the workers for the requests submitted since
+	flush() {
+		this.native.notify();
+	}
+
+	close() {
+		this.native.close();
+	}
+
+	_complete() {
+		let head = this.index[COMPLETION_HEAD];
+		const tail = Atomics.load(this.index, COMPLETION_TAIL);
+		while (head !== tail) {
+			const entry = this.completions + (head & (this.entries - 1)) * COMPLETION_SIZE;
+			this.on_complete(this.view.getUint32(entry, true), this.bytes[entry + 4], entry + 8);
+			head = (head + 1) >>> 0;
+		}
+		Atomics.store(this.index, COMPLETION_HEAD, head);
+		// Workers waiting for room in the completion ring go on
+		this.native.notify();
+	}
+}
+
+module.exports.HashRing = HashRing;
+module.exports.FAMILY   = FAMILY;
+module.exports.STATUS   = STATUS;
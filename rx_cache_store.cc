@@ -0,0 +1,219 @@
+#include "rx_cache_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include "crypto/randomx/randomx.h"
+
+// File layout: header, cache memory at the next page boundary, serialized programs after it
+static const char STORE_MAGIC[8]    = { 'R', 'X', 'C', 'A', 'C', 'H', 'E', '1' };
+static const size_t STORE_DATA_OFFSET = 4096;
+
+struct StoreHeader {
+    char     magic[8];
+    uint64_t config;
+    uint8_t  seed[32];
+    uint64_t memory_size;
+    uint64_t programs_size;
+    uint64_t checksum;
+};
+
+static std::mutex store_mutex;
+static std::string store_dir;
+
+// FNV-1a of everything randomx_init_cache output depends on besides the seed
+static uint64_t config_fingerprint(const int rxid) {
+    const RandomX_ConfigurationBase& config = RandomX_CurrentConfig;
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const void* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) h = (h ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ULL;
+    };
+    const uint32_t values[] = {
+        static_cast<uint32_t>(rxid), config.ArgonMemory, config.ArgonIterations, config.ArgonLanes,
+        config.CacheAccesses, static_cast<uint32_t>(RandomX_ConfigurationBase::SuperscalarLatency)
+    };
+    mix(values, sizeof(values));
+    mix(config.ArgonSalt, strlen(config.ArgonSalt));
+    return h;
+}
+
+static std::string cache_name(const int rxid, const uint64_t config, const uint8_t* seed) {
+    static const char hex[] = "0123456789abcdef";
+    std::string name = "rx" + std::to_string(rxid) + "-";
+    for (int i = 60; i >= 0; i -= 4) name += hex[(config >> i) & 0xF];
+    name += '-';
+    for (int i = 0; i < 32; ++i) {
+        name += hex[seed[i] >> 4];
+        name += hex[seed[i] & 0xF];
+    }
+    return name;
+}
+
+std::string rx_cache_name(const int rxid, const uint8_t* seed) {
+    return cache_name(rxid, config_fingerprint(rxid), seed);
+}
+
+static std::string store_path(const int rxid, const uint64_t config, const uint8_t* seed) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    if (store_dir.empty()) return std::string();
+    return store_dir + "/" + cache_name(rxid, config, seed) + ".cache";
+}
+
+// XXH64 style checksum: only guards against truncated or damaged files, and has to be far
+// cheaper than recomputing the cache (the bundled K12 is the portable reference version)
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl64(const uint64_t x, const int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(const uint64_t acc, const uint64_t input) {
+    return rotl64(acc + input * PRIME2, 31) * PRIME1;
+}
+
+static uint64_t checksum(const uint8_t* p, const size_t size, const uint64_t seed) {
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+        for (; end - p >= 32; p += 32) {
+            for (int i = 0; i < 4; ++i) v[i] = round64(v[i], read64(p + i * 8));
+        }
+        h = rotl64(v[0], 1) + rotl64(v[1], 7) + rotl64(v[2], 12) + rotl64(v[3], 18);
+        for (int i = 0; i < 4; ++i) h = (h ^ round64(0, v[i])) * PRIME1 + PRIME4;
+    } else {
+        h = seed + PRIME5;
+    }
+
+    h += size;
+    for (; end - p >= 8; p += 8) h = rotl64(h ^ round64(0, read64(p)), 27) * PRIME1 + PRIME4;
+    for (; p < end; ++p) h = rotl64(h ^ (*p * PRIME5), 11) * PRIME1;
+
+    h ^= h >> 33; h *= PRIME2;
+    h ^= h >> 29; h *= PRIME3;
+    return h ^ (h >> 32);
+}
+
+static uint64_t checksum(const uint8_t* memory, const size_t memory_size, const uint8_t* programs, const size_t programs_size) {
+    return checksum(programs, programs_size, checksum(memory, memory_size, 0));
+}
+
+RxStoredCache::~RxStoredCache() {
+    munmap(m_base, m_size);
+}
+
+uint8_t* RxStoredCache::memory() const {
+    return m_base + STORE_DATA_OFFSET;
+}
+
+const uint8_t* RxStoredCache::programs() const {
+    return memory() + reinterpret_cast<const StoreHeader*>(m_base)->memory_size;
+}
+
+size_t RxStoredCache::programs_size() const {
+    return reinterpret_cast<const StoreHeader*>(m_base)->programs_size;
+}
+
+void rx_cache_store_dir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(store_mutex);
+    store_dir = dir;
+}
+
+std::unique_ptr<RxStoredCache> rx_cache_store_load(const int rxid, const uint8_t* seed) {
+    const uint64_t config = config_fingerprint(rxid);
+    const std::string path = store_path(rxid, config, seed);
+    if (path.empty()) return nullptr;
+
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    const uint64_t memory_size = static_cast<uint64_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+    if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) <= STORE_DATA_OFFSET + memory_size) {
+        close(fd);
+        return nullptr;
+    }
+
+    // Private writable mapping: RandomX only reads the cache, but it expects ordinary memory
+    void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return nullptr;
+
+    std::unique_ptr<RxStoredCache> stored(new RxStoredCache(base, st.st_size));
+    const StoreHeader* header = static_cast<const StoreHeader*>(base);
+    if (memcmp(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC)) != 0 || header->config != config ||
+        memcmp(header->seed, seed, sizeof(header->seed)) != 0 || header->memory_size != memory_size ||
+        header->programs_size != st.st_size - STORE_DATA_OFFSET - memory_size) {
+        return nullptr;
+    }
+
+    if (checksum(stored->memory(), memory_size, stored->programs(), stored->programs_size()) != header->checksum) return nullptr;
+
+    return stored;
+}
+
+static bool write_all(const int fd, const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size) {
+        const ssize_t n = write(fd, p, size);
+        if (n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+void rx_cache_store_save(const int rxid, const uint8_t* seed, const uint8_t* memory, std::string programs, std::shared_ptr<const void> owner) {
+    StoreHeader header = {};
+    memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    header.config        = config_fingerprint(rxid);
+    header.memory_size   = static_cast<uint64_t>(RandomX_CurrentConfig.ArgonMemory) * 1024;
+    header.programs_size = programs.size();
+    memcpy(header.seed, seed, sizeof(header.seed));
+
+    const std::string path = store_path(rxid, header.config, seed);
+    if (path.empty()) return;
+
+    // Written under a unique temporary name and renamed, so readers never see a partial file and
+    // isolates saving the same cache at once don't write into one file
+    const auto save = [path, header, memory, programs, owner]() mutable {
+        header.checksum = checksum(memory, header.memory_size, reinterpret_cast<const uint8_t*>(programs.data()), programs.size());
+
+        std::string tmp = path + ".XXXXXX";
+        const int fd = mkstemp(&tmp[0]);
+        if (fd < 0) return;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fchmod(fd, 0644);
+
+        static const uint8_t padding[STORE_DATA_OFFSET - sizeof(StoreHeader)] = {};
+        const bool ok = write_all(fd, &header, sizeof(header)) && write_all(fd, padding, sizeof(padding)) &&
+                        write_all(fd, memory, header.memory_size) && write_all(fd, programs.data(), programs.size()) &&
+                        fsync(fd) == 0;
+
+        if (close(fd) != 0 || !ok || rename(tmp.c_str(), path.c_str()) != 0) unlink(tmp.c_str());
+    };
+
+    // The store is only a shortcut, without a thread for it the cache is not saved
+    try {
+        std::thread(save).detach();
+    } catch (const std::system_error&) {
+    }
+}
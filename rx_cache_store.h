@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+// Optional on-disk store of initialised RandomX caches: the Argon2 filled cache memory and the
+// SuperscalarHash programs, keyed by RandomX variant, its config and the seed hash. All
+// functions expect the RandomX config of the variant to be applied by the caller.
+
+// Cache memory and programs mapped from a store file, unmapped on destruction
+class RxStoredCache {
+public:
+    RxStoredCache(void* base, size_t size) : m_base(static_cast<uint8_t*>(base)), m_size(size) {}
+    ~RxStoredCache();
+
+    uint8_t* memory() const;
+    const uint8_t* programs() const;
+    size_t programs_size() const;
+
+private:
+    uint8_t* m_base;
+    size_t m_size;
+};
+
+// Name of the cache of the given seed, unique per RandomX variant and config
+std::string rx_cache_name(int rxid, const uint8_t* seed);
+
+// Sets the store directory, an empty one disables the store (the default)
+void rx_cache_store_dir(const std::string& dir);
+
+// Maps the stored cache of the given seed, nullptr if there is none or it fails the integrity check
+std::unique_ptr<RxStoredCache> rx_cache_store_load(int rxid, const uint8_t* seed);
+
+// Writes an initialised cache to the store on a background thread which holds owner meanwhile
+void rx_cache_store_save(int rxid, const uint8_t* seed, const uint8_t* memory, std::string programs, std::shared_ptr<const void> owner);
@@ -0,0 +1,237 @@
+#include "scan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include "hashing.h"
+extern "C" {
+#include "crypto/randomx/panthera/KangarooTwelve.h"
+}
+
+// Nonces a thread takes at once, small enough to keep all threads busy until the end
+static const uint64_t SCAN_CHUNK = 64;
+
+namespace {
+
+class ScanState {
+public:
+    explicit ScanState(const ScanJob& job) : job(job) {}
+
+    // Next chunk of nonces, false once the range is done or a thread failed
+    bool next(uint32_t& first, uint32_t& last) {
+        if (m_failed) return false;
+        const uint64_t offset = m_next.fetch_add(SCAN_CHUNK);
+        if (offset >= job.count) return false;
+        first = static_cast<uint32_t>(job.start_nonce + offset);
+        last  = static_cast<uint32_t>(job.start_nonce + std::min(offset + SCAN_CHUNK, job.count) - 1);
+        return true;
+    }
+
+    void check(const uint32_t nonce, const uint8_t* hash) {
+        if (!job.accept(hash)) return;
+        ScanResult result;
+        result.nonce = nonce;
+        memcpy(result.hash, hash, sizeof(result.hash));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(result);
+    }
+
+    void fail(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = error;
+        m_failed = true;
+    }
+
+    std::vector<ScanResult> results() {
+        if (m_error) std::rethrow_exception(m_error);
+        std::sort(m_results.begin(), m_results.end(), [](const ScanResult& a, const ScanResult& b) { return a.nonce < b.nonce; });
+        return std::move(m_results);
+    }
+
+    const ScanJob& job;
+
+private:
+    std::atomic<uint64_t> m_next{0};
+    std::atomic<bool> m_failed{false};
+    std::mutex m_mutex;
+    std::vector<ScanResult> m_results;
+    std::exception_ptr m_error;
+};
+
+// Two contexts in one allocation for the 2-way kernels
+class DoubleCtx {
+public:
+    explicit DoubleCtx(const size_t memory) {
+        m_memory = static_cast<uint8_t*>(my_malloc(memory * 2, 4096));
+        if (!m_memory) throw std::domain_error("Can't allocate CryptoNight scratchpad");
+        xmrig::CnCtx::create(ctx, m_memory, memory, 2);
+    }
+
+    ~DoubleCtx() {
+        xmrig::CnCtx::release(ctx, 2);
+        my_free(m_memory);
+    }
+
+    cryptonight_ctx* ctx[2] = {};
+
+private:
+    uint8_t* m_memory = nullptr;
+};
+
+} // namespace
+
+static inline void set_nonce(uint8_t* blob, const uint32_t nonce) {
+    blob[0] = static_cast<uint8_t>(nonce);
+    blob[1] = static_cast<uint8_t>(nonce >> 8);
+    blob[2] = static_cast<uint8_t>(nonce >> 16);
+    blob[3] = static_cast<uint8_t>(nonce >> 24);
+}
+
+// 2-way kernel of the algo, the asm one if the single hash uses asm and it exists
+static xmrig::cn_hash_fun double_fn(const CnHashFn& fn) {
+    if (fn.algo == xmrig::Algorithm::INVALID) return nullptr;
+    const xmrig::CnHash::AlgoVariant av = SOFT_AES ? xmrig::CnHash::AV_DOUBLE_SOFT : xmrig::CnHash::AV_DOUBLE;
+    xmrig::cn_hash_fun result = nullptr;
+    if (fn.assembly) result = xmrig::CnHash::fn(fn.algo, av, static_cast<xmrig::Assembly::Id>(cn_assembly.load(std::memory_order_relaxed)));
+    return result ? result : xmrig::CnHash::fn(fn.algo, av, xmrig::Assembly::NONE);
+}
+
+static void scan_cn(ScanState& state) {
+    const ScanJob& job = state.job;
+    const CnHashFn single = get_family_fn(job.family, job.algo);
+    const xmrig::cn_hash_fun pair = double_fn(single);
+    std::unique_ptr<DoubleCtx> pair_ctx(pair ? new DoubleCtx(single.memory) : nullptr);
+
+    // Both inputs of the 2-way kernels follow each other
+    const size_t size = job.blob.size();
+    std::string input = job.blob + job.blob;
+    uint8_t* blob = reinterpret_cast<uint8_t*>(&input[0]);
+    uint8_t output[64];
+
+    uint32_t first, last;
+    while (state.next(first, last)) {
+        uint64_t nonce = first;
+        if (pair) {
+            for (; nonce + 1 <= last; nonce += 2) {
+                set_nonce(blob + job.nonce_offset, static_cast<uint32_t>(nonce));
+                set_nonce(blob + size + job.nonce_offset, static_cast<uint32_t>(nonce + 1));
+                pair(blob, size, output, pair_ctx->ctx, job.height);
+                state.check(static_cast<uint32_t>(nonce), output);
+                state.check(static_cast<uint32_t>(nonce + 1), output + 32);
+            }
+        }
+        for (; nonce <= last; ++nonce) {
+            set_nonce(blob + job.nonce_offset, static_cast<uint32_t>(nonce));
+            single(blob, size, output, job.height);
+            state.check(static_cast<uint32_t>(nonce), output);
+        }
+    }
+}
+
+static void scan_k12(ScanState& state) {
+    std::string input = state.job.blob;
+    uint8_t* blob = reinterpret_cast<uint8_t*>(&input[0]);
+    uint8_t output[32];
+
+    uint32_t first, last;
+    while (state.next(first, last)) {
+        for (uint64_t nonce = first; nonce <= last; ++nonce) {
+            set_nonce(blob + state.job.nonce_offset, static_cast<uint32_t>(nonce));
+            KangarooTwelve(blob, input.size(), output, sizeof(output), 0, 0);
+            state.check(static_cast<uint32_t>(nonce), output);
+        }
+    }
+}
+
+// Pipelined: each hash_next call finishes the previous nonce and starts the scratchpad of the next one
+static void scan_randomx(ScanState& state) {
+    const ScanJob& job = state.job;
+    const xmrig::Algorithm::Id algo = get_rx_algo(job.algo);
+    randomx_vm* vm = rx_get_vm(job.seed_hash, algo);
+
+    std::string input = job.blob;
+    uint8_t* blob = reinterpret_cast<uint8_t*>(&input[0]);
+    alignas(16) uint64_t temp_hash[8];
+    uint8_t output[32];
+
+    bool pending = false;
+    uint32_t pending_nonce = 0;
+    uint32_t first, last;
+    while (state.next(first, last)) {
+        for (uint64_t nonce = first; nonce <= last; ++nonce) {
+            set_nonce(blob + job.nonce_offset, static_cast<uint32_t>(nonce));
+            if (pending) {
+                randomx_calculate_hash_next(vm, temp_hash, blob, input.size(), output, algo);
+                state.check(pending_nonce, output);
+            } else {
+                randomx_calculate_hash_first(vm, temp_hash, blob, input.size(), algo);
+            }
+            pending       = true;
+            pending_nonce = static_cast<uint32_t>(nonce);
+        }
+    }
+    if (pending) {
+        randomx_calculate_hash_next(vm, temp_hash, blob, input.size(), output, algo);
+        state.check(pending_nonce, output);
+    }
+}
+
+static void scan_thread(ScanState* state, IsolateState* isolate) {
+    std::unique_ptr<IsolateState> own(isolate ? nullptr : new IsolateState());
+    isolate_state = isolate ? isolate : own.get();
+    try {
+        switch (state->job.family) {
+            case FAMILY_K12:     scan_k12(*state); break;
+            case FAMILY_RANDOMX: scan_randomx(*state); break;
+            default:             scan_cn(*state);
+        }
+    } catch (...) {
+        state->fail(std::current_exception());
+    }
+    isolate_state = nullptr;
+}
+
+void scan_check(const ScanJob& job) {
+    if (job.nonce_offset + 4 > job.blob.size()) throw std::domain_error("Nonce offset is past the end of the blob");
+    if (job.start_nonce + job.count > 0x100000000ULL) throw std::domain_error("Nonce range is past 2^32");
+    if (job.family != FAMILY_K12 && job.family != FAMILY_RANDOMX && !get_family_fn(job.family, job.algo).fn) {
+        throw std::domain_error("Hash family can't be scanned");
+    }
+}
+
+std::vector<ScanResult> scan_nonces(const ScanJob& job, const unsigned threads, IsolateState& isolate) {
+    scan_check(job);
+
+    // Cache first, so the other threads find it instead of racing to initialise it
+    if (job.family == FAMILY_RANDOMX) {
+        IsolateState* previous = isolate_state;
+        isolate_state = &isolate;
+        try {
+            rx_get_vm(job.seed_hash, get_rx_algo(job.algo));
+        } catch (...) {
+            isolate_state = previous;
+            throw;
+        }
+        isolate_state = previous;
+    }
+
+    ScanState state(job);
+    const uint64_t chunks = (job.count + SCAN_CHUNK - 1) / SCAN_CHUNK;
+    const unsigned count  = static_cast<unsigned>(std::max<uint64_t>(1, std::min<uint64_t>(threads, chunks)));
+    std::vector<std::thread> pool;
+    try {
+        for (unsigned i = 0; i < count; ++i) pool.emplace_back(scan_thread, &state, i == 0 ? &isolate : nullptr);
+    } catch (const std::system_error& e) {
+        // The threads already running stop at their next chunk
+        state.fail(std::make_exception_ptr(std::domain_error(std::string("Can't start scan thread: ") + e.what())));
+    }
+    for (std::thread& thread : pool) thread.join();
+    return state.results();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Nonce range search over a block template: every nonce of the range is written into a copy of
+// the blob and hashed, by a pool of threads which each take small chunks of the range. Used for
+// pool self tests and benchmarks, not for mining at scale.
+//
+// The first thread hashes in the state passed in, which keeps the RandomX cache, VM and scratchpad
+// for the isolate that adopts it afterwards, the others share that cache.
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct IsolateState;
+
+struct ScanJob {
+    int family          = 0;   // HashFamily, CryptoNight style ones, k12 or randomx
+    int algo            = 0;   // algo number of the JS API within the family
+    uint64_t height     = 0;
+    uint8_t seed_hash[32] = {};
+    std::string blob;
+    size_t nonce_offset  = 0;  // 32-bit little endian nonce
+    uint32_t start_nonce = 0;
+    uint64_t count       = 0;  // start_nonce + count must not go past 2^32
+
+    // Whether a hash is a match, called from all threads at once
+    std::function<bool(const uint8_t* hash)> accept;
+};
+
+struct ScanResult {
+    uint32_t nonce;
+    uint8_t hash[32];
+};
+
+// Throws std::domain_error for a job that can't be scanned
+void scan_check(const ScanJob& job);
+
+// Matches ordered by nonce. Errors of the hash functions are rethrown once all threads stopped.
+std::vector<ScanResult> scan_nonces(const ScanJob& job, unsigned threads, IsolateState& state);
@@ -0,0 +1,224 @@
+#include "shm_cache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+// Object layout: header, data at the next page boundary
+static const char SHM_MAGIC[8]      = { 'C', 'N', 'S', 'H', 'M', 'E', 'M', '1' };
+static const size_t SHM_DATA_OFFSET = 4096;
+static const int SHM_ATTEMPTS       = 16;
+
+enum ShmState : uint32_t {
+    SHM_FILLING = 0,
+    SHM_READY   = 1
+};
+
+struct ShmHeader {
+    char     magic[8];
+    uint64_t size;
+    uint64_t generation;
+    std::atomic<uint32_t> state;
+};
+
+static std::mutex shm_mutex;
+static std::string shm_prefix;
+
+void shm_cache_prefix(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(shm_mutex);
+    shm_prefix = prefix;
+}
+
+bool shm_cache_enabled() {
+    std::lock_guard<std::mutex> lock(shm_mutex);
+    return !shm_prefix.empty();
+}
+
+static std::string shm_name(const std::string& key) {
+    std::lock_guard<std::mutex> lock(shm_mutex);
+    return shm_prefix.empty() ? std::string() : "/" + shm_prefix + "-" + key;
+}
+
+static uint64_t new_generation() {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec)) ^ (static_cast<uint64_t>(getpid()) << 40);
+}
+
+// Whole object lock, shared (F_RDLCK), exclusive (F_WRLCK) or none (F_UNLCK). Open file description
+// locks turn a held lock into the other kind atomically, flock() may drop it in between.
+static bool lock_object(const int fd, const short type, const bool wait) {
+#   ifdef F_OFD_SETLK
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type   = type;
+    lock.l_whence = SEEK_SET;
+    int result;
+    do {
+        result = fcntl(fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &lock);
+    } while (result != 0 && wait && errno == EINTR);
+    return result == 0;
+#   else
+    const int operation = type == F_WRLCK ? LOCK_EX : type == F_RDLCK ? LOCK_SH : LOCK_UN;
+    return flock(fd, operation | (wait ? 0 : LOCK_NB)) == 0;
+#   endif
+}
+
+// Unlinks the name unless it already refers to another incarnation of the object
+static void unlink_generation(const std::string& name, const uint64_t generation) {
+    const int fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > SHM_DATA_OFFSET) {
+        void* base = mmap(nullptr, SHM_DATA_OFFSET, PROT_READ, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            if (static_cast<const ShmHeader*>(base)->generation == generation) shm_unlink(name.c_str());
+            munmap(base, SHM_DATA_OFFSET);
+        }
+    }
+    close(fd);
+}
+
+// Unlinks the objects of the prefix nobody holds, left behind by processes which died attached
+static void reap() {
+#   ifdef __linux__
+    std::string prefix;
+    {
+        std::lock_guard<std::mutex> lock(shm_mutex);
+        if (shm_prefix.empty()) return;
+        prefix = shm_prefix + "-";
+    }
+
+    DIR* dir = opendir("/dev/shm");
+    if (!dir) return;
+    while (const dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, prefix.c_str(), prefix.size()) != 0) continue;
+        const std::string name = std::string("/") + entry->d_name;
+        const int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) continue;
+
+        // An empty object is still being created, its creator has not taken the lock yet
+        struct stat st;
+        if (lock_object(fd, F_WRLCK, false) && fstat(fd, &st) == 0 && st.st_nlink > 0 && st.st_size > 0) shm_unlink(name.c_str());
+        close(fd);
+    }
+    closedir(dir);
+#   endif
+}
+
+ShmCache::~ShmCache() {
+    munmap(m_base, m_size);
+
+    // Nobody else is attached once the shared lock can be made exclusive
+    struct stat st;
+    if (lock_object(m_fd, F_WRLCK, false) && fstat(m_fd, &st) == 0 && st.st_nlink > 0) unlink_generation(m_name, m_generation);
+    close(m_fd);
+
+    reap();
+}
+
+uint8_t* ShmCache::data() const {
+    return m_base + SHM_DATA_OFFSET;
+}
+
+size_t ShmCache::size() const {
+    return m_size - SHM_DATA_OFFSET;
+}
+
+static std::unique_ptr<ShmCache> create(const std::string& name, const int fd, const size_t total, const std::function<bool(uint8_t*)>& fill) {
+    void* base = MAP_FAILED;
+    if (lock_object(fd, F_WRLCK, true) && ftruncate(fd, total) == 0) base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        close(fd);
+        return nullptr;
+    }
+
+#   ifdef MADV_HUGEPAGE
+    madvise(base, total, MADV_HUGEPAGE);
+#   endif
+
+    bool filled = false;
+    try {
+        filled = fill(static_cast<uint8_t*>(base) + SHM_DATA_OFFSET);
+    } catch (...) {
+        shm_unlink(name.c_str());
+        munmap(base, total);
+        close(fd);
+        throw;
+    }
+    if (!filled) {
+        shm_unlink(name.c_str());
+        munmap(base, total);
+        close(fd);
+        return nullptr;
+    }
+
+    ShmHeader* header = static_cast<ShmHeader*>(base);
+    memcpy(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+    header->size       = total - SHM_DATA_OFFSET;
+    header->generation = new_generation();
+    header->state.store(SHM_READY, std::memory_order_release);
+
+    // Read-only from now on like in every other process, the lock is downgraded for the waiting ones
+    // without a moment unlocked, in which reap() or a detaching process would unlink the object
+    mprotect(base, total, PROT_READ);
+    lock_object(fd, F_RDLCK, true);
+    return std::unique_ptr<ShmCache>(new ShmCache(name, fd, base, total, header->generation));
+}
+
+// nullptr with the object closed when it is not usable (yet), the caller tries again
+static std::unique_ptr<ShmCache> attach(const std::string& name, const int fd, const size_t total) {
+    // Blocks while the creator fills the object
+    struct stat st;
+    if (!lock_object(fd, F_RDLCK, true) || fstat(fd, &st) != 0 || st.st_nlink == 0) {
+        close(fd);
+        return nullptr;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        usleep(1000);
+        return nullptr;
+    }
+
+    void* base = static_cast<size_t>(st.st_size) == total ? mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    const ShmHeader* header = static_cast<const ShmHeader*>(base);
+    if (base != MAP_FAILED && memcmp(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC)) == 0 &&
+        header->state.load(std::memory_order_acquire) == SHM_READY && header->size == total - SHM_DATA_OFFSET) {
+        return std::unique_ptr<ShmCache>(new ShmCache(name, fd, base, total, header->generation));
+    }
+
+    // The creator died filling it, or the size does not match: nobody can use it
+    if (base != MAP_FAILED) munmap(base, total);
+    if (lock_object(fd, F_WRLCK, false) && fstat(fd, &st) == 0 && st.st_nlink > 0) shm_unlink(name.c_str());
+    close(fd);
+    return nullptr;
+}
+
+std::unique_ptr<ShmCache> shm_cache_attach(const std::string& key, const size_t size, const std::function<bool(uint8_t*)>& fill) {
+    const std::string name = shm_name(key);
+    if (name.empty()) return nullptr;
+    const size_t total = SHM_DATA_OFFSET + size;
+
+    for (int attempt = 0; attempt < SHM_ATTEMPTS; ++attempt) {
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fd >= 0) return create(name, fd, total, fill);
+        if (errno != EEXIST) return nullptr;
+
+        // Writable only for the exclusive lock of whoever detaches last, mapped read-only
+        fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) continue;
+        std::unique_ptr<ShmCache> cache = attach(name, fd, total);
+        if (cache) return cache;
+    }
+    return nullptr;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+// Optional sharing of initialised caches between processes through named POSIX shared memory
+// objects (/dev/shm on Linux). The first process asking for a key creates the object and fills
+// it under an exclusive lock, the others wait on a shared lock until it is ready and map it
+// read-only. Every attached process holds a shared lock, so whoever detaches last (or the next
+// detach after a crash) unlinks the object. A generation number written by the creator tells
+// incarnations of the same name apart, so rotating seeds never unlinks a newer object.
+
+// Object mapping, detached on destruction
+class ShmCache {
+public:
+    ShmCache(const std::string& name, int fd, void* base, size_t size, uint64_t generation)
+        : m_name(name), m_fd(fd), m_base(static_cast<uint8_t*>(base)), m_size(size), m_generation(generation) {}
+    ~ShmCache();
+
+    uint8_t* data() const;
+    size_t size() const;
+    uint64_t generation() const { return m_generation; }
+
+private:
+    std::string m_name;
+    int m_fd;
+    uint8_t* m_base;
+    size_t m_size;
+    uint64_t m_generation;
+};
+
+// Sets the prefix of the object names, an empty one disables sharing (the default)
+void shm_cache_prefix(const std::string& prefix);
+bool shm_cache_enabled();
+
+// Attaches the object of the key, calling fill with its writable memory if this process creates
+// it. nullptr when sharing is disabled, fill fails or the object can't be created or mapped.
+std::unique_ptr<ShmCache> shm_cache_attach(const std::string& key, size_t size, const std::function<bool(uint8_t*)>& fill);
@@ -12,6 +12,10 @@ node test_kawpow.js || exit 1
 node test_astrobwt.js || exit 1
 node test_astrobwt2.js || exit 1
 node test_k12.js || exit 1
+node test_check.js || exit 1
+node test_c29.js || exit 1
+node test_equihash.js || exit 1
+node test_blake2b_multi.js || exit 1
 node test_sync-1.js || exit 1
 node test_sync-2.js || exit 1
 node test_sync-r.js || exit 1
@@ -40,6 +44,21 @@ node test_rx_wow.js || exit 1
 node test_rx_keva.js || exit 1
 node test_rx_graft.js || exit 1
 node test_rx_switch.js || exit 1
+node test_rx_interpreter.js || exit 1
+node test_rx_cache_store.js || exit 1
+node test_shm_cache.js || exit 1
+node test_rx_cache_timing.js || exit 1
+node test_tune.js || exit 1
+node test_wx.js || exit 1
+node test_rx_huge_jit.js || exit 1
+node test_workers.js || exit 1
+node test_numa.js || exit 1
+node test_hashd.js || exit 1
+node test_trim.js || exit 1
+node test_scan.js || exit 1
+node test_warmup.js || exit 1
+node test_ring.js || exit 1
+node test_capture.js || exit 1
 node test_ar2_chukwa.js || exit 1
 node test_ar2_chukwa2.js || exit 1
 node test_ar2_wrkz.js || exit 1
@@ -62,6 +81,7 @@ node test_perf_rx_keva.js
 node test_perf_rx_graft.js
 node test_perf_rx_switch.js
 node test_perf_pico.js
+node test_perf_ring.js
 node test_perf_double.js
 node test_perf_ar2_chukwa2.js
 node test_perf_ar2_wrkz.js
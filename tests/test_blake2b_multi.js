@@ -0,0 +1,47 @@
+"use strict";
+const crypto = require('crypto');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+let failed = 0;
+
+function fail(message) {
+	console.error(message);
+	++ failed;
+}
+
+// Every count exercises full and padded SIMD lane groups as well as the scalar tail
+for (const length of [ 0, 4, 127, 128, 129, 300, 8200 ]) {
+	for (let count = 0; count <= 19; ++ count) {
+		const buffers = Array.from({ length: count }, (_, i) => Buffer.from(Array.from({ length }, (_, j) => (i * 31 + j * 7) & 0xFF)));
+		const hashes = multiHashing.blake2b_multi(buffers);
+		if (hashes.length !== count) fail('blake2b_multi returned ' + hashes.length + ' hashes instead of ' + count);
+		for (let i = 0; i < count; ++ i) {
+			const expected = crypto.createHash('blake2b512').update(buffers[i]).digest('hex');
+			if (hashes[i].toString('hex') !== expected) fail('blake2b_multi of ' + count + ' x ' + length + ' bytes, lane ' + i + ': ' + hashes[i].toString('hex'));
+		}
+	}
+}
+
+const expected32 = [
+	'c978e85c0d32724ed4550cc0901a10e5412f3dcf29fd20ffe35a419f097dd113',
+	'18572ad3feba0b88307c1b2d44de22cba1456504ad90b71c269bcab79086a96d',
+	'cf803bc7dc140d9accf2de7f64981ea37aca7ed29150099c7981a29841b85166',
+	'2cd6e77231d3281ba5e7bc9c01a19d8600c9e80db5bb5ac446be6528abec039b',
+	'32df7b76c0e1c6aee6829b1f71b2a268a716b57a073d0d3cd39a8eb93b5933da',
+];
+multiHashing.blake2b_multi(expected32.map((_, i) => Buffer.alloc(200, i)), 32).forEach(function(hash, i) {
+	if (hash.toString('hex') !== expected32[i]) fail('blake2b_multi 32 byte hash ' + i + ': ' + hash.toString('hex'));
+});
+
+for (const args of [ [ [ Buffer.alloc(4), Buffer.alloc(5) ] ], [ [ Buffer.alloc(4), 'abcd' ] ], [ [ Buffer.alloc(4) ], 65 ], [ Buffer.alloc(4) ] ]) {
+	let threw = false;
+	try { multiHashing.blake2b_multi(...args); } catch (e) { threw = true; }
+	if (!threw) fail('blake2b_multi accepted invalid arguments');
+}
+
+if (failed) {
+	console.log(failed + ' tests failed on: blake2b_multi');
+	process.exit(1);
+} else {
+	console.log('blake2b_multi test passed');
+}
@@ -0,0 +1,30 @@
+"use strict";
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+function check(name, result, expected) {
+	if (result === expected)
+		console.log(name + ' test passed');
+	else {
+		console.log(name + ' test failed: ' + result);
+		process.exit(1);
+	}
+}
+
+const ring = n => Array.from({length: n}, (_, i) => ((i * 2654435761) >>> 3) & 0x1FFFFFFF);
+const out  = Buffer.alloc(32);
+
+check('C29 cycle hash', multiHashing.c29_cycle_hash(ring(32)).toString('hex'), '5f72aea5af355a45ab4e7d204ef609434c5b2e20990e95cee79a0df0f51de033');
+check('C29b cycle hash', multiHashing.c29b_cycle_hash(ring(40)).toString('hex'), 'a17bee09119d27aca95690be01fe497dd4539433748317ca92ca00fae478c420');
+check('C29i cycle hash', multiHashing.c29i_cycle_hash(new Uint32Array(ring(48))).toString('hex'), 'e3a77efa92c39acb033adb788ae31372f840e32c93679802c461413a2892a635');
+check('C29 cycle hash output', multiHashing.c29_cycle_hash(new Uint32Array(ring(32)), out) === out && out.toString('hex'), '5f72aea5af355a45ab4e7d204ef609434c5b2e20990e95cee79a0df0f51de033');
+
+const header = Buffer.alloc(80, 7);
+check('C29s verify', multiHashing.c29s(header, new Uint32Array(ring(32))), multiHashing.c29s(header, ring(32)));
+
+check('K12 output', multiHashing.k12(Buffer.from('6465206f6d6e69627573206475626974616e64756d', 'hex'), out) === out && out.toString('hex'), 'b01b212c3daa15fd1cb18f3fb70cc17e3d0185e36cf4b6cd75fb06b3b3a73594');
+check('KawPow output', multiHashing.kawpow(
+	Buffer.from('63543d3913fe56e6720c5e61e8d208d05582875822628f483279a3e8d9c9a8b3', 'hex'),
+	Buffer.from('88a23b0033eb959b', 'hex'),
+	Buffer.from('89732e5ff8711c32558a308fc4b8ee77416038a70995670e3eb84cbdead2e337', 'hex'),
+	out
+) === out && out.toString('hex'), '0000000718ba5143286c46f44eee668fdf59b8eba810df21e4e2f4ec9538fc20');
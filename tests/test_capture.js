@@ -0,0 +1,152 @@
+"use strict";
+const fs           = require('fs');
+const os           = require('os');
+const path         = require('path');
+const child        = require('child_process');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+const client       = require('../client');
+const FAMILY       = client.FAMILY;
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('Capture ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+const seed_hash = Buffer.from('1b7d5a95878b2d38be374cf3476bd07f5ea83adf2e8ca3f34aca49009af7f498', 'hex');
+const header_hash = Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex');
+const nonce = Buffer.from('ff4136b6b6a244ec', 'hex');
+const kawpow = [
+	Buffer.from('63543d3913fe56e6720c5e61e8d208d05582875822628f483279a3e8d9c9a8b3', 'hex'),
+	Buffer.from('88a23b0033eb959b', 'hex'),
+	Buffer.from('89732e5ff8711c32558a308fc4b8ee77416038a70995670e3eb84cbdead2e337', 'hex'),
+];
+
+const replay = path.join(__dirname, '../build/Release/cryptonight-replay');
+const daemon = path.join(__dirname, '../build/Release/cryptonight-hashd');
+const log    = path.join(os.tmpdir(), 'cryptonight-capture-test-' + process.pid + '.log');
+const daemon_log = log + '.hashd';
+
+// Records of a capture file, the layout is described in capture.h
+function read_capture(file) {
+	const data = fs.readFileSync(file);
+	if (data.toString('latin1', 0, 8) !== 'CNHCAP01') throw new Error('No capture header');
+	const records = [];
+	let time = 0;
+	for (let offset = 8; offset < data.length;) {
+		const record = { time: time += data.readUInt32LE(offset), family: data[offset + 4], algo: data[offset + 5] };
+		const size = data.readUInt16LE(offset + 6);
+		offset += 8;
+		if (record.family <= FAMILY.cryptonight_heavy || record.family === FAMILY.ethash || record.family === FAMILY.etchash) {
+			record.height = Number(data.readBigUInt64LE(offset));
+			offset += 8;
+		}
+		if (record.family === FAMILY.randomx) {
+			record.seed_hash = data.subarray(offset, offset + 32);
+			offset += 32;
+		}
+		record.payload = data.subarray(offset, offset + size);
+		offset += size;
+		records.push(record);
+	}
+	return records;
+}
+
+// Parsed per family and algo rows of the replay report
+function run_replay(args) {
+	const result = child.spawnSync(replay, [ '--log', log ].concat(args), { encoding: 'utf8' });
+	const rows = {};
+	for (const line of result.stdout.split('\n').slice(2)) {
+		const fields = line.trim().split(/\s+/);
+		if (fields.length === 9) rows[fields[0] + '/' + fields[1]] = { requests: Number(fields[2]), failed: Number(fields[3]), p50: Number(fields[5]), max: Number(fields[8]) };
+	}
+	return { status: result.status, rows: rows };
+}
+
+async function main() {
+	multiHashing.k12(blob);
+	multiHashing.capture(log);
+	multiHashing.cryptonight(blob, 13, 1806260);
+	multiHashing.cryptonight_check(blob, 13, 1806260, 1, 1);
+	multiHashing.cryptonight_pico(blob, 0);
+	multiHashing.k12(blob);
+	multiHashing.randomx(blob, seed_hash, 0);
+	multiHashing.ethash(header_hash, nonce, 1257006);
+	multiHashing.kawpow(kawpow[0], kawpow[1], kawpow[2]);
+	await new Promise(resolve => setTimeout(resolve, 50));
+	multiHashing.k12(Buffer.alloc(0));
+	multiHashing.capture();
+	multiHashing.k12(blob);
+
+	const records = read_capture(log);
+	check('records', records.length === 8, records.length);
+	check('cryptonight', records[0].family === FAMILY.cryptonight && records[0].algo === 13 && records[0].height === 1806260 && records[0].payload.equals(blob), JSON.stringify(records[0]));
+	check('check variant', records[1].family === FAMILY.cryptonight && records[1].height === 1806260, JSON.stringify(records[1]));
+	check('randomx', records[4].family === FAMILY.randomx && records[4].seed_hash.equals(seed_hash) && records[4].payload.equals(blob), JSON.stringify(records[4]));
+	check('ethash', records[5].family === FAMILY.ethash && records[5].height === 1257006 && records[5].payload.equals(Buffer.concat([ header_hash, nonce ])), JSON.stringify(records[5]));
+	check('kawpow', records[6].family === FAMILY.kawpow && records[6].payload.equals(Buffer.concat(kawpow)), JSON.stringify(records[6]));
+	check('empty blob', records[7].family === FAMILY.k12 && records[7].payload.length === 0, JSON.stringify(records[7]));
+	check('time', records[0].time === 0 && records[7].time - records[6].time >= 50000, records[7].time - records[6].time);
+
+	try {
+		multiHashing.capture(1);
+		check('bad path', false, 'no exception');
+	} catch (e) {}
+	try {
+		multiHashing.capture(path.join(os.tmpdir(), 'no-such-directory-' + process.pid, 'capture.log'));
+		check('missing directory', false, 'no exception');
+	} catch (e) {}
+
+	if (!fs.existsSync(replay)) {
+		console.log('Capture replay test skipped: cryptonight-replay is not built');
+	} else {
+		for (const speed of [ 'max', 'original' ]) {
+			const result = run_replay([ '--threads', '2', '--speed', speed ]);
+			check(speed + ' status', result.status === 0, result.status);
+			const counts = { 'cryptonight/13': 2, 'cryptonight_pico/0': 1, 'k12/0': 2, 'randomx/0': 1, 'ethash/0': 1, 'kawpow/0': 1 };
+			for (const key in counts) {
+				const row = result.rows[key];
+				check(speed + ' ' + key, row && row.requests === counts[key] && row.failed === 0 && row.p50 <= row.max, JSON.stringify(row));
+			}
+		}
+		check('usage', run_replay([ '--speed', 'fast' ]).status === 1, 'bad speed accepted');
+	}
+
+	if (!fs.existsSync(daemon)) {
+		console.log('Capture hashd test skipped: cryptonight-hashd is not built');
+	} else {
+		// Requests the daemon accepted are in its capture once it was stopped
+		const socket_path = log + '.sock';
+		const proc = child.spawn(daemon, [ '--socket', socket_path, '--threads', '1', '--capture', daemon_log ], { stdio: [ 'ignore', 'pipe', 'inherit' ] });
+		await new Promise(resolve => proc.stdout.once('data', resolve));
+		const hashd = await client.connect(socket_path);
+		await hashd.k12(blob);
+		await hashd.randomx(blob, seed_hash, 0);
+		hashd.close();
+		const exited = new Promise(resolve => proc.once('exit', resolve));
+		proc.kill();
+		await exited;
+		const daemon_records = read_capture(daemon_log);
+		check('hashd records', daemon_records.length === 2, daemon_records.length);
+		check('hashd randomx', daemon_records.length === 2 && daemon_records[1].seed_hash.equals(seed_hash) && daemon_records[1].payload.equals(blob), 'wrong seed hash or blob');
+		check('hashd socket', !fs.existsSync(socket_path), 'socket left behind');
+	}
+}
+
+main().catch(e => {
+	console.log('Capture test failed: ' + e);
+	++ failed;
+}).then(() => {
+	for (const file of [ log, daemon_log ]) {
+		try { fs.unlinkSync(file); } catch (e) {}
+	}
+	if (failed) {
+		console.log(failed + ' tests failed on: capture');
+		process.exit(1);
+	} else {
+		console.log('Capture test passed');
+	}
+});
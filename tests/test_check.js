@@ -0,0 +1,41 @@
+"use strict";
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+function check(name, flags, expected) {
+	if (flags === expected)
+		console.log(name + ' check test passed');
+	else {
+		console.log(name + ' check test failed: ' + flags);
+		process.exit(1);
+	}
+}
+
+{ const blob = Buffer.from('6465206f6d6e69627573206475626974616e64756d', 'hex');
+  const hash = Buffer.alloc(32);
+  check('K12 share', multiHashing.k12_check(blob, 0xFFFFFFFFFFFFn, 0x1000n), 0);
+  check('K12 block', multiHashing.k12_check(blob, 0xFFFFFFFFFFFFFFFFn, 0x9435a7b3b306fb76n, hash), multiHashing.CHECK_SHARE | multiHashing.CHECK_BLOCK);
+  check('K12 boundary', multiHashing.k12_check(blob, hash, Buffer.alloc(32)), multiHashing.CHECK_SHARE);
+  if (hash.toString('hex') !== 'b01b212c3daa15fd1cb18f3fb70cc17e3d0185e36cf4b6cd75fb06b3b3a73594') {
+	console.log('K12 check test failed: ' + hash.toString('hex'));
+        process.exit(1);
+  }
+}
+
+check('KawPow', multiHashing.kawpow_check(
+	Buffer.from('63543d3913fe56e6720c5e61e8d208d05582875822628f483279a3e8d9c9a8b3', 'hex'),
+	Buffer.from('88a23b0033eb959b', 'hex'),
+	Buffer.from('89732e5ff8711c32558a308fc4b8ee77416038a70995670e3eb84cbdead2e337', 'hex'),
+	0x0000000800000000n, 0x0000000700000000n
+), multiHashing.CHECK_SHARE);
+
+{ const header = Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex');
+  const nonce  = Buffer.from('ff4136b6b6a244ec', 'hex');
+  const mix    = Buffer.from('47da5e47804594550791c24331163c1f1fde5bc622170e83515843b2b13dbe14', 'hex');
+  check('Ethash', multiHashing.ethash_check(header, nonce, 1257006, mix, 0x0000000000100000n, 0x0000000000095d18n), multiHashing.CHECK_SHARE);
+  check('Ethash low share', multiHashing.ethash_check(header, nonce, 1257006, mix, 0x0000000000095d18n, 0x0000000000095d18n), 0);
+  check('Ethash bad mix', multiHashing.ethash_check(header, nonce, 1257006, Buffer.alloc(32), 0xFFFFFFFFFFFFFFFFn, 0n), 0);
+  // The output buffer only gets the hash of a validated mix hash
+  const out = Buffer.alloc(32, 0xAA);
+  check('Ethash bad mix output', multiHashing.ethash_check(header, nonce, 1257006, Buffer.alloc(32), 0xFFFFFFFFFFFFFFFFn, 0n, out) === 0 && out.equals(Buffer.alloc(32)), true);
+  check('Ethash output', multiHashing.ethash_check(header, nonce, 1257006, mix, 0x0000000000100000n, 0n, out) === multiHashing.CHECK_SHARE && out.toString('hex') === '0000000000095d18875acd4a2c2a5ff476c9acf283b4975d7af8d6c33d119c74', true);
+}
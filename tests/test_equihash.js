@@ -0,0 +1,35 @@
+"use strict";
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+// header, solution, n, k
+const tests = [
+	[ '030a11181f262d343b424950575e656c737a81888f969da4abb2b9c0c7ced5dce3eaf1f8ff060d141b222930373e454c535a61686f767d848b9299a0a7aeb5bcc3cad1d8dfe6edf4fb020910171e252c333a41484f565d646b727980878e959ca3aab1b8bfc6cdd4dbe2e9f0f7fe050c131a21282f363d444b525960676e757c838a91989fa6adb401000000',
+	  '03044bb1e38d267b4a081d8b48c29c1617d5193ac69d63266273e55db5a196c7c60389f0', 48, 5 ],
+	[ '030a11181f262d343b424950575e656c737a81888f969da4abb2b9c0c7ced5dce3eaf1f8ff060d141b222930373e454c535a61686f767d848b9299a0a7aeb5bcc3cad1d8dfe6edf4fb020910171e252c333a41484f565d646b727980878e959ca3aab1b8bfc6cdd4dbe2e9f0f7fe050c131a21282f363d444b525960676e757c838a91989fa6adb402000000',
+	  '003f6006ac219914a16f764e519815532d10bac8f70b6645c9d166e2b04dac25bbfc029c89a764ae1be18173f3bd1d39b953b80491842c4bbc3ca8123dd2813632639ba8', 96, 5 ],
+];
+
+let failed = 0;
+for (const [header, solution, n, k] of tests) {
+	const soln = Buffer.from(solution, 'hex');
+	if (multiHashing.equihash(Buffer.from(header, 'hex'), soln, 'ZcashPoW', n, k) !== true) {
+		console.error('Equihash ' + n + ',' + k + ' rejected a valid solution');
+		++ failed;
+	}
+	soln[soln.length - 1] ^= 1;
+	if (multiHashing.equihash(Buffer.from(header, 'hex'), soln, 'ZcashPoW', n, k) !== false) {
+		console.error('Equihash ' + n + ',' + k + ' accepted an invalid solution');
+		++ failed;
+	}
+	if (multiHashing.equihash(Buffer.from(header, 'hex'), Buffer.from(solution, 'hex'), 'ZcashPoX', n, k) !== false) {
+		console.error('Equihash ' + n + ',' + k + ' ignored the personalization');
+		++ failed;
+	}
+}
+
+if (failed) {
+	console.log(failed + ' tests failed on: equihash');
+	process.exit(1);
+} else {
+	console.log('equihash test passed');
+}
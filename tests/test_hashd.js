@@ -0,0 +1,109 @@
+"use strict";
+const fs           = require('fs');
+const os           = require('os');
+const path         = require('path');
+const child        = require('child_process');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+const client       = require('../client');
+
+const daemon = path.join(__dirname, '../build/Release/cryptonight-hashd');
+if (!fs.existsSync(daemon)) {
+	console.log('hashd test skipped: cryptonight-hashd is not built');
+	process.exit(0);
+}
+
+const socket_path = path.join(os.tmpdir(), 'cryptonight-hashd-test-' + process.pid + '.sock');
+const proc = child.spawn(daemon, [ '--socket', socket_path, '--threads', '2', '--batch', '8', '--memory-budget', '8' ], { stdio: [ 'ignore', 'pipe', 'inherit' ] });
+
+let failed = 0;
+function expect(name, result, expected) {
+	if (result !== expected) {
+		console.log(name + ': expected ' + expected + ', got ' + result);
+		++ failed;
+	}
+}
+
+async function run() {
+	const hashd = await client.connect(socket_path);
+
+	const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+	expect('cryptonight', (await hashd.cryptonight(blob, 8)).toString('hex'), multiHashing.cryptonight(blob, 8).toString('hex'));
+	expect('cryptonight r', (await hashd.cryptonight(blob, 13, 1806260)).toString('hex'), multiHashing.cryptonight(blob, 13, 1806260).toString('hex'));
+	expect('cryptonight_light', (await hashd.cryptonight_light(blob, 1)).toString('hex'), multiHashing.cryptonight_light(blob, 1).toString('hex'));
+	expect('cryptonight_pico', (await hashd.cryptonight_pico(blob, 0)).toString('hex'), multiHashing.cryptonight_pico(blob, 0).toString('hex'));
+	expect('argon2', (await hashd.argon2(blob, 2)).toString('hex'), multiHashing.argon2(blob, 2).toString('hex'));
+	expect('k12', (await hashd.k12(blob)).toString('hex'), multiHashing.k12(blob).toString('hex'));
+	// Larger than the memory budget, hashed on its own
+	expect('astrobwt', (await hashd.astrobwt(blob, 0)).toString('hex'), multiHashing.astrobwt(blob, 0).toString('hex'));
+
+	const ethash = await hashd.ethash(Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex'), Buffer.from('ff4136b6b6a244ec', 'hex'), 1257006);
+	expect('ethash', ethash[0].toString('hex'), '0000000000095d18875acd4a2c2a5ff476c9acf283b4975d7af8d6c33d119c74');
+	expect('ethash mix', ethash[1].toString('hex'), '47da5e47804594550791c24331163c1f1fde5bc622170e83515843b2b13dbe14');
+	// Past ETCHASH_EPOCH_HEIGHT, batched by the doubled epoch
+	const etchash = await hashd.etchash(Buffer.from('053690289a0a9dac132c268d6ffe64ad8e025b74eefa61b51934c57d2a49d9e4', 'hex'), Buffer.from('fe09000002a784b0', 'hex'), 15658542);
+	expect('etchash', etchash[0].toString('hex'), '0000000d4899e38dbd9ac5bdc3726e34669986f53af0c60f50c5aa54e7fa4ed0');
+
+	const kawpow = await hashd.kawpow(
+		Buffer.from('63543d3913fe56e6720c5e61e8d208d05582875822628f483279a3e8d9c9a8b3', 'hex'),
+		Buffer.from('88a23b0033eb959b', 'hex'),
+		Buffer.from('89732e5ff8711c32558a308fc4b8ee77416038a70995670e3eb84cbdead2e337', 'hex')
+	);
+	expect('kawpow', kawpow.toString('hex'), '0000000718ba5143286c46f44eee668fdf59b8eba810df21e4e2f4ec9538fc20');
+
+	// Concurrent requests of mixed variants and sizes are batched and answered out of order
+	const seed = Buffer.from('1b7d5a95878b2d38be374cf3476bd07f5ea83adf2e8ca3f34aca49009af7f498', 'hex');
+	const jobs = [];
+	for (let i = 0; i < 24; ++i) {
+		const input = Buffer.concat([ blob, Buffer.alloc(i % 3) ]);
+		input[39] = i;
+		const algo = i % 2 ? 3 : 0;
+		jobs.push(hashd.randomx(input, seed, algo).then(result => expect('randomx ' + i, result.toString('hex'), multiHashing.randomx(input, seed, algo).toString('hex'))));
+	}
+	await Promise.all(jobs);
+
+	// A block candidate sent after a burst of shares does not wait for all of them
+	const order = [];
+	const shares = [];
+	for (let i = 0; i < 48; ++i) shares.push(hashd.cryptonight(blob, 0).then(() => order.push('share')));
+	const block = hashd.job(client.PRIORITY.block).cryptonight(blob, 0).then(() => order.push('block'));
+	await Promise.all(shares.concat([ block ]));
+	expect('block priority', order.indexOf('block') < order.length - 8, true);
+
+	// Shares of a stale job which no worker took yet are cancelled
+	const stale = hashd.job();
+	let hashed = 0, cancelled = 0;
+	const stale_shares = [];
+	for (let i = 0; i < 48; ++i) {
+		stale_shares.push(stale.cryptonight(blob, 0).then(() => ++ hashed, err => { if (err.message === 'Cancelled') ++ cancelled; }));
+	}
+	const count = await stale.cancel();
+	await Promise.all(stale_shares);
+	expect('cancelled', cancelled, count);
+	expect('cancelled some', count > 0, true);
+	expect('cancelled or hashed', hashed + cancelled, 48);
+	expect('nothing left to cancel', await stale.cancel(), 0);
+
+	try {
+		await hashd.randomx(Buffer.alloc(0), Buffer.alloc(16), 0);
+		console.log('Short RandomX payload should be rejected');
+		++ failed;
+	} catch (e) {}
+
+	hashd.close();
+}
+
+proc.stdout.once('data', () => {
+	run().catch(err => {
+		console.log(err.message);
+		++ failed;
+	}).then(() => {
+		proc.kill();
+		try { fs.unlinkSync(socket_path); } catch (e) {}
+		if (failed) {
+			console.log(failed + ' tests failed on: hashd');
+			process.exit(1);
+		} else {
+			console.log('hashd test passed');
+		}
+	});
+});
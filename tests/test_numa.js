@@ -0,0 +1,53 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+
+let failed = 0;
+
+const nodes = multiHashing.numa_nodes();
+const seen = new Set();
+if (!Array.isArray(nodes) || nodes.length < 1) {
+	console.log('numa_nodes should return at least one node');
+	++ failed;
+}
+for (const cpus of nodes) {
+	for (const cpu of cpus) {
+		if (!Number.isInteger(cpu) || cpu < 0 || seen.has(cpu)) {
+			console.log('Bad CPU list: ' + JSON.stringify(nodes));
+			++ failed;
+		}
+		seen.add(cpu);
+	}
+}
+
+const expected = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const hash = () => multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0).toString('hex');
+if (hash() !== expected) {
+	console.log('RandomX hash before pinning is wrong');
+	++ failed;
+}
+
+// Every node with CPUs can be pinned to, hashes stay the same on its VMs and cache replica
+nodes.forEach(function(cpus, node) {
+	if (!cpus.length) return;
+	multiHashing.numa_pin(node);
+	const result = hash();
+	if (result !== expected) {
+		console.log('Expected ' + expected + ' on node ' + node + ', got ' + result);
+		++ failed;
+	}
+});
+
+for (const bad of [ -1, nodes.length, 'a' ]) {
+	try {
+		multiHashing.numa_pin(bad);
+		console.log('numa_pin(' + JSON.stringify(bad) + ') should throw');
+		++ failed;
+	} catch (e) {}
+}
+
+if (failed) {
+	console.log(failed + ' tests failed on: numa');
+	process.exit(1);
+} else {
+	console.log('numa test passed');
+}
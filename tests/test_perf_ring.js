@@ -0,0 +1,23 @@
+"use strict";
+const { HashRing, FAMILY } = require('../ring');
+
+const ITER = 1000000;
+let input = Buffer.alloc(76);
+
+let next = 0, done = 0, start;
+const ring = new HashRing({ entries: 4096 }, function() {
+  if (++ done === ITER) {
+    console.log("Perf: " + 1000 * ITER / (Date.now() - start) + " H/s");
+    ring.close();
+  } else if (next < ITER) {
+    submit();
+  }
+});
+
+function submit() {
+  while (next < ITER && ring.submit(next, FAMILY.k12, 0, input)) ++ next;
+  ring.flush();
+}
+
+start = Date.now();
+submit();
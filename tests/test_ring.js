@@ -0,0 +1,81 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+const { HashRing, FAMILY, STATUS } = require('../ring');
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('Ring ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+const seed_hash = Buffer.from('1b7d5a95878b2d38be374cf3476bd07f5ea83adf2e8ca3f34aca49009af7f498', 'hex');
+
+function with_nonce(nonce) {
+	const input = Buffer.from(blob);
+	input.writeUInt32LE(nonce, 39);
+	return input;
+}
+
+// Requests of every kind, more of them than the ring holds at once
+const requests = [];
+for (let i = 0; i < 3000; ++i) requests.push({ family: FAMILY.k12, algo: 0, blob: with_nonce(i), single: input => multiHashing.k12(input) });
+for (let i = 0; i < 8; ++i) requests.push({ family: FAMILY.cryptonight, algo: 13, height: 1806260, blob: with_nonce(i), single: input => multiHashing.cryptonight(input, 13, 1806260) });
+for (let i = 0; i < 8; ++i) requests.push({ family: FAMILY.cryptonight_pico, algo: 0, blob: with_nonce(i), single: input => multiHashing.cryptonight_pico(input, 0) });
+for (let i = 0; i < 4; ++i) requests.push({ family: FAMILY.randomx, algo: 0, blob: with_nonce(i), single: input => multiHashing.randomx(input, seed_hash, 0) });
+requests.push({ family: FAMILY.ethash, algo: 0, blob: blob, error: true });
+
+// Every hash meets half the boundaries
+const boundary = Buffer.alloc(32, 0xFF);
+boundary[31] = 0x7F;
+
+let next = 0, done = 0;
+const ring = new HashRing({ entries: 256, threads: 3 }, function(user_data, status, hash_offset) {
+	const request = requests[user_data];
+	++ done;
+	if (request.error) {
+		check('bad request', status === STATUS.error, status);
+	} else {
+		const expected = request.single(request.blob);
+		check('hash ' + user_data, ring.bytes.subarray(hash_offset, hash_offset + 32).equals(expected), ring.bytes.subarray(hash_offset, hash_offset + 32).toString('hex') + ' != ' + expected.toString('hex'));
+		check('status ' + user_data, status === (expected[31] <= 0x7F ? STATUS.meets_target : STATUS.above_target), status);
+	}
+	if (done === requests.length) finish();
+	else submit();
+});
+ring.set_seed(1, seed_hash);
+
+function submit() {
+	while (next < requests.length) {
+		const request = requests[next];
+		if (!ring.submit(next, request.family, request.algo, request.blob, request.height, 1, boundary)) break;
+		++ next;
+	}
+	ring.flush();
+}
+
+function finish() {
+	ring.close();
+	ring.close();
+	try {
+		multiHashing.ring(new SharedArrayBuffer(1024), 256, 1, () => {});
+		check('small buffer', false, 'no exception');
+	} catch (e) {}
+	try {
+		multiHashing.ring(new SharedArrayBuffer(65536), 100, 1, () => {});
+		check('entries', false, 'no exception');
+	} catch (e) {}
+	// Workers beyond the CPUs are capped
+	new HashRing({ entries: 64, threads: 100000 }, () => {}).close();
+
+	if (failed) {
+		console.log(failed + ' tests failed on: ring');
+		process.exit(1);
+	} else {
+		console.log('Ring test passed');
+	}
+}
+
+submit();
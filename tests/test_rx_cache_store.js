@@ -0,0 +1,53 @@
+"use strict";
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const child_process = require('child_process');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+const expected = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const hash = () => multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0).toString('hex');
+
+function check(name, result) {
+	if (result === expected)
+		console.log('RandomX cache store ' + name + ' test passed');
+	else {
+		console.log('RandomX cache store ' + name + ' test failed: ' + result);
+		process.exit(1);
+	}
+}
+
+if (process.argv[2]) {
+	multiHashing.randomx_cache_dir(process.argv[2]);
+	const start = Date.now();
+	const result = hash();
+	console.log(result + ' ' + (Date.now() - start));
+	return;
+}
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'rx-cache-'));
+const run = () => child_process.execFileSync(process.execPath, [__filename, dir]).toString().trim().split(' ');
+
+multiHashing.randomx_cache_dir(dir);
+check('init', hash());
+
+// The cache is written in the background
+const wait = Date.now();
+let files;
+while (!(files = fs.readdirSync(dir).filter(f => f.endsWith('.cache'))).length && Date.now() - wait < 60000) child_process.execSync('sleep 0.1');
+if (files.length !== 1) {
+	console.log('RandomX cache store write test failed: ' + fs.readdirSync(dir));
+	process.exit(1);
+}
+
+const [loaded, ms] = run();
+check('load (' + ms + ' ms)', loaded);
+
+// A damaged file is ignored and rewritten
+const file = path.join(dir, files[0]);
+const fd = fs.openSync(file, 'r+');
+fs.writeSync(fd, Buffer.from('damaged'), 0, 7, 1 << 20);
+fs.closeSync(fd);
+check('damaged', run()[0]);
+
+fs.rmSync(dir, { recursive: true, force: true });
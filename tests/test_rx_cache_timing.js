@@ -0,0 +1,18 @@
+"use strict";
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+function fail(msg) {
+	console.log('RandomX cache timing test failed: ' + msg);
+	process.exit(1);
+}
+
+if (multiHashing.randomx_cache_timing(0) !== undefined) fail('timing before the first hash');
+
+const result = multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0).toString('hex');
+if (result !== '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6') fail('hash ' + result);
+
+const timing = multiHashing.randomx_cache_timing(0);
+if (timing.stored || !(timing.argon2 > 0) || !(timing.superscalar > 0) || timing.total < timing.argon2 || typeof timing.argon2_impl !== 'string') {
+	fail(JSON.stringify(timing));
+}
+console.log('RandomX cache timing test passed (' + JSON.stringify(timing) + ')');
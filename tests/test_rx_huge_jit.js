@@ -0,0 +1,64 @@
+"use strict";
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { Worker, isMainThread, parentPort } = require('worker_threads');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+const input = Buffer.from('This is a test');
+const seed  = Buffer.from('12345678901234567890123456789012');
+const hash  = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+
+if (!isMainThread) {
+	parentPort.postMessage(multiHashing.randomx(input, seed, 0).toString('hex'));
+	return;
+}
+
+function fail(msg) {
+	console.log('Huge pages JIT test failed: ' + msg);
+	process.exit(1);
+}
+
+// JIT views of the process and the free huge pages, both have to stay put once the VMs are recycled
+function usage() {
+	if (process.platform !== 'linux') return '';
+	const jit  = fs.readFileSync('/proc/self/maps', 'utf8').split('\n').filter(line => line.includes('xmrig-jit')).length;
+	const free = /HugePages_Free:\s+(\d+)/.exec(fs.readFileSync('/proc/meminfo', 'utf8'));
+	return jit + ' JIT mappings, ' + (free ? free[1] : '?') + ' free huge pages';
+}
+
+async function round() {
+	const workers = [ 0, 1 ].map(() => new Promise((resolve, reject) => {
+		const worker = new Worker(__filename);
+		let result;
+		worker.once('message', message => { result = message; });
+		worker.once('error', reject);
+		worker.once('exit', () => resolve(result));
+	}));
+	for (const result of await Promise.all(workers)) {
+		if (result !== hash) fail('worker hash ' + result);
+	}
+	const result = multiHashing.randomx(input, seed, 0).toString('hex');
+	if (result !== hash) fail('hash ' + result);
+	multiHashing.release('randomx');
+}
+
+async function main() {
+	// A profile of this CPU with huge pages JIT on, VMs created from then on use it
+	const dir     = fs.mkdtempSync(path.join(os.tmpdir(), 'huge-jit-'));
+	const profile = path.join(dir, 'profile');
+	multiHashing.tune(profile);
+	fs.writeFileSync(profile, fs.readFileSync(profile, 'utf8').replace(/^rx_huge_pages_jit .*$/m, 'rx_huge_pages_jit 1'));
+	const tuned = multiHashing.tune(profile);
+	fs.rmSync(dir, { recursive: true });
+	if (!tuned.loaded || !tuned.randomx_huge_pages_jit) fail(JSON.stringify(tuned));
+
+	await round();
+	const first = usage();
+	for (let i = 0; i < 4; ++i) await round();
+	const last = usage();
+	if (first !== last) fail(first + ' after the first round, ' + last + ' after five');
+	console.log('Huge pages JIT test passed (' + last + ')');
+}
+
+main().catch(e => fail(e));
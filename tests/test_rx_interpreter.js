@@ -0,0 +1,54 @@
+"use strict";
+const fs = require('fs');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('RandomX interpreter ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+// Known hashes of the test vector files, then random inputs of every variant hashed by the JIT first
+const vectors = [];
+for (const [ file, algo ] of [ [ 'rx0.txt', 0 ], [ 'rx_arq.txt', 2 ], [ 'rx_keva.txt', 19 ], [ 'rx_graft.txt', 20 ] ]) {
+	for (const line of fs.readFileSync(file, 'utf8').split('\n').filter(line => line.length)) {
+		const fields = line.split(' ');
+		vectors.push({ algo: algo, seed: Buffer.from(fields[1]), input: Buffer.from(fields.slice(2).join(' ')), hash: fields[0] });
+	}
+}
+for (const algo of [ 0, 2, 17, 19, 20 ]) {
+	const seed = Buffer.from('0000000000000000000000000000000000000000000000000000000000000000', 'hex');
+	for (let i = 0; i < 3; ++i) {
+		const input = Buffer.alloc(76 + i * 13);
+		for (let j = 0; j < input.length; ++j) input[j] = (j * 131 + i * 7 + algo) & 255;
+		vectors.push({ algo: algo, seed: seed, input: input, hash: multiHashing.randomx(input, seed, algo).toString('hex') });
+	}
+}
+
+check('default', multiHashing.randomx_jit() === true, 'JIT is off by default');
+check('previous', multiHashing.randomx_jit(false) === true, 'previous setting not returned');
+check('current', multiHashing.randomx_jit() === false, 'setting not kept');
+try {
+	multiHashing.randomx_jit(1);
+	check('bad argument', false, 'no exception');
+} catch (e) {}
+
+// The VMs created with the JIT have to go before the interpreter is used
+multiHashing.release('randomx');
+for (const vector of vectors) {
+	const result = multiHashing.randomx(vector.input, vector.seed, vector.algo).toString('hex');
+	check('algo ' + vector.algo, result === vector.hash, "'" + vector.input.toString('hex') + "': " + result + ' instead of ' + vector.hash);
+}
+
+multiHashing.randomx_jit(true);
+multiHashing.release('randomx');
+check('JIT again', multiHashing.randomx(vectors[0].input, vectors[0].seed, vectors[0].algo).toString('hex') === vectors[0].hash, 'wrong hash');
+
+if (failed) {
+	console.log(failed + ' tests failed on: RandomX interpreter');
+	process.exit(1);
+} else {
+	console.log(vectors.length + ' tests passed on: RandomX interpreter');
+}
@@ -0,0 +1,94 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('Scan ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+const seed_hash = Buffer.from('1b7d5a95878b2d38be374cf3476bd07f5ea83adf2e8ca3f34aca49009af7f498', 'hex');
+const all = Buffer.alloc(32, 0xff);
+
+function with_nonce(nonce) {
+	const input = Buffer.from(blob);
+	input.writeUInt32LE(nonce, 39);
+	return input;
+}
+
+// Every nonce of the range matches the full boundary, each hash is the one of the single hash function
+async function compare(name, family, start, count, threads, options, single) {
+	const results = await multiHashing.scan(family, blob, 39, start, count, all, threads, options);
+	check(name + ' count', results.length === count, results.length);
+	results.forEach(function(result, i) {
+		check(name + ' nonce', result.nonce === start + i, result.nonce);
+		const expected = single(with_nonce(result.nonce)).toString('hex');
+		check(name + ' hash', result.hash.toString('hex') === expected, result.nonce + ': ' + result.hash.toString('hex') + ' != ' + expected);
+	});
+}
+
+async function main() {
+	// Odd counts also cover the single hash after the pairs of the 2-way kernels
+	await compare('cryptonight', 'cryptonight', 100, 9, 2, { algo: 8 }, input => multiHashing.cryptonight(input, 8));
+	await compare('cryptonight r', 'cryptonight', 0, 5, 1, { algo: 13, height: 1806260 }, input => multiHashing.cryptonight(input, 13, 1806260));
+	await compare('cryptonight_pico', 'cryptonight_pico', 0xFFFFFFF0, 16, 3, undefined, input => multiHashing.cryptonight_pico(input, 0));
+	await compare('argon2', 'argon2', 7, 3, 2, { algo: 2 }, input => multiHashing.argon2(input, 2));
+	await compare('k12', 'k12', 0, 130, 2, undefined, input => multiHashing.k12(input));
+	await compare('randomx', 'randomx', 1000, 7, 2, { seed_hash: seed_hash }, input => multiHashing.randomx(input, seed_hash, 0));
+
+	// Only hashes meeting the target come back, in the order of their nonces
+	const target = 0x4000000000000000n;
+	const filtered = await multiHashing.scan('cryptonight_pico', blob, 39, 0, 64, target, 2);
+	const expected = [];
+	for (let nonce = 0; nonce < 64; ++nonce) {
+		if (multiHashing.cryptonight_pico(with_nonce(nonce), 0).readBigUInt64LE(24) < target) expected.push(nonce);
+	}
+	check('target', JSON.stringify(filtered.map(result => result.nonce)) === JSON.stringify(expected), JSON.stringify(filtered.map(result => result.nonce)) + ' != ' + JSON.stringify(expected));
+	check('empty', (await multiHashing.scan('k12', blob, 39, 0, 0, all)).length === 0, 'results for an empty range');
+
+	const bad = [
+		[ 'sha256', blob, 39, 0, 1, all ],
+		[ 'k12', blob, blob.length - 3, 0, 1, all ],
+		[ 'k12', blob, 39, 0xFFFFFFFF, 2, all ],
+		[ 'randomx', blob, 39, 0, 1, all ],
+		[ 'k12', blob, 39, 0, 1, 'a' ],
+		[ 'k12', blob, 39, 0, 1, all, 0 ],
+	];
+	for (const args of bad) {
+		try {
+			multiHashing.scan(...args).catch(() => {});
+			check('bad arguments', false, JSON.stringify(args.map(arg => Buffer.isBuffer(arg) ? arg.length : arg)));
+		} catch (e) {}
+	}
+
+	// Thread counts beyond the CPUs are capped
+	check('many threads', (await multiHashing.scan('k12', blob, 39, 0, 64 * 3000, all, 100000)).length === 64 * 3000, 'not all nonces scanned');
+
+	// Timers keep firing while the threads scan
+	let ticks = 0;
+	const timer = setInterval(() => { ++ ticks; }, 5);
+	const started = Date.now();
+	await multiHashing.scan('cryptonight', blob, 39, 0, 64, all, 2, { algo: 8 });
+	const elapsed = Date.now() - started;
+	clearInterval(timer);
+	check('event loop', elapsed < 50 || ticks >= elapsed / 50, ticks + ' ticks in ' + elapsed + ' ms');
+
+	// The RandomX cache of a seed only scanned is the calling isolate's afterwards
+	await multiHashing.scan('randomx', blob, 39, 0, 2, all, 2, { seed_hash: Buffer.alloc(32, 7) });
+	check('cache kept', multiHashing.release('randomx') > 256 * 1024 * 1024, 'cache not held by the isolate');
+
+	if (failed) {
+		console.log(failed + ' tests failed on: scan');
+		process.exit(1);
+	} else {
+		console.log('Scan test passed');
+	}
+}
+
+main().catch(e => {
+	console.log('Scan test failed: ' + e);
+	process.exit(1);
+});
@@ -0,0 +1,73 @@
+"use strict";
+const fs = require('fs');
+const child_process = require('child_process');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+const expected = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const rx = () => multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0).toString('hex');
+const ethash = () => multiHashing.ethash(Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex'), Buffer.from('ff4136b6b6a244ec', 'hex'), 1257006)[1].toString('hex');
+const expected_mix = '47da5e47804594550791c24331163c1f1fde5bc622170e83515843b2b13dbe14';
+
+if (process.argv[2]) {
+	multiHashing.shared_caches(process.argv[2]);
+	const result = { rx: rx(), ethash: ethash() };
+	const timing = multiHashing.randomx_cache_timing(0);
+	result.shared = timing.shared;
+	result.total  = timing.total;
+	console.log(JSON.stringify(result));
+	return;
+}
+
+if (!fs.existsSync('/dev/shm')) {
+	console.log('Shared cache test skipped: no /dev/shm');
+	return;
+}
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (ok)
+		console.log('Shared cache ' + name + ' test passed');
+	else {
+		console.log('Shared cache ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const objects = prefix => fs.readdirSync('/dev/shm').filter(f => f.startsWith(prefix + '-'));
+const run = prefix => JSON.parse(child_process.execFileSync(process.execPath, [__filename, prefix]).toString());
+
+// The first process creates the objects, the next one maps them instead of initialising its own
+const prefix = 'cnhash-test-' + process.pid;
+multiHashing.shared_caches(prefix);
+check('create', rx() === expected && ethash() === expected_mix && multiHashing.randomx_cache_timing(0).shared, rx());
+check('objects', objects(prefix).length === 2, JSON.stringify(objects(prefix)));
+
+const attached = run(prefix);
+check('attach', attached.rx === expected && attached.ethash === expected_mix && attached.shared && attached.total === 0, JSON.stringify(attached));
+
+// Objects go away with the last process using them
+const alone = prefix + '-alone';
+const result = run(alone);
+check('alone', result.rx === expected && result.shared, JSON.stringify(result));
+check('unlink', objects(alone).length === 0, JSON.stringify(objects(alone)));
+
+// Processes starting together share one object per cache, none unlinks it while another is attached
+const together = prefix + '-together';
+Promise.all([ 0, 1, 2, 3 ].map(() => new Promise((resolve, reject) => {
+	child_process.execFile(process.execPath, [__filename, together], (err, stdout) => err ? reject(err) : resolve(JSON.parse(stdout)));
+}))).then(results => {
+	const creators = results.filter(result => result.total > 0).length;
+	check('together', results.every(result => result.rx === expected && result.ethash === expected_mix && result.shared) && creators === 1, JSON.stringify(results));
+	check('together unlink', objects(together).length === 0, JSON.stringify(objects(together)));
+}, err => check('together', false, err.message)).then(() => {
+	if (failed) {
+		console.log(failed + ' tests failed on: shared cache');
+		process.exit(1);
+	}
+});
+
+try {
+	multiHashing.shared_caches('a/b');
+	check('bad prefix', false, 'no exception');
+} catch (e) {}
+multiHashing.shared_caches();
@@ -0,0 +1,69 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('Trim ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const sleep = ms => Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, ms);
+const blob = Buffer.from('This is a test');
+const seed = Buffer.from('12345678901234567890123456789012');
+const rx_expected = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+
+// Nothing is allocated before the first hash
+check('initial', multiHashing.trim() === 0, multiHashing.trim());
+
+// The context grows to the scratchpad of the largest algo hashed so far
+const pico = multiHashing.cryptonight_pico(blob, 0).toString('hex');
+check('pico', multiHashing.trim() === 256 * 1024, 'not the 256 KB of cn-pico');
+check('pico again', multiHashing.cryptonight_pico(blob, 0).toString('hex') === pico, 'hash changed after trim');
+const cn = multiHashing.cryptonight(blob, 0).toString('hex');
+multiHashing.cryptonight_heavy(blob, 0);
+check('heavy', multiHashing.trim() === 4 * 1024 * 1024, 'not the 4 MB of cn-heavy');
+check('cn again', multiHashing.cryptonight(blob, 0).toString('hex') === cn, 'hash changed after trim');
+
+// Recently used state stays
+check('recent', multiHashing.trim(60000) === 0, 'released something used right now');
+
+// RandomX VM scratchpad and cache, then a hash from scratch
+check('randomx', multiHashing.randomx(blob, seed, 0).toString('hex') === rx_expected, 'wrong hash');
+const rx_released = multiHashing.release('randomx', 0);
+check('release randomx', rx_released > 2 * 1024 * 1024, rx_released);
+check('release randomx again', multiHashing.release('randomx') === 0, 'released twice');
+check('randomx again', multiHashing.randomx(blob, seed, 0).toString('hex') === rx_expected, 'wrong hash after release');
+
+const ethash = () => multiHashing.ethash(Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex'), Buffer.from('ff4136b6b6a244ec', 'hex'), 1257006)[1].toString('hex');
+const mix_expected = '47da5e47804594550791c24331163c1f1fde5bc622170e83515843b2b13dbe14';
+check('ethash', ethash() === mix_expected, 'wrong mix hash');
+check('release ethash', multiHashing.release('ethash') > 0, 'light cache not released');
+check('ethash again', ethash() === mix_expected, 'wrong mix hash after release');
+
+// With an idle timeout the next hash releases what was not used since
+check('idle timeout', multiHashing.idle_timeout(200) === 0, 'previous timeout not 0');
+multiHashing.cryptonight(blob, 0);
+sleep(1100);
+multiHashing.randomx(blob, seed, 0);
+check('idle release', multiHashing.release('cryptonight') === 0, 'context not released while idle');
+check('idle timeout reset', multiHashing.idle_timeout() === 200, 'previous timeout not returned');
+
+for (const bad of [ [ 'sha256' ], [ 1 ], [ 'randomx', 'a' ] ]) {
+	try {
+		multiHashing.release(...bad);
+		check('bad release arguments', false, JSON.stringify(bad));
+	} catch (e) {}
+}
+try {
+	multiHashing.trim(-1);
+	check('bad trim argument', false, 'no exception');
+} catch (e) {}
+
+if (failed) {
+	console.log(failed + ' tests failed on: trim');
+	process.exit(1);
+} else {
+	console.log('Trim test passed');
+}
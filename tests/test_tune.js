@@ -0,0 +1,46 @@
+"use strict";
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+const profile = path.join(fs.mkdtempSync(path.join(os.tmpdir(), 'tune-')), 'profile');
+
+function fail(msg) {
+	console.log('tune test failed: ' + msg);
+	process.exit(1);
+}
+
+const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+
+function check_hashes() {
+	const rx = multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0).toString('hex');
+	if (rx !== '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6') fail('randomx ' + rx);
+	const cn = multiHashing.cryptonight(blob, 9).toString('hex');
+	if (cn !== '5d4fbc356097ea6440b0888edeb635ddc84a0e397c868456895c3f29be7312a7') fail('cn/half ' + cn);
+	const ar2 = multiHashing.argon2(blob, 0).toString('hex');
+	if (ar2 !== 'c158a105ae75c7561cfd029083a47a87653d51f914128e21c1971d8b10c49034') fail('argon2 ' + ar2);
+}
+
+try {
+	multiHashing.tune(1);
+	fail('no exception for a bad profile path');
+} catch (e) {}
+
+const tuned = multiHashing.tune(profile);
+if (tuned.loaded || ![0, 1, 2, 3].includes(tuned.randomx_prefetch) || typeof tuned.argon2 !== 'string') fail(JSON.stringify(tuned));
+check_hashes();
+
+// Second start: the profile is applied without benchmarking
+const start = Date.now();
+const loaded = multiHashing.tune(profile);
+const elapsed = Date.now() - start;
+if (!loaded.loaded || loaded.randomx_prefetch !== tuned.randomx_prefetch || loaded.argon2 !== tuned.argon2 || loaded.cn_asm !== tuned.cn_asm) fail(JSON.stringify(loaded));
+check_hashes();
+
+// Profiles of other CPUs are measured again
+fs.writeFileSync(profile, fs.readFileSync(profile, 'utf8').replace(/^cpu .*$/m, 'cpu Some other CPU'));
+if (multiHashing.tune(profile).loaded) fail('profile of another CPU was loaded');
+
+fs.rmSync(path.dirname(profile), { recursive: true });
+console.log('tune test passed (' + JSON.stringify(tuned) + ', profile loaded in ' + elapsed + ' ms)');
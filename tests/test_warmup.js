@@ -0,0 +1,99 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+const async_hooks = require('async_hooks');
+
+let failed = 0;
+function check(name, ok, detail) {
+	if (!ok) {
+		console.log('Warmup ' + name + ' test failed: ' + detail);
+		++ failed;
+	}
+}
+
+const blob = Buffer.from('This is a test');
+const seed = Buffer.from('12345678901234567890123456789012');
+const next_seed = Buffer.alloc(32, 7);
+const rx_expected = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const height = 1257006;
+const ethash = () => multiHashing.ethash(Buffer.from('f5afa3074287b2b33e975468ae613e023e478112530bc19d4187693c13943445', 'hex'), Buffer.from('ff4136b6b6a244ec', 'hex'), height)[1].toString('hex');
+const mix_expected = '47da5e47804594550791c24331163c1f1fde5bc622170e83515843b2b13dbe14';
+
+function timed(fn) {
+	const start = process.hrtime.bigint();
+	const result = fn();
+	return [ result, Number(process.hrtime.bigint() - start) / 1e6 ];
+}
+
+async function main() {
+	const pending = multiHashing.warmup({
+		algos:   [ 'cryptonight_heavy', { family: 'cryptonight', algo: 13 }, { family: 'randomx', algo: 0 }, 'ethash', 'k12' ],
+		seeds:   [ next_seed, seed ],
+		heights: [ height + 30000, height ],
+	});
+	check('promise', pending instanceof Promise, typeof pending);
+	await pending;
+
+	// Nothing left to initialise: the first hashes only hash
+	check('recent', multiHashing.trim(60000) === 0, 'released something just warmed up');
+	const [ rx, rx_ms ] = timed(() => multiHashing.randomx(blob, seed, 0).toString('hex'));
+	check('randomx', rx === rx_expected, 'wrong hash');
+	check('randomx first hash', rx_ms < 200, rx_ms + ' ms');
+	const [ mix, mix_ms ] = timed(ethash);
+	check('ethash', mix === mix_expected, 'wrong mix hash');
+	check('ethash first hash', mix_ms < 200, mix_ms + ' ms');
+	const cn_r = multiHashing.cryptonight(blob, 13, height);
+	const heavy = multiHashing.cryptonight_heavy(blob, 0);
+	check('context', multiHashing.release('cryptonight') === 4 * 1024 * 1024, 'not the 4 MB of cn-heavy');
+	check('cryptonight r', multiHashing.cryptonight(blob, 13, height).equals(cn_r), 'hash changed after warmup');
+	check('cryptonight heavy', multiHashing.cryptonight_heavy(blob, 0).equals(heavy), 'hash changed after warmup');
+
+	// Caches of the other seed and epoch stay for later
+	const [ , next_ms ] = timed(() => multiHashing.randomx(blob, next_seed, 0));
+	check('next seed', next_ms < 200, next_ms + ' ms');
+	check('release randomx', multiHashing.release('randomx') > 256 * 1024 * 1024, 'cache not released');
+	check('release ethash', multiHashing.release('ethash') > 2 * 16 * 1024 * 1024, 'not both light caches released');
+
+	// Warming up on top of existing state keeps it working
+	multiHashing.randomx(blob, seed, 0);
+	await multiHashing.warmup({ algos: [ 'randomx', 'cryptonight_pico' ], seeds: [ seed ] });
+	check('randomx again', multiHashing.randomx(blob, seed, 0).toString('hex') === rx_expected, 'wrong hash after second warmup');
+	check('empty', await multiHashing.warmup({ algos: [] }) === undefined, 'resolved with a value');
+
+	// The promise is settled in the async context of the warmup() call
+	const contexts = new Map();
+	const hook = async_hooks.createHook({
+		init(id, type) { if (type === 'cryptonight-hashing:warmup') contexts.set(id, []); },
+		before(id) { if (contexts.has(id)) contexts.get(id).push('before'); },
+		after(id) { if (contexts.has(id)) contexts.get(id).push('after'); },
+		destroy(id) { if (contexts.has(id)) contexts.get(id).push('destroy'); },
+	}).enable();
+	const storage = new async_hooks.AsyncLocalStorage();
+	const store = await storage.run('warmup', () => multiHashing.warmup({ algos: [ 'k12' ] }).then(() => storage.getStore()));
+	await new Promise(resolve => setTimeout(resolve, 50));
+	hook.disable();
+	check('async local storage', store === 'warmup', store);
+	check('async context', [ ...contexts.values() ].some(events => events.join() === 'before,after,destroy'), JSON.stringify([ ...contexts.values() ]));
+
+	try {
+		await multiHashing.warmup({ algos: [ 'randomx' ] });
+		check('no seeds', false, 'not rejected');
+	} catch (e) {}
+	for (const bad of [ undefined, { algos: 'randomx' }, { algos: [ 'sha256' ] }, { algos: [ 1 ] }, { algos: [], seeds: [ Buffer.alloc(31) ] }, { algos: [], heights: [ -1 ] } ]) {
+		try {
+			multiHashing.warmup(bad);
+			check('bad arguments', false, JSON.stringify(bad));
+		} catch (e) {}
+	}
+}
+
+main().then(function() {
+	if (failed) {
+		console.log(failed + ' tests failed on: warmup');
+		process.exit(1);
+	} else {
+		console.log('Warmup test passed');
+	}
+}, function(e) {
+	console.log('Warmup test failed: ' + e);
+	process.exit(1);
+});
@@ -0,0 +1,59 @@
+"use strict";
+const { Worker, isMainThread, parentPort } = require('worker_threads');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+const WORKERS = 4;
+
+const tests = [
+	[ '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6', () => multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0) ],
+	[ 'dcd9efef9df794171af262df328bd2c16a6d51ae9abdcb9357ce4ab3c0c9a8ba', () => multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('0000000000000000000000000000000000000000000000000000000000000000', 'hex'), 17) ],
+	[ '86cb0f6306d536f373650bd196a5205a0293fba2ead85003d7aee4006afee147', () => multiHashing.randomx(Buffer.from('Lorem ipsum dolor sit amet'), Buffer.from('12345678901234567890123456789012'), 0) ],
+	[ 'b01b212c3daa15fd1cb18f3fb70cc17e3d0185e36cf4b6cd75fb06b3b3a73594', () => multiHashing.k12(Buffer.from('6465206f6d6e69627573206475626974616e64756d', 'hex')) ],
+];
+
+function run() {
+	let failed = 0;
+	for (let i = 0; i < 4; ++ i) {
+		for (const [expected, fn] of tests) {
+			const result = fn().toString('hex');
+			if (result !== expected) {
+				console.error('Expected ' + expected + ', got ' + result);
+				++ failed;
+			}
+		}
+	}
+	return failed;
+}
+
+// Two waves: the second one reuses the RandomX VMs released by the exited workers of the first
+function wave(done) {
+	let finished = 0, failed = 0;
+	for (let i = 0; i < WORKERS; ++ i) {
+		const worker = new Worker(__filename);
+		worker.on('message', function(worker_failed) { failed += worker_failed; });
+		worker.on('error', function(err) {
+			console.log('worker_threads test failed: ' + err);
+			process.exit(1);
+		});
+		worker.on('exit', function() {
+			if (++ finished === WORKERS) done(failed);
+		});
+	}
+}
+
+if (isMainThread) {
+	const failed = run();
+	wave(function(failed1) {
+		wave(function(failed2) {
+			const total = failed + failed1 + failed2 + run();
+			if (total > 0) {
+				console.log(total + ' tests failed on: worker_threads');
+				process.exit(1);
+			} else {
+				console.log('worker_threads test passed');
+			}
+		});
+	});
+} else {
+	parentPort.postMessage(run());
+}
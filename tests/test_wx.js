@@ -0,0 +1,22 @@
+"use strict";
+const fs = require('fs');
+const multiHashing = require('../build/Release/cryptonight-hashing');
+
+// JIT code (RandomX, CryptonightR) runs from memfd mappings that are never writable and executable at once
+multiHashing.randomx(Buffer.from('This is a test'), Buffer.from('12345678901234567890123456789012'), 0);
+multiHashing.cryptonight(Buffer.alloc(76), 13, 1806260);
+
+if (process.platform !== 'linux') {
+	console.log('W^X JIT test skipped');
+	process.exit(0);
+}
+
+const jit = fs.readFileSync('/proc/self/maps', 'utf8').split('\n').filter(line => line.includes('xmrig-jit')).map(line => line.split(/\s+/)[1]);
+const rx = jit.filter(perms => perms === 'r-xs').length;
+const rw = jit.filter(perms => perms === 'rw-s').length;
+
+if (rx === 0 || rx !== rw || rx + rw !== jit.length) {
+	console.log('W^X JIT test failed: ' + jit.join(' '));
+	process.exit(1);
+}
+console.log('W^X JIT test passed');
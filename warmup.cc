@@ -0,0 +1,146 @@
+#include "warmup.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "hashing.h"
+
+// Input of the hashes that generate code and fault in scratchpads, any blob would do
+static const uint8_t WARMUP_BLOB[76] = {};
+
+namespace {
+
+// Initialises shared caches on one thread each. Every thread keeps its references in its own
+// state until the pool is destroyed, so the caches stay alive until the prepared state has them.
+class CachePool {
+public:
+    ~CachePool() {
+        wait();
+    }
+
+    void run(std::function<void()> task) {
+        m_states.emplace_back(new IsolateState());
+        IsolateState* state = m_states.back().get();
+        m_threads.emplace_back([this, state, task]() {
+            isolate_state = state;
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error) m_error = std::current_exception();
+            }
+            isolate_state = nullptr;
+        });
+    }
+
+    void join() {
+        wait();
+        if (m_error) std::rethrow_exception(m_error);
+    }
+
+private:
+    void wait() {
+        for (std::thread& thread : m_threads) thread.join();
+        m_threads.clear();
+    }
+
+    std::vector<std::unique_ptr<IsolateState>> m_states;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::exception_ptr m_error;
+};
+
+// Sets isolate_state of the calling thread for as long as it lives
+class CurrentState {
+public:
+    explicit CurrentState(IsolateState* state) : m_previous(isolate_state) { isolate_state = state; }
+    ~CurrentState() { isolate_state = m_previous; }
+
+private:
+    IsolateState* m_previous;
+};
+
+} // namespace
+
+// Switches to the cache of the next seed or epoch and keeps the one it replaces
+template <typename T, typename F>
+static void keep_previous(std::shared_ptr<T>& current, std::vector<std::shared_ptr<T>>& warm, F next) {
+    const std::shared_ptr<T> previous = current;
+    next();
+    if (previous && previous != current && std::find(warm.begin(), warm.end(), previous) == warm.end()) warm.push_back(previous);
+}
+
+std::unique_ptr<IsolateState> warmup_state(const WarmupJob& job) {
+    bool cn = false, rx = false, ethash = false, etchash = false;
+    for (const WarmupAlgo& item : job.algos) {
+        switch (item.family) {
+            case FAMILY_K12:
+            case FAMILY_KAWPOW:  break;  // nothing to prepare
+            case FAMILY_RANDOMX: rx = true; break;
+            case FAMILY_ETHASH:  ethash = true; break;
+            case FAMILY_ETCHASH: etchash = true; break;
+            default:
+                if (!get_family_fn(item.family, item.algo).fn) throw std::domain_error("Unknown hash family");
+                cn = true;
+        }
+    }
+    if (rx && job.seeds.empty()) throw std::domain_error("RandomX warm-up requires seed hashes");
+    if ((ethash || etchash) && job.heights.empty()) throw std::domain_error("Ethash warm-up requires block heights");
+    const uint64_t height = job.heights.empty() ? 0 : job.heights.back();
+
+    CachePool pool;
+    for (const WarmupAlgo& item : job.algos) {
+        if (item.family == FAMILY_RANDOMX) {
+            const xmrig::Algorithm::Id algo = get_rx_algo(item.algo);
+            for (const std::array<uint8_t, 32>& seed : job.seeds) pool.run([algo, seed]() { rx_get_vm(seed.data(), algo); });
+        }
+    }
+    for (const uint64_t h : job.heights) {
+        if (ethash) pool.run([h]() { get_ethash_cache(static_cast<int>(h)); });
+        if (etchash) pool.run([h]() { get_etchash_cache(static_cast<int>(h)); });
+    }
+
+    std::unique_ptr<IsolateState> state(new IsolateState());
+    CurrentState current(state.get());
+    uint8_t output[64];
+
+    // CryptoNight needs no shared cache: one context of the largest scratchpad, meanwhile
+    if (cn) {
+        size_t memory = 0;
+        for (const WarmupAlgo& item : job.algos) {
+            const CnHashFn fn = get_family_fn(item.family, item.algo);
+            if (fn.fn) memory = std::max(memory, fn.memory);
+        }
+        state->cn_ctx(memory);
+        memset(state->ctx_memory, 0, state->ctx_size);
+        for (const WarmupAlgo& item : job.algos) {
+            const CnHashFn fn = get_family_fn(item.family, item.algo);
+            if (fn.fn) fn(WARMUP_BLOB, sizeof(WARMUP_BLOB), output, height);
+        }
+    }
+
+    pool.join();
+
+    // With the caches there, a VM per variant switched through all seeds, its code compiled by a hash
+    for (const WarmupAlgo& item : job.algos) {
+        if (item.family != FAMILY_RANDOMX) continue;
+        const xmrig::Algorithm::Id algo = get_rx_algo(item.algo);
+        const int rxid = rx2id(algo);
+        for (const std::array<uint8_t, 32>& seed : job.seeds) {
+            keep_previous(state->rx_cache[rxid], state->rx_warm[rxid], [&seed, algo]() { rx_get_vm(seed.data(), algo); });
+        }
+        memset(state->rx_scratchpad(), 0, RANDOMX_SCRATCHPAD_L3_MAX_SIZE);
+        rx_calculate_hash(job.seeds.back().data(), algo, WARMUP_BLOB, sizeof(WARMUP_BLOB), output);
+    }
+    for (const uint64_t h : job.heights) {
+        if (ethash) keep_previous(state->ethash_cache, state->ethash_warm, [h]() { get_ethash_cache(static_cast<int>(h)); });
+        if (etchash) keep_previous(state->etchash_cache, state->etchash_warm, [h]() { get_etchash_cache(static_cast<int>(h)); });
+    }
+
+    return state;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Start-up warm-up: pays the one-time costs of the first hash of each algo (RandomX caches and
+// VMs with their JIT code, ethash light caches, CryptoNight R programs, scratchpad page faults)
+// ahead of time. Shared caches are initialised in parallel on helper threads, the scratch state
+// is prepared in a separate IsolateState the calling isolate adopts once it is done.
+
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+struct IsolateState;
+
+struct WarmupAlgo {
+    int family = 0;  // HashFamily
+    int algo   = 0;  // algo number of the JS API within the family
+};
+
+struct WarmupJob {
+    std::vector<WarmupAlgo> algos;
+    std::vector<std::array<uint8_t, 32>> seeds;  // RandomX seed hashes, the last one is current
+    std::vector<uint64_t> heights;               // ethash epochs and CryptoNight R programs, the last one is current
+};
+
+// Blocks until everything is ready, errors are rethrown once all threads stopped
+std::unique_ptr<IsolateState> warmup_state(const WarmupJob& job);
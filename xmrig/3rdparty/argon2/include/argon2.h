@@ -439,6 +439,10 @@ ARGON2_PUBLIC size_t argon2_encodedlen(uint32_t t_cost, uint32_t m_cost,
  * string
  */
 ARGON2_PUBLIC void argon2_select_impl();
+/**
+ * Selects the most capable implementation the CPU supports, without benchmarking.
+ */
+ARGON2_PUBLIC void argon2_select_impl_by_features();
 ARGON2_PUBLIC const char *argon2_get_impl_name();
 ARGON2_PUBLIC int argon2_select_impl_by_name(const char *name);
 
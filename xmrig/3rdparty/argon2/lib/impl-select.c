@@ -86,6 +86,24 @@ void argon2_select_impl()
 }
 
 
+void argon2_select_impl_by_features()
+{
+    argon2_impl_list impls;
+    argon2_get_impl_list(&impls);
+
+    /* the list goes from the most portable to the most capable implementation: */
+    for (uint32_t i = impls.count; i > 0; i--) {
+        const argon2_impl *impl = &impls.entries[i - 1];
+
+        if (impl->check == NULL || impl->check()) {
+            selected_argon_impl = *impl;
+
+            return;
+        }
+    }
+}
+
+
 void xmrig_ar2_fill_segment(const argon2_instance_t *instance, argon2_position_t position)
 {
     selected_argon_impl.fill_segment(instance, position);
@@ -107,6 +125,10 @@ int argon2_select_impl_by_name(const char *name)
         const argon2_impl *impl = &impls.entries[i];
 
         if (strcasecmp(impl->name, name) == 0) {
+            if (impl->check != NULL && !impl->check()) {
+                return 0;
+            }
+
             selected_argon_impl = *impl;
 
             return 1;
@@ -32,15 +32,30 @@ int Equihash<N,K>::InitialiseState(eh_HashState& base_state, const char* persona
 {
     uint32_t le_N = htole32(N);
     uint32_t le_K = htole32(K);
-    unsigned char personalization[crypto_generichash_blake2b_PERSONALBYTES] = {};
-    memcpy(personalization, personalizationString, 8);
-    memcpy(personalization+8,  &le_N, 4);
-    memcpy(personalization+12, &le_K, 4);
-    return crypto_generichash_blake2b_init_salt_personal(&base_state,
-                                                         NULL, 0, // No key.
-                                                         (512/N)*((N+7)/8),
-                                                         NULL,    // No salt.
-                                                         personalization);
+    blake2b_param P;
+    memset(&P, 0, sizeof(P));
+    P.digest_length = (512/N)*((N+7)/8);
+    P.fanout = 1;
+    P.depth = 1;
+    memcpy(P.personal, personalizationString, 8);
+    memcpy(P.personal+8,  &le_N, 4);
+    memcpy(P.personal+12, &le_K, 4);
+    return rx_blake2b_init_param(&base_state, &P);
+}
+
+// Hashes of the indices g[0..count), each base_state updated with one index, in parallel lanes
+void GenerateHashes(const eh_HashState& base_state, const eh_index* g, size_t count,
+                    unsigned char* hashes, size_t hLen)
+{
+    std::vector<eh_index> lei(count);
+    std::vector<const void*> in(count);
+    std::vector<void*> out(count);
+    for (size_t i = 0; i < count; i++) {
+        lei[i] = htole32(g[i]);
+        in[i] = &lei[i];
+        out[i] = hashes + i*hLen;
+    }
+    rx_blake2b_final_multi(&base_state, out.data(), in.data(), sizeof(eh_index), count);
 }
 
 void GenerateHash(const eh_HashState& base_state, eh_index g,
@@ -50,25 +65,21 @@ void GenerateHash(const eh_HashState& base_state, eh_index g,
 	    eh_HashState state;
 	    state = base_state;
 	    eh_index lei = htole32(g);
-	    crypto_generichash_blake2b_update(&state, (const unsigned char*) &lei,
-		                              sizeof(eh_index));
-	    crypto_generichash_blake2b_final(&state, hash, hLen);
+	    rx_blake2b_update(&state, (const unsigned char*) &lei,
+		              sizeof(eh_index));
+	    rx_blake2b_final(&state, hash, hLen);
     } else {
 	    uint32_t myHash[16] = {0};
 	    uint32_t startIndex = g & 0xFFFFFFF0;
 
-	    for (uint32_t g2 = startIndex; g2 <= g; g2++) {
-		    uint32_t tmpHash[16] = {0};
-
-		    eh_HashState state;
-		    state = base_state;
-		    eh_index lei = htole32(g2);
-		    crypto_generichash_blake2b_update(&state, (const unsigned char*) &lei,
-				                      sizeof(eh_index));
+	    // All the summed hashes are computed in one multi-buffer pass
+	    eh_index indices[16];
+	    uint32_t tmpHash[16][16] = {{0}};
+	    for (uint32_t g2 = startIndex; g2 <= g; g2++) indices[g2 - startIndex] = g2;
+	    GenerateHashes(base_state, indices, g - startIndex + 1, (unsigned char*)&tmpHash[0][0], sizeof(tmpHash[0]));
 
-		    crypto_generichash_blake2b_final(&state, (unsigned char*)&tmpHash[0], hLen);
-
-		    for (uint32_t idx = 0; idx < 16; idx++) myHash[idx] += tmpHash[idx];
+	    for (uint32_t g2 = startIndex; g2 <= g; g2++) {
+		    for (uint32_t idx = 0; idx < 16; idx++) myHash[idx] += tmpHash[g2 - startIndex][idx];
 	    }
 
 	    uint8_t * hashBytes = (uint8_t *) &myHash[0];
@@ -740,10 +751,21 @@ bool Equihash<N,K>::IsValidSolution(const eh_HashState& base_state, std::vector<
 
     std::vector<FullStepRow<FinalFullWidth>> X;
     X.reserve(1 << K);
-    unsigned char tmpHash[HashOutput];
-    for (eh_index i : GetIndicesFromMinimal(soln, CollisionBitLength)) {
-        GenerateHash(base_state, i/IndicesPerHashOutput, tmpHash, HashOutput, twist);
-        X.emplace_back(tmpHash+((i % IndicesPerHashOutput) * ((N+7)/8)),
+    std::vector<eh_index> indices = GetIndicesFromMinimal(soln, CollisionBitLength);
+    std::vector<unsigned char> hashes(indices.size() * HashOutput);
+    if (twist) {
+        for (size_t n = 0; n < indices.size(); n++) {
+            GenerateHash(base_state, indices[n]/IndicesPerHashOutput, &hashes[n * HashOutput], HashOutput, twist);
+        }
+    } else {
+        // Leaf hashes of the whole solution in one multi-buffer pass
+        std::vector<eh_index> g(indices.size());
+        for (size_t n = 0; n < indices.size(); n++) g[n] = indices[n]/IndicesPerHashOutput;
+        GenerateHashes(base_state, g.data(), g.size(), hashes.data(), HashOutput);
+    }
+    for (size_t n = 0; n < indices.size(); n++) {
+        eh_index i = indices[n];
+        X.emplace_back(&hashes[n * HashOutput]+((i % IndicesPerHashOutput) * ((N+7)/8)),
                        ((N+7)/8), HashLength, CollisionBitLength, i);
     }
 
@@ -11,7 +11,7 @@
 #include "../utils/sha256c2.h"
 #include "../utils/utilstrencodings.h"
 
-#include "sodium.h"
+#include "crypto/randomx/blake2/blake2.h"
 
 #include <cstring>
 #include <exception>
@@ -25,7 +25,7 @@
 
 using namespace std;
 
-typedef crypto_generichash_blake2b_state eh_HashState;
+typedef blake2b_state eh_HashState;
 typedef uint32_t eh_index;
 typedef uint8_t eh_trunc;
 
@@ -76,6 +76,21 @@ typedef struct ethash_return_value {
  *                       ERRNOMEM or invalid parameters used for @ref ethash_compute_cache_nodes()
  */
 ethash_light_t ethash_light_new(uint64_t block_number, uint64_t epoch_seed, uint64_t epoch);
+/**
+ * Create an ethash_light handler over cache nodes computed by the caller, e.g. in memory
+ * shared between processes. The memory is not freed by @ref ethash_light_delete()
+ *
+ * @param block_number   The block number for which to create the handler
+ * @param epoch          The epoch of the block
+ * @param cache          Cache nodes computed by @ref ethash_compute_cache_nodes()
+ * @param cache_size     Size of the cache, @ref ethash_get_cachesize() of the epoch
+ * @return               Newly allocated ethash_light handler or NULL in case of ERRNOMEM
+ */
+ethash_light_t ethash_light_new_external(uint64_t block_number, uint64_t epoch, void* cache, uint64_t cache_size);
+/**
+ * Size in bytes of the light cache of an epoch
+ */
+uint64_t ethash_get_cachesize(uint64_t const epoch);
 /**
  */
 bool ethash_compute_cache_nodes(
@@ -102,6 +117,21 @@ ethash_return_value_t ethash_light_compute(
 	uint64_t nonce
 );
 
+/**
+ * Calculate the final hash from a submitted mix hash without touching the cache
+ *
+ * @param return_hash    The resulting hash, to be compared against the boundary
+ * @param header_hash    The header hash to pack into the mix
+ * @param nonce          The nonce to pack into the mix
+ * @param mix_hash       The mix digest hash
+ */
+void ethash_quick_hash(
+	ethash_h256_t* return_hash,
+	ethash_h256_t const* header_hash,
+	const uint64_t nonce,
+	ethash_h256_t const* mix_hash
+);
+
 /**
  * Allocate and initialize a new ethash_full handler
  *
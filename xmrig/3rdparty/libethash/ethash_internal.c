@@ -157,6 +157,26 @@ static inline uint32_t fast_mod(uint64_t a, uint64_t d, uint64_t r, uint64_t i,
 	return a - q * d;
 }
 
+// Same as KPCache::calculate_fast_mod_data, for the lights created here
+static void ethash_light_init_fast_mod(struct ethash_light* light)
+{
+	const uint32_t divisor = (uint32_t)(light->cache_size / sizeof(node));
+	light->num_parent_nodes = divisor;
+	if ((divisor & (divisor - 1)) == 0) {
+		light->reciprocal = 1;
+		light->increment = 0;
+		light->shift = 31U - __builtin_clz(divisor);
+	}
+	else {
+		light->shift = 63U - __builtin_clz(divisor);
+		const uint64_t N = 1ULL << light->shift;
+		const uint64_t q = N / divisor;
+		const uint64_t r = N - q * divisor;
+		light->reciprocal = (uint32_t)(r * 2 < divisor ? q : q + 1);
+		light->increment = r * 2 < divisor ? 1 : 0;
+	}
+}
+
 void ethash_calculate_dag_item_opt(
 	node* const ret,
 	uint32_t node_index,
@@ -216,6 +236,58 @@ void ethash_calculate_dag_item4_opt(
 	}
 }
 
+// The MIX_NODES (2) consecutive items of one access, interleaved so the parent loads of both
+// items are in flight together
+void ethash_calculate_dag_item2_opt(
+	node* ret,
+	uint32_t node_index,
+	uint32_t num_parents,
+	ethash_light_t const light
+)
+{
+	node const* cache_nodes = (node const*)light->cache;
+
+	for (uint32_t j = 0; j < 2; ++j) {
+		node const* init = &cache_nodes[fast_mod(node_index + j, light->num_parent_nodes, light->reciprocal, light->increment, light->shift)];
+		memcpy(ret + j, init, sizeof(node));
+		ret[j].words[0] ^= node_index + j;
+		SHA3_512(ret[j].bytes, ret[j].bytes, sizeof(node));
+	}
+
+#ifdef __AVX2__
+	const __m256i fnv_prime = _mm256_set1_epi32(FNV_PRIME);
+	__m256i a0 = _mm256_loadu_si256((const __m256i*)ret[0].words);
+	__m256i a1 = _mm256_loadu_si256((const __m256i*)(ret[0].words + 8));
+	__m256i b0 = _mm256_loadu_si256((const __m256i*)ret[1].words);
+	__m256i b1 = _mm256_loadu_si256((const __m256i*)(ret[1].words + 8));
+#endif
+
+	for (uint32_t i = 0; i != num_parents; ++i) {
+		const uint32_t w = i % NODE_WORDS;
+		node const* parent0 = &cache_nodes[fast_mod(fnv_hash(node_index ^ i, ret[0].words[w]), light->num_parent_nodes, light->reciprocal, light->increment, light->shift)];
+		node const* parent1 = &cache_nodes[fast_mod(fnv_hash((node_index + 1) ^ i, ret[1].words[w]), light->num_parent_nodes, light->reciprocal, light->increment, light->shift)];
+
+#ifdef __AVX2__
+		a0 = _mm256_xor_si256(_mm256_mullo_epi32(a0, fnv_prime), _mm256_loadu_si256((const __m256i*)parent0->words));
+		a1 = _mm256_xor_si256(_mm256_mullo_epi32(a1, fnv_prime), _mm256_loadu_si256((const __m256i*)(parent0->words + 8)));
+		b0 = _mm256_xor_si256(_mm256_mullo_epi32(b0, fnv_prime), _mm256_loadu_si256((const __m256i*)parent1->words));
+		b1 = _mm256_xor_si256(_mm256_mullo_epi32(b1, fnv_prime), _mm256_loadu_si256((const __m256i*)(parent1->words + 8)));
+
+		// have to write to ret as values are used to compute index
+		_mm256_storeu_si256((__m256i*)ret[0].words, a0);
+		_mm256_storeu_si256((__m256i*)(ret[0].words + 8), a1);
+		_mm256_storeu_si256((__m256i*)ret[1].words, b0);
+		_mm256_storeu_si256((__m256i*)(ret[1].words + 8), b1);
+#else
+		for (unsigned k = 0; k != NODE_WORDS; ++k) ret[0].words[k] = fnv_hash(ret[0].words[k], parent0->words[k]);
+		for (unsigned k = 0; k != NODE_WORDS; ++k) ret[1].words[k] = fnv_hash(ret[1].words[k], parent1->words[k]);
+#endif
+	}
+
+	SHA3_512(ret[0].bytes, ret[0].bytes, sizeof(node));
+	SHA3_512(ret[1].bytes, ret[1].bytes, sizeof(node));
+}
+
 bool ethash_compute_full_data(
 	void* mem,
 	uint64_t full_size,
@@ -279,15 +351,14 @@ static bool ethash_hash(
 	for (unsigned i = 0; i != ETHASH_ACCESSES; ++i) {
 		uint32_t const index = fnv_hash(s_mix->words[0] ^ i, mix->words[i % MIX_WORDS]) % num_full_pages;
 
+		// Light mode computes both items of the access at once
+		node tmp_nodes[MIX_NODES];
+		if (!full_nodes) {
+			ethash_calculate_dag_item2_opt(tmp_nodes, index * MIX_NODES, ETHASH_DATASET_PARENTS, light);
+		}
+
 		for (unsigned n = 0; n != MIX_NODES; ++n) {
-			node const* dag_node;
-			node tmp_node;
-			if (full_nodes) {
-				dag_node = &full_nodes[MIX_NODES * index + n];
-			} else {
-				ethash_calculate_dag_item(&tmp_node, index * MIX_NODES + n, ETHASH_DATASET_PARENTS, light);
-				dag_node = &tmp_node;
-			}
+			node const* dag_node = full_nodes ? &full_nodes[MIX_NODES * index + n] : &tmp_nodes[n];
 
 #if defined(_M_X64) && ENABLE_SSE
 			{
@@ -381,6 +452,7 @@ ethash_light_t ethash_light_new_internal(uint64_t cache_size, ethash_h256_t cons
 		goto fail_free_cache_mem;
 	}
 	ret->cache_size = cache_size;
+	ethash_light_init_fast_mod(ret);
 	return ret;
 
 fail_free_cache_mem:
@@ -400,9 +472,25 @@ ethash_light_t ethash_light_new(uint64_t block_number, uint64_t epoch_seed, uint
         return ret;
 }
 
+ethash_light_t ethash_light_new_external(uint64_t block_number, uint64_t epoch, void* cache, uint64_t cache_size)
+{
+	struct ethash_light *ret;
+	ret = (struct ethash_light*)calloc(sizeof(*ret), 1);
+	if (!ret) {
+		return NULL;
+	}
+	ret->cache = cache;
+	ret->cache_size = cache_size;
+	ret->block_number = block_number;
+	ret->epoch = epoch;
+	ret->external_cache = true;
+	ethash_light_init_fast_mod(ret);
+	return ret;
+}
+
 void ethash_light_delete(ethash_light_t light)
 {
-	if (light->cache) {
+	if (light->cache && !light->external_cache) {
 		free(light->cache);
 	}
 	free(light);
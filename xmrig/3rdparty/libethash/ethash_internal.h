@@ -82,6 +82,7 @@ struct ethash_light {
 	uint64_t cache_size;
 	uint64_t block_number;
         uint64_t epoch;
+	bool external_cache; // cache memory is owned by the caller
 
 	// Used for fast division
 	uint32_t num_parent_nodes;
@@ -169,6 +170,13 @@ void ethash_calculate_dag_item4_opt(
 	ethash_light_t const cache
 );
 
+void ethash_calculate_dag_item2_opt(
+	node* ret,
+	uint32_t node_index,
+	uint32_t num_parents,
+	ethash_light_t const cache
+);
+
 void ethash_quick_hash(
 	ethash_h256_t* return_hash,
 	ethash_h256_t const* header_hash,
@@ -33,7 +33,9 @@ void xmrig::CnCtx::create(cryptonight_ctx **ctx, uint8_t *memory, size_t size, s
         auto *c     = static_cast<cryptonight_ctx *>(_mm_malloc(sizeof(cryptonight_ctx), 4096));
         c->memory   = memory + (i * size);
 
-        c->generated_code              = reinterpret_cast<cn_mainloop_fun_ms_abi>(VirtualMemory::allocateExecutableMemory(0x4000, false));
+        void *rw                       = nullptr;
+        c->generated_code              = reinterpret_cast<cn_mainloop_fun_ms_abi>(VirtualMemory::allocateDualMappedMemory(0x4000, false, &rw, &c->generated_code_size));
+        c->generated_code_rw           = static_cast<uint8_t *>(rw);
         c->generated_code_data.algo    = Algorithm::INVALID;
         c->generated_code_data.height  = std::numeric_limits<uint64_t>::max();
 
@@ -49,6 +51,7 @@ void xmrig::CnCtx::release(cryptonight_ctx **ctx, size_t count)
     }
 
     for (size_t i = 0; i < count; ++i) {
+        VirtualMemory::freeDualMappedMemory(reinterpret_cast<void*>(ctx[i]->generated_code), ctx[i]->generated_code_rw, ctx[i]->generated_code_size);
         _mm_free(ctx[i]);
     }
 }
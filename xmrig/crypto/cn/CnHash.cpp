@@ -123,6 +123,10 @@ cn_mainloop_fun        cn_gr4_quad_mainloop_asm                   = nullptr;
 cn_mainloop_fun        cn_gr5_quad_mainloop_asm                   = nullptr;
 
 
+// Distance from the executable to the writable view of the patched code
+static ptrdiff_t patchWriteOffset = 0;
+
+
 template<Algorithm::Id SOURCE_ALGO = Algorithm::CN_2, typename T, typename U>
 static void patchCode(T dst, U src, const uint32_t iterations, const uint32_t mask = CnAlgo<Algorithm::CN_HALF>().mask())
 {
@@ -142,9 +146,9 @@ static void patchCode(T dst, U src, const uint32_t iterations, const uint32_t ma
 
     size += sizeof(uint32_t);
 
-    memcpy((void*) dst, (const void*) src, size);
+    auto patched_data = reinterpret_cast<uint8_t*>(dst) + patchWriteOffset;
+    memcpy(patched_data, (const void*) src, size);
 
-    auto patched_data = reinterpret_cast<uint8_t*>(dst);
     for (size_t i = 0; i + sizeof(uint32_t) <= size; ++i) {
         switch (*(uint32_t*)(patched_data + i)) {
         case CnAlgo<SOURCE_ALGO>().iterations():
@@ -162,7 +166,10 @@ static void patchCode(T dst, U src, const uint32_t iterations, const uint32_t ma
 static void patchAsmVariants()
 {
     constexpr size_t allocation_size = 0x20000;
-    auto base = static_cast<uint8_t *>(VirtualMemory::allocateExecutableMemory(allocation_size, false));
+    void *rw      = nullptr;
+    size_t mapped = 0;
+    auto base     = static_cast<uint8_t *>(VirtualMemory::allocateDualMappedMemory(allocation_size, false, &rw, &mapped));
+    patchWriteOffset = static_cast<uint8_t *>(rw) - base;
 
     cn_half_mainloop_ivybridge_asm              = reinterpret_cast<cn_mainloop_fun>         (base + 0x0000);
     cn_half_mainloop_ryzen_asm                  = reinterpret_cast<cn_mainloop_fun>         (base + 0x1000);
@@ -303,7 +310,9 @@ static void patchAsmVariants()
     patchCode<Algorithm::CN_1>(cn_gr5_quad_mainloop_asm, cnv1_quad_mainloop_asm, CnAlgo<Algorithm::CN_GR_5>().iterations(), CnAlgo<Algorithm::CN_GR_5>().mask());
 #   endif
 
-    VirtualMemory::protectRX(base, allocation_size);
+    if (rw == base) {
+        VirtualMemory::protectRX(base, allocation_size);
+    }
     VirtualMemory::flushInstructionCache(base, allocation_size);
 }
 } // namespace xmrig
@@ -63,6 +63,9 @@ struct cryptonight_ctx {
 
     alignas(16) uint8_t save_state[128];
     bool first_half;
+
+    uint8_t *generated_code_rw;  // writable view of generated_code
+    size_t generated_code_size;  // length of both views
 };
 
 
@@ -713,7 +713,7 @@ inline void cryptonight_single_hash(const uint8_t *__restrict__ input, size_t si
             const int code_size = v4_random_math_init<ALGO>(code, height);
 
             if (ALGO == Algorithm::CN_R) {
-                v4_soft_aes_compile_code(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), Assembly::NONE);
+                v4_soft_aes_compile_code(code, code_size, ctx[0]->generated_code_rw, Assembly::NONE);
             }
 
             ctx[0]->generated_code_data = { ALGO, height };
@@ -874,6 +874,16 @@ template<size_t ITER, uint32_t MASK>
 void cn_gpu_inner_ssse3(const uint8_t *spad, uint8_t *lpad);
 
 
+#ifdef HAVE_AVX512F
+template<size_t ITER, uint32_t MASK>
+void cn_gpu_inner_avx512(const uint8_t *spad, uint8_t *lpad);
+
+
+template<size_t MEM>
+void cn_explode_scratchpad_gpu_avx512(const uint8_t *input, uint8_t *output);
+#endif
+
+
 namespace xmrig {
 
 
@@ -911,6 +921,13 @@ inline void cryptonight_single_hash_gpu(const uint8_t *__restrict__ input, size_
     constexpr CnAlgo<ALGO> props;
 
     keccak(input, size, ctx[0]->state);
+
+#   ifdef HAVE_AVX512F
+    const bool avx512 = xmrig::Cpu::info()->has(ICpuInfo::FLAG_AVX512F);
+    if (avx512) {
+        cn_explode_scratchpad_gpu_avx512<props.memory()>(ctx[0]->state, ctx[0]->memory);
+    } else
+#   endif
     cn_explode_scratchpad_gpu<props.memory()>(ctx[0]);
 
 #   ifdef _MSC_VER
@@ -919,6 +936,11 @@ inline void cryptonight_single_hash_gpu(const uint8_t *__restrict__ input, size_
     fesetround(FE_TONEAREST);
 #   endif
 
+#   ifdef HAVE_AVX512F
+    if (avx512) {
+        cn_gpu_inner_avx512<props.iterations(), props.mask()>(ctx[0]->state, ctx[0]->memory);
+    } else
+#   endif
     if (xmrig::Cpu::info()->hasAVX2()) {
         cn_gpu_inner_avx<props.iterations(), props.mask()>(ctx[0]->state, ctx[0]->memory);
     } else {
@@ -1036,7 +1058,7 @@ inline void cryptonight_single_hash_asm(const uint8_t *__restrict__ input, size_
     if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
         V4_Instruction code[256];
         const int code_size = v4_random_math_init<ALGO>(code, height);
-        cn_r_compile_code<ALGO>(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), ASM);
+        cn_r_compile_code<ALGO>(code, code_size, ctx[0]->generated_code_rw, ASM);
 
         ctx[0]->generated_code_data = { ALGO, height };
     }
@@ -1142,7 +1164,7 @@ inline void cryptonight_double_hash_asm(const uint8_t *__restrict__ input, size_
     if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
         V4_Instruction code[256];
         const int code_size = v4_random_math_init<ALGO>(code, height);
-        cn_r_compile_code_double<ALGO>(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), ASM);
+        cn_r_compile_code_double<ALGO>(code, code_size, ctx[0]->generated_code_rw, ASM);
 
         ctx[0]->generated_code_data = { ALGO, height };
     }
@@ -13,6 +13,11 @@
 #include <stdint.h>
 #include "c_blake256.h"
 
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define BLAKE256_SSSE3
+#endif
+
 #define U8TO32(p) \
     (((uint32_t)((p)[0]) << 24) | ((uint32_t)((p)[1]) << 16) |    \
      ((uint32_t)((p)[2]) <<  8) | ((uint32_t)((p)[3])      ))
@@ -50,6 +55,62 @@ static const uint8_t padding[] = {
 };
 
 
+#ifdef BLAKE256_SSSE3
+/* SSSE3 version: the rows v[0..3], v[4..7], v[8..11] and v[12..15] are in one
+   register each, the four column and then the four diagonal G run together */
+#define ROT16(x) _mm_shuffle_epi8((x), _mm_set_epi8(13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2))
+#define ROT8(x)  _mm_shuffle_epi8((x), _mm_set_epi8(12,15,14,13, 8,11,10,9, 4,7,6,5, 0,3,2,1))
+#define ROTN(x,n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+
+/* m[sigma[i][e]] ^ cst[sigma[i][e+1]] of the four G, e = e0, e0+2, e0+4, e0+6 */
+#define MSG(e0,p,q) _mm_set_epi32(                      \
+    (int)(m[sigma[i][e0+6+p]] ^ cst[sigma[i][e0+6+q]]),  \
+    (int)(m[sigma[i][e0+4+p]] ^ cst[sigma[i][e0+4+q]]),  \
+    (int)(m[sigma[i][e0+2+p]] ^ cst[sigma[i][e0+2+q]]),  \
+    (int)(m[sigma[i][e0+p]]   ^ cst[sigma[i][e0+q]]))
+
+#define G4(e0)                                          \
+    a = _mm_add_epi32(_mm_add_epi32(a, MSG(e0, 0, 1)), b); \
+    d = ROT16(_mm_xor_si128(d, a));                     \
+    c = _mm_add_epi32(c, d);                            \
+    b = ROTN(_mm_xor_si128(b, c), 12);                  \
+    a = _mm_add_epi32(_mm_add_epi32(a, MSG(e0, 1, 0)), b); \
+    d = ROT8(_mm_xor_si128(d, a));                      \
+    c = _mm_add_epi32(c, d);                            \
+    b = ROTN(_mm_xor_si128(b, c), 7);
+
+void blake256_compress(state *S, const uint8_t *block) {
+    uint32_t m[16], i;
+    __m128i a, b, c, d;
+    const __m128i s = _mm_loadu_si128((const __m128i *) S->s);
+
+    for (i = 0; i < 16; ++i) m[i] = U8TO32(block + i * 4);
+    a = _mm_loadu_si128((const __m128i *) S->h);
+    b = _mm_loadu_si128((const __m128i *) (S->h + 4));
+    c = _mm_xor_si128(s, _mm_loadu_si128((const __m128i *) cst));
+    d = _mm_loadu_si128((const __m128i *) (cst + 4));
+
+    if (S->nullt == 0) {
+        d = _mm_xor_si128(d, _mm_set_epi32((int) S->t[1], (int) S->t[1], (int) S->t[0], (int) S->t[0]));
+    }
+
+    for (i = 0; i < 14; ++i) {
+        G4(0);
+        /* v[5] v[10] v[15] are lane 0 now */
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+        G4(8);
+        b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+        c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+
+    _mm_storeu_si128((__m128i *) S->h,       _mm_xor_si128(_mm_loadu_si128((const __m128i *) S->h),       _mm_xor_si128(_mm_xor_si128(a, c), s)));
+    _mm_storeu_si128((__m128i *) (S->h + 4), _mm_xor_si128(_mm_loadu_si128((const __m128i *) (S->h + 4)), _mm_xor_si128(_mm_xor_si128(b, d), s)));
+}
+#else
+
 void blake256_compress(state *S, const uint8_t *block) {
     uint32_t v[16], m[16], i;
 
@@ -96,6 +157,7 @@ void blake256_compress(state *S, const uint8_t *block) {
     for (i = 0; i < 16; ++i) S->h[i % 8] ^= v[i];
     for (i = 0; i < 8;  ++i) S->h[i] ^= S->s[i % 4];
 }
+#endif
 
 void blake256_init(state *S) {
     S->h[0] = 0x6A09E667;
@@ -11,6 +11,11 @@
 #include "c_groestl.h"
 #include "groestl_tables.h"
 
+#if defined(__AES__) && defined(__SSSE3__)
+#include <immintrin.h>
+#define GROESTL_AESNI
+#endif
+
 #define P_TYPE 0
 #define Q_TYPE 1
 
@@ -63,6 +68,133 @@ const uint8_t indices_cyclic[15] = {0,1,2,3,4,5,6,7,0,1,2,3,4,5,6};
    y[i+1] = tl;
 
 
+#ifdef GROESTL_AESNI
+/* AES-NI version of the compression function and output transformation.
+   The state is kept as eight rows, P(h+m) in the low and Q(m) in the high
+   8 bytes of each register, so both permutations run in one pass: aesenclast
+   with a zero key is the S-box, preceded by a shuffle that undoes its
+   ShiftRows and applies ShiftBytes. */
+
+/* ShiftBytes of row i (P by i, Q by 1,3,5,7,0,2,4,6 bytes) followed by the
+   inverse of AES ShiftRows */
+static const uint8_t shift_masks[8][16] = {
+  { 0, 14, 11,  7,  4,  1, 15, 12,  9,  5,  2,  8, 13, 10,  6,  3},
+  { 1,  8, 13,  0,  5,  2,  9, 14, 11,  6,  3, 10, 15, 12,  7,  4},
+  { 2, 10, 15,  1,  6,  3, 11,  8, 13,  7,  4, 12,  9, 14,  0,  5},
+  { 3, 12,  9,  2,  7,  4, 13, 10, 15,  0,  5, 14, 11,  8,  1,  6},
+  { 4, 13, 10,  3,  0,  5, 14, 11,  8,  1,  6, 15, 12,  9,  2,  7},
+  { 5, 15, 12,  4,  1,  6,  8, 13, 10,  2,  7,  9, 14, 11,  3,  0},
+  { 6,  9, 14,  5,  2,  7, 10, 15, 12,  3,  0, 11,  8, 13,  4,  1},
+  { 7, 11,  8,  6,  3,  0, 12,  9, 14,  4,  1, 13, 10, 15,  5,  2}
+};
+
+/* 8x8 byte transpose of x[0..3], two 8 byte vectors per register. Turns
+   the columns of a state (its byte order) into rows and back. */
+static inline void transpose(__m128i *x) {
+  const __m128i t0 = _mm_unpacklo_epi8(x[0], _mm_srli_si128(x[0], 8));
+  const __m128i t1 = _mm_unpacklo_epi8(x[1], _mm_srli_si128(x[1], 8));
+  const __m128i t2 = _mm_unpacklo_epi8(x[2], _mm_srli_si128(x[2], 8));
+  const __m128i t3 = _mm_unpacklo_epi8(x[3], _mm_srli_si128(x[3], 8));
+  const __m128i u0 = _mm_unpacklo_epi16(t0, t1);
+  const __m128i u1 = _mm_unpackhi_epi16(t0, t1);
+  const __m128i u2 = _mm_unpacklo_epi16(t2, t3);
+  const __m128i u3 = _mm_unpackhi_epi16(t2, t3);
+  x[0] = _mm_unpacklo_epi32(u0, u2);
+  x[1] = _mm_unpackhi_epi32(u0, u2);
+  x[2] = _mm_unpacklo_epi32(u1, u3);
+  x[3] = _mm_unpackhi_epi32(u1, u3);
+}
+
+/* multiplication by 2 in GF(2^8) */
+static inline __m128i xtime(__m128i x) {
+  const __m128i reduce = _mm_and_si128(_mm_cmplt_epi8(x, _mm_setzero_si128()), _mm_set1_epi8(0x1b));
+  return _mm_xor_si128(_mm_add_epi8(x, x), reduce);
+}
+
+/* ten rounds of P on the low and Q on the high halves of the rows s[0..7] */
+static void PQ512(__m128i *s) {
+  const __m128i ones = _mm_set_epi64x(-1, 0);
+  int r, i;
+
+  for (r = 0; r < ROUNDS512; r++) {
+    const uint64_t rc = 0x7060504030201000ULL ^ (r * 0x0101010101010101ULL);
+    __m128i d2[8], d4[8];
+
+    /* AddRoundConstant */
+    s[0] = _mm_xor_si128(s[0], _mm_set_epi64x(-1, (long long)rc));
+    for (i = 1; i < 7; i++) s[i] = _mm_xor_si128(s[i], ones);
+    s[7] = _mm_xor_si128(s[7], _mm_set_epi64x((long long)~rc, 0));
+
+    /* SubBytes and ShiftBytes */
+    for (i = 0; i < 8; i++) {
+      s[i] = _mm_aesenclast_si128(_mm_shuffle_epi8(s[i], _mm_loadu_si128((const __m128i*)shift_masks[i])), _mm_setzero_si128());
+      d2[i] = xtime(s[i]);
+      d4[i] = xtime(d2[i]);
+    }
+
+    /* MixBytes: row i is the sum of rows i+k times 02 02 03 04 05 03 05 07 */
+    {
+      __m128i y[8];
+      for (i = 0; i < 8; i++) {
+        y[i] = _mm_xor_si128(_mm_xor_si128(d2[i], d2[(i + 1) & 7]), _mm_xor_si128(d2[(i + 2) & 7], s[(i + 2) & 7]));
+        y[i] = _mm_xor_si128(y[i], _mm_xor_si128(d4[(i + 3) & 7], _mm_xor_si128(d4[(i + 4) & 7], s[(i + 4) & 7])));
+        y[i] = _mm_xor_si128(y[i], _mm_xor_si128(d2[(i + 5) & 7], s[(i + 5) & 7]));
+        y[i] = _mm_xor_si128(y[i], _mm_xor_si128(d4[(i + 6) & 7], s[(i + 6) & 7]));
+        y[i] = _mm_xor_si128(y[i], _mm_xor_si128(_mm_xor_si128(d4[(i + 7) & 7], d2[(i + 7) & 7]), s[(i + 7) & 7]));
+      }
+      for (i = 0; i < 8; i++) s[i] = y[i];
+    }
+  }
+}
+
+/* compute compression function h <- P(h+m) + Q(m) + h */
+static void F512(uint32_t *h, const uint32_t *m) {
+  __m128i hr[4], mr[4], s[8];
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    hr[i] = _mm_loadu_si128((const __m128i*)h + i);
+    mr[i] = _mm_loadu_si128((const __m128i*)m + i);
+  }
+  transpose(hr);
+  transpose(mr);
+
+  for (i = 0; i < 4; i++) {
+    const __m128i x = _mm_xor_si128(hr[i], mr[i]);
+    s[2 * i]     = _mm_unpacklo_epi64(x, mr[i]);
+    s[2 * i + 1] = _mm_unpackhi_epi64(x, mr[i]);
+  }
+  PQ512(s);
+
+  for (i = 0; i < 4; i++) {
+    hr[i] = _mm_xor_si128(hr[i], _mm_unpacklo_epi64(s[2 * i], s[2 * i + 1]));
+    hr[i] = _mm_xor_si128(hr[i], _mm_unpackhi_epi64(s[2 * i], s[2 * i + 1]));
+  }
+  transpose(hr);
+  for (i = 0; i < 4; i++) _mm_storeu_si128((__m128i*)h + i, hr[i]);
+}
+
+/* given state h, do h <- P(h)+h, Q runs on a copy and is dropped */
+static void OutputTransformation(groestlHashState *ctx) {
+  __m128i hr[4], s[8];
+  int i;
+
+  for (i = 0; i < 4; i++) hr[i] = _mm_loadu_si128((const __m128i*)ctx->chaining + i);
+  transpose(hr);
+
+  for (i = 0; i < 4; i++) {
+    s[2 * i]     = _mm_unpacklo_epi64(hr[i], hr[i]);
+    s[2 * i + 1] = _mm_unpackhi_epi64(hr[i], hr[i]);
+  }
+  PQ512(s);
+
+  for (i = 0; i < 4; i++) hr[i] = _mm_xor_si128(hr[i], _mm_unpacklo_epi64(s[2 * i], s[2 * i + 1]));
+  transpose(hr);
+  for (i = 0; i < 4; i++) _mm_storeu_si128((__m128i*)ctx->chaining + i, hr[i]);
+}
+
+#else
+
 /* compute one round of P (short variants) */
 static void RND512P(uint8_t *x, uint32_t *y, uint32_t r) {
   uint32_t temp_v1, temp_v2, temp_upper_value, temp_lower_value, temp;
@@ -159,6 +291,8 @@ static void F512(uint32_t *h, const uint32_t *m) {
 }
 
 
+#endif
+
 /* digest up to msglen bytes of input (full blocks only) */
 static void Transform(groestlHashState *ctx,
 	       const uint8_t *input,
@@ -175,6 +309,7 @@ static void Transform(groestlHashState *ctx,
   }
 }
 
+#ifndef GROESTL_AESNI
 /* given state h, do h <- P(h)+h */
 static void OutputTransformation(groestlHashState *ctx) {
   int j;
@@ -201,6 +336,7 @@ static void OutputTransformation(groestlHashState *ctx) {
 	  ctx->chaining[j] ^= temp[j];
 	}									
 }
+#endif
 
 /* initialise context */
 static void Init(groestlHashState* ctx) {
@@ -18,6 +18,11 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define JH_SSE2
+#endif
+
 /*typedef unsigned long long uint64;*/
 typedef uint64_t uint64;
 
@@ -99,6 +104,93 @@ static HashReturn Update(hashState *state, const BitSequence *data, DataLength d
 static HashReturn Final(hashState *state, BitSequence *hashval);
 HashReturn jh_hash(int hashbitlen, const BitSequence *data,DataLength databitlen, BitSequence *hashval);
 
+#ifdef JH_SSE2
+/*SSE2 version of E8: both 64-bit words of a row, x[i][0] and x[i][1], are in one register*/
+
+#define XOR(a,b)     _mm_xor_si128((a),(b))
+#define AND(a,b)     _mm_and_si128((a),(b))
+#define ANDNOT(a,b)  _mm_andnot_si128((a),(b))   /*(~a) & b*/
+#define OR(a,b)      _mm_or_si128((a),(b))
+
+/*the swaps of each 64-bit word, as in the portable version*/
+#define SWAP_BITS(x,mask,n)  (x) = OR(_mm_slli_epi64(AND((x),(mask)),(n)), AND(_mm_srli_epi64((x),(n)),(mask)));
+#define SWAP1(x)   SWAP_BITS(x, _mm_set1_epi8(0x55), 1)
+#define SWAP2(x)   SWAP_BITS(x, _mm_set1_epi8(0x33), 2)
+#define SWAP4(x)   SWAP_BITS(x, _mm_set1_epi8(0x0f), 4)
+#define SWAP8(x)   (x) = OR(_mm_slli_epi16((x), 8), _mm_srli_epi16((x), 8));
+#define SWAP16(x)  (x) = _mm_shufflehi_epi16(_mm_shufflelo_epi16((x), 0xb1), 0xb1);
+#define SWAP32(x)  (x) = _mm_shuffle_epi32((x), 0xb1);
+/*swapping x[i][0] with x[i][1]*/
+#define SWAP64(x)  (x) = _mm_shuffle_epi32((x), 0x4e);
+
+/*The MDS transform*/
+#define L(m0,m1,m2,m3,m4,m5,m6,m7) \
+      (m4) = XOR((m4), (m1));              \
+      (m5) = XOR((m5), (m2));              \
+      (m6) = XOR((m6), XOR((m0), (m3)));   \
+      (m7) = XOR((m7), (m0));              \
+      (m0) = XOR((m0), (m5));              \
+      (m1) = XOR((m1), (m6));              \
+      (m2) = XOR((m2), XOR((m4), (m7)));   \
+      (m3) = XOR((m3), (m4));
+
+/*Two Sboxes are computed in parallel, each Sbox implements S0 and S1, selected by a constant bit*/
+#define SS(m0,m1,m2,m3,m4,m5,m6,m7,cc0,cc1)   \
+      m3  = XOR(m3, ones);                  \
+      m7  = XOR(m7, ones);                  \
+      m0  = XOR(m0, ANDNOT(m2, cc0));       \
+      m4  = XOR(m4, ANDNOT(m6, cc1));       \
+      temp0 = XOR(cc0, AND(m0, m1));        \
+      temp1 = XOR(cc1, AND(m4, m5));        \
+      m0  = XOR(m0, AND(m2, m3));           \
+      m4  = XOR(m4, AND(m6, m7));           \
+      m3  = XOR(m3, ANDNOT(m1, m2));        \
+      m7  = XOR(m7, ANDNOT(m5, m6));        \
+      m1  = XOR(m1, AND(m0, m2));           \
+      m5  = XOR(m5, AND(m4, m6));           \
+      m2  = XOR(m2, ANDNOT(m3, m0));        \
+      m6  = XOR(m6, ANDNOT(m7, m4));        \
+      m0  = XOR(m0, OR(m1, m3));            \
+      m4  = XOR(m4, OR(m5, m7));            \
+      m3  = XOR(m3, AND(m1, m2));           \
+      m7  = XOR(m7, AND(m5, m6));           \
+      m1  = XOR(m1, AND(temp0, m0));        \
+      m5  = XOR(m5, AND(temp1, m4));        \
+      m2  = XOR(m2, temp0);                 \
+      m6  = XOR(m6, temp1);
+
+/*Sbox, MDS and Swapping layers of one round*/
+#define ROUND(r,SWAP) \
+      cc0 = _mm_loadu_si128((const __m128i*)E8_bitslice_roundconstant[r]);     \
+      cc1 = _mm_loadu_si128((const __m128i*)E8_bitslice_roundconstant[r] + 1); \
+      SS(x[0],x[2],x[4],x[6],x[1],x[3],x[5],x[7],cc0,cc1);                     \
+      L(x[0],x[2],x[4],x[6],x[1],x[3],x[5],x[7]);                              \
+      SWAP(x[1]); SWAP(x[3]); SWAP(x[5]); SWAP(x[7]);
+
+/*The bijective function E8, in bitslice form*/
+static void E8(hashState *state)
+{
+      const __m128i ones = _mm_set1_epi32(-1);
+      __m128i x[8], cc0, cc1, temp0, temp1;
+      int i, roundnumber;
+
+      for (i = 0; i < 8; i++) x[i] = _mm_load_si128((const __m128i*)state->x[i]);
+
+      for (roundnumber = 0; roundnumber < 42; roundnumber = roundnumber+7) {
+            ROUND(roundnumber+0, SWAP1);
+            ROUND(roundnumber+1, SWAP2);
+            ROUND(roundnumber+2, SWAP4);
+            ROUND(roundnumber+3, SWAP8);
+            ROUND(roundnumber+4, SWAP16);
+            ROUND(roundnumber+5, SWAP32);
+            ROUND(roundnumber+6, SWAP64);
+      }
+
+      for (i = 0; i < 8; i++) _mm_store_si128((__m128i*)state->x[i], x[i]);
+}
+
+#else
+
 /*swapping bit 2i with bit 2i+1 of 64-bit x*/
 #define SWAP1(x)   (x) = ((((x) & 0x5555555555555555ULL) << 1) | (((x) & 0xaaaaaaaaaaaaaaaaULL) >> 1));
 /*swapping bits 4i||4i+1 with bits 4i+2||4i+3 of 64-bit x*/
@@ -210,6 +302,8 @@ static void E8(hashState *state)
 
 }
 
+#endif
+
 /*The compression function F8 */
 static void F8(hashState *state)
 {
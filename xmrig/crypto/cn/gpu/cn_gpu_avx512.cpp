@@ -0,0 +1,298 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018-2020 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2020 XMRig       <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include "crypto/cn/CnAlgo.h"
+
+
+#ifdef __GNUC__
+#   include <x86intrin.h>
+#else
+#   include <intrin.h>
+#   define __restrict__ __restrict
+#endif
+
+
+// AVX-512F versions of cn_gpu_inner_avx and cn_explode_scratchpad_gpu. The AVX2 kernel computes
+// the 32 bytes at idx0 and the 32 bytes at idx2 one after the other from the same inputs, here
+// both halves share a 512-bit register (128-bit lanes: n0 n1 | n2 n3) and run in one pass.
+
+
+// (x & and_mask) | or_mask
+inline __m512 mask_or(const __m512& x, uint32_t and_mask, uint32_t or_mask)
+{
+    return _mm512_castsi512_ps(_mm512_ternarylogic_epi32(_mm512_castps_si512(x), _mm512_set1_epi32(and_mask), _mm512_set1_epi32(or_mask), 0xEA));
+}
+
+// a in the low, d in the high 128-bit lane
+inline __m512 lanes_ps(float a, float b, float c, float d)
+{
+    return _mm512_setr_ps(a, a, a, a, b, b, b, b, c, c, c, c, d, d, d, d);
+}
+
+inline __m512 fma_break(const __m512& x)
+{
+    // Break the dependency chain by setting the exp to ?????01
+    return mask_or(x, 0xFEFFFFFF, 0x00800000);
+}
+
+// 14
+inline void sub_round(const __m512& n0, const __m512& n1, const __m512& n2, const __m512& n3, const __m512& rnd_c, __m512& n, __m512& d, __m512& c)
+{
+    __m512 nn = _mm512_mul_ps(n0, c);
+    nn = _mm512_mul_ps(_mm512_add_ps(n1, c), _mm512_mul_ps(nn, nn));
+    nn = fma_break(nn);
+    n = _mm512_add_ps(n, nn);
+
+    __m512 dd = _mm512_mul_ps(n2, c);
+    dd = _mm512_mul_ps(_mm512_sub_ps(n3, c), _mm512_mul_ps(dd, dd));
+    dd = fma_break(dd);
+    d = _mm512_add_ps(d, dd);
+
+    //Constant feedback
+    c = _mm512_add_ps(c, rnd_c);
+    c = _mm512_add_ps(c, _mm512_set1_ps(0.734375f));
+    c = _mm512_add_ps(c, mask_or(_mm512_add_ps(nn, dd), 0x807FFFFF, 0x40000000));
+}
+
+// 14*8 + 2 = 112
+inline void round_compute(const __m512& n0, const __m512& n1, const __m512& n2, const __m512& n3, const __m512& rnd_c, __m512& c, __m512& r)
+{
+    __m512 n = _mm512_setzero_ps(), d = _mm512_setzero_ps();
+
+    sub_round(n0, n1, n2, n3, rnd_c, n, d, c);
+    sub_round(n1, n2, n3, n0, rnd_c, n, d, c);
+    sub_round(n2, n3, n0, n1, rnd_c, n, d, c);
+    sub_round(n3, n0, n1, n2, rnd_c, n, d, c);
+    sub_round(n3, n2, n1, n0, rnd_c, n, d, c);
+    sub_round(n2, n1, n0, n3, rnd_c, n, d, c);
+    sub_round(n1, n0, n3, n2, rnd_c, n, d, c);
+    sub_round(n0, n3, n2, n1, rnd_c, n, d, c);
+
+    // Make sure abs(d) > 2.0 - this prevents division by zero and accidental overflows by division by < 1.0
+    d = mask_or(d, 0xFF7FFFFF, 0x40000000);
+    r = _mm512_add_ps(r, _mm512_div_ps(n, d));
+}
+
+// 112×4 = 448
+template <bool add>
+inline __m512i double_compute(const __m512& n0, const __m512& n1, const __m512& n2, const __m512& n3,
+                              const __m512& cnt, const __m512& rnd_c, __m512& sum)
+{
+    __m512 c = cnt;
+    __m512 r = _mm512_setzero_ps();
+
+    round_compute(n0, n1, n2, n3, rnd_c, c, r);
+    round_compute(n0, n1, n2, n3, rnd_c, c, r);
+    round_compute(n0, n1, n2, n3, rnd_c, c, r);
+    round_compute(n0, n1, n2, n3, rnd_c, c, r);
+
+    // do a quick fmod by setting exp to 2
+    r = mask_or(r, 0x807FFFFF, 0x40000000);
+
+    if(add)
+        sum = _mm512_add_ps(sum, r);
+    else
+        sum = r;
+
+    r = _mm512_mul_ps(r, _mm512_set1_ps(536870880.0f)); // 35
+    return _mm512_cvttps_epi32(r);
+}
+
+template <size_t rot>
+inline void double_compute_wrap(const __m512& n0, const __m512& n1, const __m512& n2, const __m512& n3,
+                                const __m512& cnt, const __m512& rnd_c, __m512& sum, __m512i& out)
+{
+    __m512i r = double_compute<rot % 2 != 0>(n0, n1, n2, n3, cnt, rnd_c, sum);
+    if(rot != 0) {
+        // Rotate each 128-bit lane right by rot bytes, from its two 64-bit halves (no byte shifts in AVX-512F)
+        const __m512i swapped = _mm512_shuffle_epi32(r, _MM_PERM_BADC);
+        r = _mm512_or_si512(_mm512_srli_epi64(r, rot * 8), _mm512_slli_epi64(swapped, 64 - rot * 8));
+    }
+
+    out = _mm512_xor_si512(out, r);
+}
+
+template<uint32_t MASK>
+inline __m512i* scratchpad_ptr(uint8_t* lpad, uint32_t idx) { return reinterpret_cast<__m512i*>(lpad + (idx & MASK)); }
+
+template<size_t ITER, uint32_t MASK>
+void cn_gpu_inner_avx512(const uint8_t* spad, uint8_t* lpad)
+{
+    uint32_t s = reinterpret_cast<const uint32_t*>(spad)[0] >> 8;
+    __m512i* idx = scratchpad_ptr<MASK>(lpad, s);
+    __m512 sum0 = _mm512_setzero_ps();
+
+    for(size_t i = 0; i < ITER; i++)
+    {
+        __m512 suma, sumb;
+        const __m512 rc = sum0;
+
+        const __m512i v = _mm512_load_si512(idx);
+        const __m512 n0 = _mm512_cvtepi32_ps(v);
+
+        // Lanes of the AVX2 operands: n01 n23 | n10 n11 | n22 n02 | n33 n30
+        const __m512 n1 = _mm512_shuffle_f32x4(n0, n0, 0x51);
+        const __m512 n2 = _mm512_shuffle_f32x4(n0, n0, 0x8A);
+        const __m512 n3 = _mm512_shuffle_f32x4(n0, n0, 0x3F);
+
+        __m512i out = _mm512_setzero_si512();
+        double_compute_wrap<0>(n0, n1, n2, n3, lanes_ps(1.3437500f, 1.4296875f, 1.4140625f, 1.3203125f), rc, suma, out);
+        double_compute_wrap<1>(n0, n2, n3, n1, lanes_ps(1.2812500f, 1.3984375f, 1.2734375f, 1.3515625f), rc, suma, out);
+        double_compute_wrap<2>(n0, n3, n1, n2, lanes_ps(1.3593750f, 1.3828125f, 1.2578125f, 1.3359375f), rc, sumb, out);
+        double_compute_wrap<3>(n0, n3, n2, n1, lanes_ps(1.3671875f, 1.3046875f, 1.2890625f, 1.4609375f), rc, sumb, out);
+        _mm512_store_si512(idx, _mm512_xor_si512(v, out));
+
+        // Same pairing of the partial sums as the AVX2 kernel: (n0 + n1) + (n2 + n3)
+        __m512 sums = _mm512_add_ps(suma, sumb);
+        sums = _mm512_add_ps(sums, _mm512_shuffle_f32x4(sums, sums, 0xB1));
+        sums = _mm512_add_ps(sums, _mm512_shuffle_f32x4(sums, sums, 0x4E));
+        out = _mm512_xor_si512(out, _mm512_shuffle_i32x4(out, out, 0xB1));
+        out = _mm512_xor_si512(out, _mm512_shuffle_i32x4(out, out, 0x4E));
+
+        __m128 sum = _mm512_castps512_ps128(sums);
+
+        sum = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)), sum); // take abs(va) by masking the float sign bit
+        // vs range 0 - 64
+        __m128i v0 = _mm_cvttps_epi32(_mm_mul_ps(sum, _mm_set1_ps(16777216.0f)));
+        v0 = _mm_xor_si128(v0, _mm512_castsi512_si128(out));
+        __m128i v1 = _mm_shuffle_epi32(v0, _MM_SHUFFLE(0, 1, 2, 3));
+        v0 = _mm_xor_si128(v0, v1);
+        v1 = _mm_shuffle_epi32(v0, _MM_SHUFFLE(0, 1, 0, 1));
+        v0 = _mm_xor_si128(v0, v1);
+
+        // vs is now between 0 and 1
+        sum = _mm_div_ps(sum, _mm_set1_ps(64.0f));
+        sum0 = _mm512_broadcast_f32x4(sum);
+        idx = scratchpad_ptr<MASK>(lpad, _mm_cvtsi128_si32(v0));
+    }
+}
+
+
+static const uint64_t keccakf_rndc[24] =
+{
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
+    0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+    0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
+    0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+    0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
+    0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+// xmrig::keccakf on eight states at once, word i of state j in lane j of st[i]
+static inline void keccakf_x8(__m512i st[25])
+{
+    for (int round = 0; round < 24; ++round) {
+        __m512i bc[5];
+
+        // Theta
+        for (int i = 0; i < 5; ++i) {
+            bc[i] = _mm512_ternarylogic_epi64(st[i], st[i + 5], st[i + 10], 0x96);
+            bc[i] = _mm512_ternarylogic_epi64(bc[i], st[i + 15], st[i + 20], 0x96);
+        }
+        for (int i = 0; i < 5; ++i) {
+            const __m512i t = _mm512_xor_si512(bc[(i + 4) % 5], _mm512_rol_epi64(bc[(i + 1) % 5], 1));
+            for (int j = 0; j < 25; j += 5) st[i + j] = _mm512_xor_si512(st[i + j], t);
+        }
+
+        // Rho Pi
+        const __m512i t = st[1];
+        st[ 1] = _mm512_rol_epi64(st[ 6], 44);
+        st[ 6] = _mm512_rol_epi64(st[ 9], 20);
+        st[ 9] = _mm512_rol_epi64(st[22], 61);
+        st[22] = _mm512_rol_epi64(st[14], 39);
+        st[14] = _mm512_rol_epi64(st[20], 18);
+        st[20] = _mm512_rol_epi64(st[ 2], 62);
+        st[ 2] = _mm512_rol_epi64(st[12], 43);
+        st[12] = _mm512_rol_epi64(st[13], 25);
+        st[13] = _mm512_rol_epi64(st[19],  8);
+        st[19] = _mm512_rol_epi64(st[23], 56);
+        st[23] = _mm512_rol_epi64(st[15], 41);
+        st[15] = _mm512_rol_epi64(st[ 4], 27);
+        st[ 4] = _mm512_rol_epi64(st[24], 14);
+        st[24] = _mm512_rol_epi64(st[21],  2);
+        st[21] = _mm512_rol_epi64(st[ 8], 55);
+        st[ 8] = _mm512_rol_epi64(st[16], 45);
+        st[16] = _mm512_rol_epi64(st[ 5], 36);
+        st[ 5] = _mm512_rol_epi64(st[ 3], 28);
+        st[ 3] = _mm512_rol_epi64(st[18], 21);
+        st[18] = _mm512_rol_epi64(st[17], 15);
+        st[17] = _mm512_rol_epi64(st[11], 10);
+        st[11] = _mm512_rol_epi64(st[ 7],  6);
+        st[ 7] = _mm512_rol_epi64(st[10],  3);
+        st[10] = _mm512_rol_epi64(t, 1);
+
+        // Chi: a ^ (~b & c)
+        for (int j = 0; j < 25; j += 5) {
+            for (int i = 0; i < 5; ++i) bc[i] = st[j + i];
+            for (int i = 0; i < 5; ++i) st[j + i] = _mm512_ternarylogic_epi64(bc[i], bc[(i + 1) % 5], bc[(i + 2) % 5], 0xD2);
+        }
+
+        // Iota
+        st[0] = _mm512_xor_si512(st[0], _mm512_set1_epi64(static_cast<long long>(keccakf_rndc[round])));
+    }
+}
+
+// Writes words of the eight states to the 512 byte blocks they belong to
+static inline void store_x8(const __m512i st[25], size_t words, uint8_t* output)
+{
+    alignas(64) uint64_t lanes[25][8];
+    for (size_t i = 0; i < words; ++i) _mm512_store_si512(lanes[i], st[i]);
+
+    for (size_t j = 0; j < 8; ++j) {
+        uint64_t* block = reinterpret_cast<uint64_t*>(output + j * 512);
+        for (size_t i = 0; i < words; ++i) block[i] = lanes[i][j];
+    }
+}
+
+template<size_t MEM>
+void cn_explode_scratchpad_gpu_avx512(const uint8_t* input, uint8_t* output)
+{
+    static_assert(MEM % (512 * 8) == 0, "Eight 512 byte blocks at a time");
+    const uint64_t* hash = reinterpret_cast<const uint64_t*>(input);
+
+    // Block i is the keccak of the state with i in its first word, eight blocks per pass
+    for (uint64_t i = 0; i < MEM / 512; i += 8) {
+        __m512i st[25];
+        for (int k = 0; k < 25; ++k) st[k] = _mm512_set1_epi64(static_cast<long long>(hash[k]));
+        st[0] = _mm512_xor_si512(st[0], _mm512_add_epi64(_mm512_set1_epi64(static_cast<long long>(i)), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7)));
+
+        keccakf_x8(st);
+        store_x8(st, 20, output);
+
+        keccakf_x8(st);
+        store_x8(st, 22, output + 160);
+
+        keccakf_x8(st);
+        store_x8(st, 22, output + 336);
+
+        output += 512 * 8;
+    }
+}
+
+template void cn_gpu_inner_avx512<xmrig::CnAlgo<xmrig::Algorithm::CN_GPU>().iterations(), xmrig::CnAlgo<xmrig::Algorithm::CN_GPU>().mask()>(const uint8_t* spad, uint8_t* lpad);
+template void cn_explode_scratchpad_gpu_avx512<xmrig::CnAlgo<xmrig::Algorithm::CN_GPU>().memory()>(const uint8_t* input, uint8_t* output);
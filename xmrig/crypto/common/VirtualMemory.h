@@ -63,10 +63,12 @@ public:
     static bool protectRX(void *p, size_t size);
     static uint32_t bindToNUMANode(int64_t affinity);
     static void *allocateExecutableMemory(size_t size, bool hugePages);
+    static void *allocateDualMappedMemory(size_t size, bool hugePages, void **rw, size_t *mapped);
     static void *allocateLargePagesMemory(size_t size);
     static void *allocateOneGbPagesMemory(size_t size);
     static void destroy();
     static void flushInstructionCache(void *p, size_t size);
+    static void freeDualMappedMemory(void *rx, void *rw, size_t size);
     static void freeLargePagesMemory(void *p, size_t size);
     static void init(size_t poolSize, size_t hugePageSize);
 
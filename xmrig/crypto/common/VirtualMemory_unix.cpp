@@ -28,6 +28,12 @@
 #include <sys/mman.h>
 
 
+#ifdef __linux__
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+
 #ifdef XMRIG_OS_APPLE
 #   include <libkern/OSCacheControl.h>
 #   include <mach/vm_statistics.h>
@@ -58,6 +64,21 @@
 #endif
 
 
+#ifndef MFD_CLOEXEC
+#   define MFD_CLOEXEC 0x0001U
+#endif
+
+
+#ifndef MFD_HUGETLB
+#   define MFD_HUGETLB 0x0004U
+#endif
+
+
+#ifndef MFD_EXEC
+#   define MFD_EXEC 0x0010U
+#endif
+
+
 #ifdef XMRIG_SECURE_JIT
 #   define SECURE_PROT_EXEC 0
 #else
@@ -145,10 +166,10 @@ void *xmrig::VirtualMemory::allocateExecutableMemory(size_t size, bool hugePages
     void *mem = nullptr;
 
     if (hugePages) {
-        mem = mmap(0, align(size), PROT_READ | PROT_WRITE | SECURE_PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE | hugePagesFlag(hugePageSize()), -1, 0);
+        mem = mmap(0, align(size), PROT_READ | PROT_WRITE | SECURE_PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE | hugePagesFlag(hugePageSize()), -1, 0);
     }
 
-    if (!mem) {
+    if (!mem || mem == MAP_FAILED) {
         mem = mmap(0, size, PROT_READ | PROT_WRITE | SECURE_PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     }
 
@@ -158,6 +179,81 @@ void *xmrig::VirtualMemory::allocateExecutableMemory(size_t size, bool hugePages
 }
 
 
+#ifdef __linux__
+static int createJitMemfd(bool hugePages)
+{
+    const unsigned int flags = MFD_CLOEXEC | (hugePages ? MFD_HUGETLB : 0);
+
+    // MFD_EXEC keeps the memfd executable when vm.memfd_noexec is set, kernels before 6.3 reject it
+    const int fd = static_cast<int>(syscall(SYS_memfd_create, "xmrig-jit", flags | MFD_EXEC));
+
+    return fd >= 0 ? fd : static_cast<int>(syscall(SYS_memfd_create, "xmrig-jit", flags));
+}
+#endif
+
+
+// The same memfd mapped twice: code is written through the RW view and runs from the RX one,
+// so no page is ever writable and executable (SELinux execmem, PaX MPROTECT). Falls back to a
+// single RWX mapping returned as both views where memfd_create is not available. The length of
+// the views, rounded up to the huge page size for huge pages, goes to mapped for freeDualMappedMemory.
+void *xmrig::VirtualMemory::allocateDualMappedMemory(size_t size, bool hugePages, void **rw, size_t *mapped)
+{
+#   ifdef __linux__
+    for (int huge = hugePages ? 1 : 0; huge >= 0; --huge) {
+        const size_t mapSize = huge ? align(size, hugePageSize()) : size;
+        const int fd = createJitMemfd(huge);
+        if (fd < 0) {
+            continue;
+        }
+
+        void *w = MAP_FAILED;
+        void *x = MAP_FAILED;
+
+        if (ftruncate(fd, static_cast<off_t>(mapSize)) == 0) {
+            w = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+            x = mmap(nullptr, mapSize, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+        }
+
+        close(fd);
+
+        if (w != MAP_FAILED && x != MAP_FAILED) {
+            *rw     = w;
+            *mapped = mapSize;
+
+            return x;
+        }
+
+        if (w != MAP_FAILED) {
+            munmap(w, mapSize);
+        }
+
+        if (x != MAP_FAILED) {
+            munmap(x, mapSize);
+        }
+    }
+    // Without memfd the single mapping is a regular one, huge pages would leave its length unknown
+    hugePages = false;
+#   endif
+
+    void *mem = allocateExecutableMemory(size, hugePages);
+    *rw     = mem;
+    *mapped = size;
+
+    return mem;
+}
+
+
+// size is the length allocateDualMappedMemory reported as mapped
+void xmrig::VirtualMemory::freeDualMappedMemory(void *rx, void *rw, size_t size)
+{
+    if (rw != rx) {
+        munmap(rw, size);
+    }
+
+    munmap(rx, size);
+}
+
+
 void *xmrig::VirtualMemory::allocateLargePagesMemory(size_t size)
 {
 #   if defined(XMRIG_OS_APPLE)
@@ -227,6 +227,23 @@ void xmrig::VirtualMemory::flushInstructionCache(void *p, size_t size)
 }
 
 
+// No dual mapping on Windows, the RWX allocation is both views
+void *xmrig::VirtualMemory::allocateDualMappedMemory(size_t size, bool hugePages, void **rw, size_t *mapped)
+{
+    void *mem = allocateExecutableMemory(size, hugePages);
+    *rw     = mem;
+    *mapped = size;
+
+    return mem;
+}
+
+
+void xmrig::VirtualMemory::freeDualMappedMemory(void *rx, void *, size_t)
+{
+    VirtualFree(rx, 0, MEM_RELEASE);
+}
+
+
 void xmrig::VirtualMemory::freeLargePagesMemory(void *p, size_t)
 {
     VirtualFree(p, 0, MEM_RELEASE);
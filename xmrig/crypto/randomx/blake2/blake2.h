@@ -94,6 +94,11 @@ extern "C" {
 	/* Simple API */
     int rx_blake2b(void *out, size_t outlen, const void *in, size_t inlen);
 
+	/* Multi-buffer API: count equal length messages hashed in parallel SIMD lanes */
+	/* Finishes a copy of S for every in[i], each updated with its inlen bytes, into out[i] */
+    int rx_blake2b_final_multi(const blake2b_state *S, void *const *out, const void *const *in, size_t inlen, size_t count);
+    int rx_blake2b_multi(void *const *out, size_t outlen, const void *const *in, size_t inlen, size_t count);
+
 	/* Argon2 Team - Begin Code */
 	int rxa2_blake2b_long(void *out, size_t outlen, const void *in, size_t inlen);
 	/* Argon2 Team - End Code */
@@ -36,6 +36,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 #include <stdio.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "crypto/randomx/blake2/blake2.h"
 #include "crypto/randomx/blake2/blake2-impl.h"
 
@@ -349,6 +353,251 @@ fail:
 	return ret;
 }
 
+/* Multi-buffer hashing: equal length messages are hashed in parallel SIMD lanes, each vector
+   holds one state word of every lane. Their blocks end at the same offsets, so all lanes share
+   the counter and the finalization flags. */
+#define BLAKE2B_MAX_LANES 8
+
+typedef void (*blake2b_compress_lanes_fn)(uint64_t h[8][BLAKE2B_MAX_LANES], const uint8_t *const *blocks,
+	const uint64_t t[2], const uint64_t f[2]);
+
+#define LANES_G(r, i, a, b, c, d)                                              \
+    do {                                                                       \
+        a = LANES_ADD(LANES_ADD(a, b), m[blake2b_sigma[r][2 * i + 0]]);        \
+        d = LANES_ROTR32(LANES_XOR(d, a));                                     \
+        c = LANES_ADD(c, d);                                                   \
+        b = LANES_ROTR24(LANES_XOR(b, c));                                     \
+        a = LANES_ADD(LANES_ADD(a, b), m[blake2b_sigma[r][2 * i + 1]]);        \
+        d = LANES_ROTR16(LANES_XOR(d, a));                                     \
+        c = LANES_ADD(c, d);                                                   \
+        b = LANES_ROTR63(LANES_XOR(b, c));                                     \
+    } while ((void)0, 0)
+
+#define LANES_ROUND(r)                                                         \
+    do {                                                                       \
+        LANES_G(r, 0, v[0], v[4], v[8], v[12]);                                \
+        LANES_G(r, 1, v[1], v[5], v[9], v[13]);                                \
+        LANES_G(r, 2, v[2], v[6], v[10], v[14]);                               \
+        LANES_G(r, 3, v[3], v[7], v[11], v[15]);                               \
+        LANES_G(r, 4, v[0], v[5], v[10], v[15]);                               \
+        LANES_G(r, 5, v[1], v[6], v[11], v[12]);                               \
+        LANES_G(r, 6, v[2], v[7], v[8], v[13]);                                \
+        LANES_G(r, 7, v[3], v[4], v[9], v[14]);                                \
+    } while ((void)0, 0)
+
+#if defined(__AVX2__)
+static void rx_blake2b_compress_avx2(uint64_t h[8][BLAKE2B_MAX_LANES], const uint8_t *const *blocks,
+	const uint64_t t[2], const uint64_t f[2]) {
+	const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+		2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+	const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+		3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+	__m256i m[16];
+	__m256i v[16];
+	unsigned int i, r;
+
+	for (i = 0; i < 16; ++i) {
+		m[i] = _mm256_set_epi64x(load64(blocks[3] + i * 8), load64(blocks[2] + i * 8),
+			load64(blocks[1] + i * 8), load64(blocks[0] + i * 8));
+	}
+
+	for (i = 0; i < 8; ++i) {
+		v[i] = _mm256_loadu_si256((const __m256i *)h[i]);
+		v[i + 8] = _mm256_set1_epi64x(blake2b_IV[i]);
+	}
+
+	v[12] = _mm256_xor_si256(v[12], _mm256_set1_epi64x(t[0]));
+	v[13] = _mm256_xor_si256(v[13], _mm256_set1_epi64x(t[1]));
+	v[14] = _mm256_xor_si256(v[14], _mm256_set1_epi64x(f[0]));
+	v[15] = _mm256_xor_si256(v[15], _mm256_set1_epi64x(f[1]));
+
+#define LANES_ADD(a, b) _mm256_add_epi64(a, b)
+#define LANES_XOR(a, b) _mm256_xor_si256(a, b)
+#define LANES_ROTR32(x) _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))
+#define LANES_ROTR24(x) _mm256_shuffle_epi8(x, r24)
+#define LANES_ROTR16(x) _mm256_shuffle_epi8(x, r16)
+#define LANES_ROTR63(x) _mm256_or_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x))
+
+	for (r = 0; r < 12; ++r) {
+		LANES_ROUND(r);
+	}
+
+#undef LANES_ADD
+#undef LANES_XOR
+#undef LANES_ROTR32
+#undef LANES_ROTR24
+#undef LANES_ROTR16
+#undef LANES_ROTR63
+
+	for (i = 0; i < 8; ++i) {
+		const __m256i x = _mm256_xor_si256(v[i], v[i + 8]);
+		_mm256_storeu_si256((__m256i *)h[i], _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)h[i]), x));
+	}
+}
+#endif
+
+#if defined(__AVX512F__)
+static void rx_blake2b_compress_avx512(uint64_t h[8][BLAKE2B_MAX_LANES], const uint8_t *const *blocks,
+	const uint64_t t[2], const uint64_t f[2]) {
+	__m512i m[16];
+	__m512i v[16];
+	unsigned int i, r;
+
+	for (i = 0; i < 16; ++i) {
+		m[i] = _mm512_set_epi64(load64(blocks[7] + i * 8), load64(blocks[6] + i * 8),
+			load64(blocks[5] + i * 8), load64(blocks[4] + i * 8), load64(blocks[3] + i * 8),
+			load64(blocks[2] + i * 8), load64(blocks[1] + i * 8), load64(blocks[0] + i * 8));
+	}
+
+	for (i = 0; i < 8; ++i) {
+		v[i] = _mm512_loadu_si512((const void *)h[i]);
+		v[i + 8] = _mm512_set1_epi64(blake2b_IV[i]);
+	}
+
+	v[12] = _mm512_xor_si512(v[12], _mm512_set1_epi64(t[0]));
+	v[13] = _mm512_xor_si512(v[13], _mm512_set1_epi64(t[1]));
+	v[14] = _mm512_xor_si512(v[14], _mm512_set1_epi64(f[0]));
+	v[15] = _mm512_xor_si512(v[15], _mm512_set1_epi64(f[1]));
+
+#define LANES_ADD(a, b) _mm512_add_epi64(a, b)
+#define LANES_XOR(a, b) _mm512_xor_si512(a, b)
+#define LANES_ROTR32(x) _mm512_ror_epi64(x, 32)
+#define LANES_ROTR24(x) _mm512_ror_epi64(x, 24)
+#define LANES_ROTR16(x) _mm512_ror_epi64(x, 16)
+#define LANES_ROTR63(x) _mm512_ror_epi64(x, 63)
+
+	for (r = 0; r < 12; ++r) {
+		LANES_ROUND(r);
+	}
+
+#undef LANES_ADD
+#undef LANES_XOR
+#undef LANES_ROTR32
+#undef LANES_ROTR24
+#undef LANES_ROTR16
+#undef LANES_ROTR63
+
+	for (i = 0; i < 8; ++i) {
+		const __m512i x = _mm512_xor_si512(v[i], v[i + 8]);
+		_mm512_storeu_si512((void *)h[i], _mm512_xor_si512(_mm512_loadu_si512((const void *)h[i]), x));
+	}
+}
+#endif
+
+#undef LANES_G
+#undef LANES_ROUND
+
+/* Finishes count <= lanes copies of S, unused lanes repeat the last message into scratch output */
+static void blake2b_final_lanes(const blake2b_state *S, void *const *out, const void *const *in, size_t inlen,
+	size_t count, unsigned int lanes, blake2b_compress_lanes_fn compress) {
+	uint64_t h[8][BLAKE2B_MAX_LANES];
+	uint8_t blocks[BLAKE2B_MAX_LANES][BLAKE2B_BLOCKBYTES];
+	const uint8_t *pblocks[BLAKE2B_MAX_LANES];
+	const uint8_t *pin[BLAKE2B_MAX_LANES];
+	uint8_t buffer[BLAKE2B_OUTBYTES];
+	uint64_t t[2] = { S->t[0], S->t[1] };
+	uint64_t f[2] = { 0, 0 };
+	size_t buflen = S->buflen;
+	size_t offset = 0;
+	unsigned int i, j;
+
+	for (j = 0; j < lanes; ++j) {
+		pblocks[j] = blocks[j];
+		pin[j] = (const uint8_t *)in[j < count ? j : count - 1];
+	}
+
+	for (i = 0; i < 8; ++i) {
+		for (j = 0; j < lanes; ++j) {
+			h[i][j] = S->h[i];
+		}
+	}
+
+	/* Like rx_blake2b_update the last block is left for the finalization */
+	while (buflen + inlen - offset > BLAKE2B_BLOCKBYTES) {
+		const size_t fill = BLAKE2B_BLOCKBYTES - buflen;
+		for (j = 0; j < lanes; ++j) {
+			memcpy(blocks[j], S->buf, buflen);
+			memcpy(blocks[j] + buflen, pin[j] + offset, fill);
+		}
+		t[0] += BLAKE2B_BLOCKBYTES;
+		t[1] += (t[0] < BLAKE2B_BLOCKBYTES);
+		compress(h, pblocks, t, f);
+		offset += fill;
+		buflen = 0;
+	}
+
+	for (j = 0; j < lanes; ++j) {
+		memcpy(blocks[j], S->buf, buflen);
+		memcpy(blocks[j] + buflen, pin[j] + offset, inlen - offset);
+		memset(blocks[j] + buflen + inlen - offset, 0, BLAKE2B_BLOCKBYTES - buflen - (inlen - offset));
+	}
+	t[0] += buflen + inlen - offset;
+	t[1] += (t[0] < buflen + inlen - offset);
+	f[0] = (uint64_t)-1;
+	f[1] = S->last_node ? (uint64_t)-1 : 0;
+	compress(h, pblocks, t, f);
+
+	for (j = 0; j < count; ++j) {
+		for (i = 0; i < 8; ++i) {
+			store64(buffer + sizeof(h[i][j]) * i, h[i][j]);
+		}
+		memcpy(out[j], buffer, S->outlen);
+	}
+}
+
+int rx_blake2b_final_multi(const blake2b_state *S, void *const *out, const void *const *in, size_t inlen, size_t count) {
+	size_t i = 0;
+
+	/* Sanity checks */
+	if (S == NULL || (count > 0 && (out == NULL || in == NULL))) {
+		return -1;
+	}
+
+	/* Is this a reused state? */
+	if (S->f[0] != 0) {
+		return -1;
+	}
+
+#if defined(__AVX512F__)
+	for (; count - i >= 8; i += 8) {
+		blake2b_final_lanes(S, out + i, in + i, inlen, 8, 8, rx_blake2b_compress_avx512);
+	}
+	if (count - i > 4) {
+		blake2b_final_lanes(S, out + i, in + i, inlen, count - i, 8, rx_blake2b_compress_avx512);
+		i = count;
+	}
+#endif
+
+#if defined(__AVX2__)
+	for (; count - i >= 4; i += 4) {
+		blake2b_final_lanes(S, out + i, in + i, inlen, 4, 4, rx_blake2b_compress_avx2);
+	}
+	if (count - i > 1) {
+		blake2b_final_lanes(S, out + i, in + i, inlen, count - i, 4, rx_blake2b_compress_avx2);
+		i = count;
+	}
+#endif
+
+	for (; i < count; ++i) {
+		blake2b_state lane = *S;
+		if (rx_blake2b_update(&lane, in[i], inlen) < 0 || rx_blake2b_final(&lane, out[i], lane.outlen) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int rx_blake2b_multi(void *const *out, size_t outlen, const void *const *in, size_t inlen, size_t count) {
+	blake2b_state S;
+
+	if (rx_blake2b_init(&S, outlen) < 0) {
+		return -1;
+	}
+
+	return rx_blake2b_final_multi(&S, out, in, inlen, count);
+}
+
 /* Argon2 Team - Begin Code */
 int rxa2_blake2b_long(void *pout, size_t outlen, const void *in, size_t inlen) {
 	uint8_t *out = (uint8_t *)pout;
@@ -78,6 +78,68 @@ namespace randomx {
 		}
 	}
 
+#if defined(__GNUC__)
+#define INSTR_LABEL(x) &&L_ ## x
+#define INSTR_THREADED(x) L_ ## x: \
+	exe_ ## x(bytecode[pc], pc, scratchpad, config); \
+	if (++pc < size) goto *labels[static_cast<int>(bytecode[pc].type)]; \
+	return;
+
+	void BytecodeMachine::executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
+		//indexed by InstructionType, IMUL_RCP is compiled to IMUL_R
+		static void* const labels[] = {
+			INSTR_LABEL(IADD_RS), INSTR_LABEL(IADD_M), INSTR_LABEL(ISUB_R), INSTR_LABEL(ISUB_M),
+			INSTR_LABEL(IMUL_R), INSTR_LABEL(IMUL_M), INSTR_LABEL(IMULH_R), INSTR_LABEL(IMULH_M),
+			INSTR_LABEL(ISMULH_R), INSTR_LABEL(ISMULH_M), INSTR_LABEL(IMUL_R), INSTR_LABEL(INEG_R),
+			INSTR_LABEL(IXOR_R), INSTR_LABEL(IXOR_M), INSTR_LABEL(IROR_R), INSTR_LABEL(IROL_R),
+			INSTR_LABEL(ISWAP_R), INSTR_LABEL(FSWAP_R), INSTR_LABEL(FADD_R), INSTR_LABEL(FADD_M),
+			INSTR_LABEL(FSUB_R), INSTR_LABEL(FSUB_M), INSTR_LABEL(FSCAL_R), INSTR_LABEL(FMUL_R),
+			INSTR_LABEL(FDIV_M), INSTR_LABEL(FSQRT_R), INSTR_LABEL(CBRANCH), INSTR_LABEL(CFROUND),
+			INSTR_LABEL(ISTORE), INSTR_LABEL(NOP),
+		};
+		static_assert(sizeof(labels) / sizeof(labels[0]) == static_cast<int>(InstructionType::NOP) + 1, "labels must cover every InstructionType");
+
+		const int size = static_cast<int>(RandomX_CurrentConfig.ProgramSize);
+		int pc = 0;
+		goto *labels[static_cast<int>(bytecode[pc].type)];
+
+		INSTR_THREADED(IADD_RS)
+		INSTR_THREADED(IADD_M)
+		INSTR_THREADED(ISUB_R)
+		INSTR_THREADED(ISUB_M)
+		INSTR_THREADED(IMUL_R)
+		INSTR_THREADED(IMUL_M)
+		INSTR_THREADED(IMULH_R)
+		INSTR_THREADED(IMULH_M)
+		INSTR_THREADED(ISMULH_R)
+		INSTR_THREADED(ISMULH_M)
+		INSTR_THREADED(INEG_R)
+		INSTR_THREADED(IXOR_R)
+		INSTR_THREADED(IXOR_M)
+		INSTR_THREADED(IROR_R)
+		INSTR_THREADED(IROL_R)
+		INSTR_THREADED(ISWAP_R)
+		INSTR_THREADED(FSWAP_R)
+		INSTR_THREADED(FADD_R)
+		INSTR_THREADED(FADD_M)
+		INSTR_THREADED(FSUB_R)
+		INSTR_THREADED(FSUB_M)
+		INSTR_THREADED(FSCAL_R)
+		INSTR_THREADED(FMUL_R)
+		INSTR_THREADED(FDIV_M)
+		INSTR_THREADED(FSQRT_R)
+		INSTR_THREADED(CBRANCH)
+		INSTR_THREADED(CFROUND)
+		INSTR_THREADED(ISTORE)
+
+	L_NOP:
+		if (++pc < size) goto *labels[static_cast<int>(bytecode[pc].type)];
+	}
+
+#undef INSTR_THREADED
+#undef INSTR_LABEL
+#endif
+
 	void BytecodeMachine::compileInstruction(RANDOMX_GEN_ARGS) {
 		uint32_t opcode = instr.opcode;
 
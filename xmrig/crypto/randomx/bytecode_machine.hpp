@@ -35,8 +35,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace randomx {
 
-	//register file in machine byte order
-	struct NativeRegisterFile {
+	//register file in machine byte order, r on one cache line and f, e, a on the next three
+	struct alignas(64) NativeRegisterFile {
 		int_reg_t r[RegistersCount] = { 0 };
 		rx_vec_f128 f[RegisterCountFlt];
 		rx_vec_f128 e[RegisterCountFlt];
@@ -89,12 +89,17 @@ namespace randomx {
 			}
 		}
 
+#if defined(__GNUC__)
+		//threaded with computed gotos, every handler dispatches the next instruction itself
+		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config);
+#else
 		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
 			for (int pc = 0; pc < static_cast<int>(RandomX_CurrentConfig.ProgramSize); ++pc) {
 				auto& ibc = bytecode[pc];
 				executeInstruction(ibc, pc, scratchpad, config);
 			}
 		}
+#endif
 
 		void compileInstruction(RANDOMX_GEN_ARGS)
 #ifdef RANDOMX_GEN_TABLE
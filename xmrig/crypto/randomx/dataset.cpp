@@ -38,6 +38,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstring>
 #include <limits>
 #include <cstring>
+#include <chrono>
+#include <thread>
 
 #include "crypto/randomx/common.hpp"
 #include "crypto/randomx/dataset.hpp"
@@ -68,7 +70,11 @@ namespace randomx {
 	template void deallocCache<DefaultAllocator>(randomx_cache* cache);
 	template void deallocCache<LargePageAllocator>(randomx_cache* cache);
 
-	void initCache(randomx_cache* cache, const void* key, size_t keySize) {
+	static uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	static void fillCache(randomx_cache* cache, const void* key, size_t keySize) {
 		argon2_context context;
 
 		context.out = nullptr;
@@ -91,7 +97,9 @@ namespace randomx {
 		context.version = ARGON2_VERSION_NUMBER;
 
 		argon2_ctx_mem(&context, Argon2_d, cache->memory, RandomX_CurrentConfig.ArgonMemory * 1024);
+	}
 
+	static void generatePrograms(randomx_cache* cache, const void* key, size_t keySize, bool compile) {
 		cache->reciprocalCache.clear();
 		randomx::Blake2Generator gen(key, keySize);
 		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
@@ -105,12 +113,52 @@ namespace randomx {
 				}
 			}
 		}
+
+		if (compile) {
+			cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache);
+			cache->jit->generateDatasetInitCode();
+		}
+	}
+
+	// The programs only depend on the key, so they are generated on a helper thread while this
+	// one runs the Argon2d fill (a single lane for all RandomX variants, it can't be split)
+	static void initCacheConcurrent(randomx_cache* cache, const void* key, size_t keySize, bool compile) {
+		const auto start = std::chrono::steady_clock::now();
+		RandomX_ConfigurationBase* config = RandomX_CurrentConfigPtr;
+
+		std::thread helper;
+		try {
+			helper = std::thread([cache, key, keySize, compile, config]() {
+				const auto programsStart = std::chrono::steady_clock::now();
+				RandomX_CurrentConfigPtr = config;
+				generatePrograms(cache, key, keySize, compile);
+				cache->timing.superscalar = elapsedNs(programsStart);
+			});
+		}
+		catch (const std::system_error&) {
+		}
+
+		fillCache(cache, key, keySize);
+		cache->timing.argon2 = elapsedNs(start);
+
+		if (helper.joinable()) {
+			helper.join();
+		}
+		else {
+			const auto programsStart = std::chrono::steady_clock::now();
+			generatePrograms(cache, key, keySize, compile);
+			cache->timing.superscalar = elapsedNs(programsStart);
+		}
+
+		cache->timing.total = elapsedNs(start);
+	}
+
+	void initCache(randomx_cache* cache, const void* key, size_t keySize) {
+		initCacheConcurrent(cache, key, keySize, false);
 	}
 
 	void initCacheCompile(randomx_cache* cache, const void* key, size_t keySize) {
-		initCache(cache, key, keySize);
-		cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache);
-		cache->jit->generateDatasetInitCode();
+		initCacheConcurrent(cache, key, keySize, true);
 	}
 
 	constexpr uint64_t superscalarMul0 = 6364136223846793005ULL;
@@ -48,6 +48,7 @@ struct randomx_cache {
 	randomx::DatasetInitFunc* datasetInit;
 	randomx::SuperscalarProgram programs[RANDOMX_CACHE_MAX_ACCESSES];
 	std::vector<uint64_t> reciprocalCache;
+	randomx_cache_timing timing = {};
 
 	bool isInitialized() {
 		return programs[0].getSize() != 0;
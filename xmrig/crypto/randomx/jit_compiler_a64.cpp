@@ -40,6 +40,11 @@ void randomx_set_huge_pages_jit(bool hugePages)
 	hugePagesJIT = hugePages;
 }
 
+bool randomx_get_huge_pages_jit()
+{
+	return hugePagesJIT;
+}
+
 namespace ARMV8A {
 
 constexpr uint32_t B           = 0x14000000;
@@ -147,7 +152,7 @@ void JitCompilerA64::generateProgram(Program& program, ProgramConfiguration& con
 		Instruction& instr = program(i);
 		instr.src %= RegistersCount;
 		instr.dst %= RegistersCount;
-		(this->*engine[instr.opcode])(instr, codePos);
+		(this->*engine()[instr.opcode])(instr, codePos);
 	}
 
 	// Update spMix2
@@ -196,7 +201,7 @@ void JitCompilerA64::generateProgramLight(Program& program, ProgramConfiguration
 		Instruction& instr = program(i);
 		instr.src %= RegistersCount;
 		instr.dst %= RegistersCount;
-		(this->*engine[instr.opcode])(instr, codePos);
+		(this->*engine()[instr.opcode])(instr, codePos);
 	}
 
 	// Update spMix2
@@ -1031,6 +1036,4 @@ void JitCompilerA64::h_NOP(Instruction& instr, uint32_t& codePos)
 {
 }
 
-InstructionGeneratorA64 JitCompilerA64::engine[256] = {};
-
 }
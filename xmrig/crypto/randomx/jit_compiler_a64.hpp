@@ -63,7 +63,8 @@ namespace randomx {
 		uint8_t* getCode() { return code; }
 		size_t getCodeSize();
 
-		static InstructionGeneratorA64 engine[256];
+		// Instruction handlers of the calling thread's RandomX configuration
+		static const InstructionGeneratorA64* engine() { return reinterpret_cast<const InstructionGeneratorA64*>(RandomX_CurrentConfig.JitEngine_Calculated); }
 		uint32_t reg_changed_offset[8];
 		uint8_t* code;
 		uint32_t literalPos;
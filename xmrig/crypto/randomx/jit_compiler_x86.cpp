@@ -56,6 +56,11 @@ void randomx_set_huge_pages_jit(bool hugePages)
 	hugePagesJIT = hugePages;
 }
 
+bool randomx_get_huge_pages_jit()
+{
+	return hugePagesJIT;
+}
+
 namespace randomx {
 	/*
 
@@ -194,10 +199,15 @@ namespace randomx {
 		cpuid(0x80000001, info);
 		hasXOP = ((info[2] & (1 << 11)) != 0);
 
-		allocatedCode = (uint8_t*)allocExecutableMemory(CodeSize * 2, hugePagesJIT && hugePagesEnable);
+		// Code is generated through one mapping and executed from another, so strict W^X hosts keep the JIT
+		void* rw;
+		allocatedCodeExec = (uint8_t*)allocDualMappedMemory(CodeSize * 2, hugePagesJIT && hugePagesEnable, &rw, &allocatedSize);
+		allocatedCode = (uint8_t*)rw;
 
 		// Shift code base address to improve caching - all threads will use different L2/L3 cache sets
-		code = allocatedCode + (codeOffset.fetch_add(codeOffsetIncrement) % CodeSize);
+		const size_t offset = codeOffset.fetch_add(codeOffsetIncrement) % CodeSize;
+		code = allocatedCode + offset;
+		codeExec = allocatedCodeExec + offset;
 
 		memcpy(code, codePrologue, prologueSize);
 		if (hasXOP) {
@@ -211,19 +221,17 @@ namespace randomx {
 		codePosFirst = prologueSize + (hasXOP ? loopLoadXOPSize : loopLoadSize);
 
 #		ifdef XMRIG_FIX_RYZEN
-		mainLoopBounds.first = code + prologueSize;
-		mainLoopBounds.second = code + epilogueOffset;
+		mainLoopBounds.first = codeExec + prologueSize;
+		mainLoopBounds.second = codeExec + epilogueOffset;
 #		endif
 	}
 
 	JitCompilerX86::~JitCompilerX86() {
 		codeOffset.fetch_sub(codeOffsetIncrement);
-		freePagedMemory(allocatedCode, CodeSize);
+		freeDualMappedMemory(allocatedCodeExec, allocatedCode, allocatedSize);
 	}
 
 	void JitCompilerX86::prepare() {
-		for (size_t i = 0; i < sizeof(engine); i += 64)
-			rx_prefetch_nta((const char*)(&engine) + i);
 		for (size_t i = 0; i < sizeof(RandomX_CurrentConfig); i += 64)
 			rx_prefetch_nta((const char*)(&RandomX_CurrentConfig) + i);
 	}
@@ -316,6 +324,8 @@ namespace randomx {
 			r[j] = k;
 		}
 
+		const InstructionGeneratorX86* engine = reinterpret_cast<const InstructionGeneratorX86*>(RandomX_CurrentConfig.JitEngine_Calculated);
+
 		for (int i = 0, n = static_cast<int>(RandomX_CurrentConfig.ProgramSize); i < n; i += 4) {
 			Instruction& instr1 = prog(i);
 			Instruction& instr2 = prog(i + 1);
@@ -1120,6 +1130,5 @@ namespace randomx {
 		emitByte(0x90, code, codePos);
 	}
 
-	alignas(64) InstructionGeneratorX86 JitCompilerX86::engine[256] = {};
 
 }
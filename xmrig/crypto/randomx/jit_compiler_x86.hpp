@@ -56,20 +56,20 @@ namespace randomx {
 		void generateSuperscalarHash(SuperscalarProgram (&programs)[N], std::vector<uint64_t> &);
 		void generateDatasetInitCode();
 		ProgramFunc* getProgramFunc() {
-			return (ProgramFunc*)code;
+			return (ProgramFunc*)codeExec;
 		}
 		DatasetInitFunc* getDatasetInitFunc() {
-			return (DatasetInitFunc*)code;
+			return (DatasetInitFunc*)codeExec;
 		}
 		uint8_t* getCode() {
 			return code;
 		}
 		size_t getCodeSize();
 
-		alignas(64) static InstructionGeneratorX86 engine[256];
 
 		int registerUsage[RegistersCount];
-		uint8_t* code;
+		uint8_t* code;      // writable view of the code buffer
+		uint8_t* codeExec;  // executable view of the same memory
 		uint32_t codePos;
 		uint32_t codePosFirst;
 		uint32_t vm_flags;
@@ -83,6 +83,8 @@ namespace randomx {
 		bool hasXOP;
 
 		uint8_t* allocatedCode;
+		uint8_t* allocatedCodeExec;
+		size_t allocatedSize;
 
 		void generateProgramPrologue(Program&, ProgramConfiguration&);
 		void generateProgramEpilogue(Program&, ProgramConfiguration&);
@@ -0,0 +1,558 @@
+/*-
+ * Two yespower 1.0 computations at once, for AVX2.
+ *
+ * Every __m256i holds the same 128-bit word of both computations, so Salsa20
+ * and pwxform run on the two lanes with the instructions of one, and their
+ * dependency chains overlap.  Only the S-box lookups and the V accesses, whose
+ * addresses depend on the data, are split into 128-bit halves.
+ *
+ * V, XY and the S-boxes are interleaved: the 16-byte word at offset x of a
+ * single computation is at 2 * x for the first lane and at 2 * x + 16 for the
+ * second one.  B stays a separate byte array per lane.
+ *
+ * This file is included from yespower-opt.c after its second pass, the
+ * results are bit-exact with yespower().  Without AVX2 the two lanes are
+ * computed one after the other.
+ */
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+typedef union {
+	__m256i o[4];
+} salsa20_blk2_t;
+
+typedef struct {
+	uint8_t *S0, *S1, *S2;
+	size_t w;
+	uint32_t Sbytes;
+} pwxform_ctx2_t;
+
+#define DUAL_DECL_X \
+	__m256i X0, X1, X2, X3;
+#define DUAL_DECL_Y \
+	__m256i Y0, Y1, Y2, Y3;
+#define DUAL_READ_X(in) \
+	X0 = (in).o[0]; X1 = (in).o[1]; X2 = (in).o[2]; X3 = (in).o[3];
+#define DUAL_WRITE_X(out) \
+	(out).o[0] = X0; (out).o[1] = X1; (out).o[2] = X2; (out).o[3] = X3;
+
+/* Word k of block a for the first lane and of block b for the second one */
+#define DUAL_LOAD(a, b, k) \
+	_mm256_blend_epi32((a).o[k], (b).o[k], 0xF0)
+#define DUAL_STORE(a, b, k, v) \
+	_mm_store_si128((__m128i *)&(a).o[k], _mm256_castsi256_si128(v)); \
+	_mm_store_si128((__m128i *)&(b).o[k] + 1, _mm256_extracti128_si256(v, 1));
+
+#ifdef __AVX512VL__
+#define DUAL_ARX(out, in1, in2, s) \
+	out = _mm256_xor_si256(out, _mm256_rol_epi32(_mm256_add_epi32(in1, in2), s));
+#else
+#define DUAL_ARX(out, in1, in2, s) { \
+	__m256i tmp = _mm256_add_epi32(in1, in2); \
+	out = _mm256_xor_si256(out, _mm256_slli_epi32(tmp, s)); \
+	out = _mm256_xor_si256(out, _mm256_srli_epi32(tmp, 32 - s)); \
+}
+#endif
+
+#define DUAL_SALSA20_2ROUNDS \
+	/* Operate on "columns" */ \
+	DUAL_ARX(X1, X0, X3, 7) \
+	DUAL_ARX(X2, X1, X0, 9) \
+	DUAL_ARX(X3, X2, X1, 13) \
+	DUAL_ARX(X0, X3, X2, 18) \
+	/* Rearrange data */ \
+	X1 = _mm256_shuffle_epi32(X1, 0x93); \
+	X2 = _mm256_shuffle_epi32(X2, 0x4E); \
+	X3 = _mm256_shuffle_epi32(X3, 0x39); \
+	/* Operate on "rows" */ \
+	DUAL_ARX(X3, X0, X1, 7) \
+	DUAL_ARX(X2, X3, X0, 9) \
+	DUAL_ARX(X1, X2, X3, 13) \
+	DUAL_ARX(X0, X1, X2, 18) \
+	/* Rearrange data */ \
+	X1 = _mm256_shuffle_epi32(X1, 0x39); \
+	X2 = _mm256_shuffle_epi32(X2, 0x4E); \
+	X3 = _mm256_shuffle_epi32(X3, 0x93);
+
+/**
+ * Apply the Salsa20/2 core to the blocks provided in X.
+ */
+#define DUAL_SALSA20_2(out) { \
+	__m256i Z0 = X0, Z1 = X1, Z2 = X2, Z3 = X3; \
+	DUAL_SALSA20_2ROUNDS \
+	(out).o[0] = X0 = _mm256_add_epi32(X0, Z0); \
+	(out).o[1] = X1 = _mm256_add_epi32(X1, Z1); \
+	(out).o[2] = X2 = _mm256_add_epi32(X2, Z2); \
+	(out).o[3] = X3 = _mm256_add_epi32(X3, Z3); \
+}
+
+#define DUAL_XOR_X(in) \
+	X0 = _mm256_xor_si256(X0, (in).o[0]); \
+	X1 = _mm256_xor_si256(X1, (in).o[1]); \
+	X2 = _mm256_xor_si256(X2, (in).o[2]); \
+	X3 = _mm256_xor_si256(X3, (in).o[3]);
+
+#define DUAL_XOR_X_SPLIT(a, b) \
+	X0 = _mm256_xor_si256(X0, DUAL_LOAD(a, b, 0)); \
+	X1 = _mm256_xor_si256(X1, DUAL_LOAD(a, b, 1)); \
+	X2 = _mm256_xor_si256(X2, DUAL_LOAD(a, b, 2)); \
+	X3 = _mm256_xor_si256(X3, DUAL_LOAD(a, b, 3));
+
+#define DUAL_XOR_X_2(in1, a, b) \
+	X0 = _mm256_xor_si256((in1).o[0], DUAL_LOAD(a, b, 0)); \
+	X1 = _mm256_xor_si256((in1).o[1], DUAL_LOAD(a, b, 1)); \
+	X2 = _mm256_xor_si256((in1).o[2], DUAL_LOAD(a, b, 2)); \
+	X3 = _mm256_xor_si256((in1).o[3], DUAL_LOAD(a, b, 3));
+
+#define DUAL_XOR_X_WRITE_XOR_Y_2(a, b, in) \
+	Y0 = _mm256_xor_si256(DUAL_LOAD(a, b, 0), (in).o[0]); \
+	Y1 = _mm256_xor_si256(DUAL_LOAD(a, b, 1), (in).o[1]); \
+	Y2 = _mm256_xor_si256(DUAL_LOAD(a, b, 2), (in).o[2]); \
+	Y3 = _mm256_xor_si256(DUAL_LOAD(a, b, 3), (in).o[3]); \
+	DUAL_STORE(a, b, 0, Y0) \
+	DUAL_STORE(a, b, 1, Y1) \
+	DUAL_STORE(a, b, 2, Y2) \
+	DUAL_STORE(a, b, 3, Y3) \
+	X0 = _mm256_xor_si256(X0, Y0); \
+	X1 = _mm256_xor_si256(X1, Y1); \
+	X2 = _mm256_xor_si256(X2, Y2); \
+	X3 = _mm256_xor_si256(X3, Y3);
+
+#define DUAL_INTEGERIFY(j) \
+	(j)[0] = (uint32_t)_mm256_cvtsi256_si32(X0); \
+	(j)[1] = (uint32_t)_mm256_extract_epi32(X0, 4);
+
+#define DUAL_PWXFORM_SIMD(X) { \
+	uint64_t xa = (uint64_t)_mm256_extract_epi64(X, 0) & Smask2_1_0; \
+	uint64_t xb = (uint64_t)_mm256_extract_epi64(X, 2) & Smask2_1_0; \
+	__m256i s0 = _mm256_inserti128_si256(_mm256_castsi128_si256( \
+	    _mm_load_si128((const __m128i *)(S0 + 2 * (uint32_t)xa))), \
+	    _mm_load_si128((const __m128i *)(S0 + 2 * (uint32_t)xb + 16)), 1); \
+	__m256i s1 = _mm256_inserti128_si256(_mm256_castsi128_si256( \
+	    _mm_load_si128((const __m128i *)(S1 + 2 * (xa >> 32)))), \
+	    _mm_load_si128((const __m128i *)(S1 + 2 * (xb >> 32) + 16)), 1); \
+	X = _mm256_mul_epu32(_mm256_srli_si256(X, 4), X); \
+	X = _mm256_add_epi64(X, s0); \
+	X = _mm256_xor_si256(X, s1); \
+}
+
+#define DUAL_PWXFORM_SIMD_WRITE(X, Sw) \
+	DUAL_PWXFORM_SIMD(X) \
+	*(__m256i *)(Sw + 2 * w) = X;
+
+#define DUAL_PWXFORM_ROUND_WRITE4 \
+	DUAL_PWXFORM_SIMD_WRITE(X0, S0) \
+	DUAL_PWXFORM_SIMD_WRITE(X1, S1) \
+	w += 16; \
+	DUAL_PWXFORM_SIMD_WRITE(X2, S0) \
+	DUAL_PWXFORM_SIMD_WRITE(X3, S1) \
+	w += 16;
+
+#define DUAL_PWXFORM_ROUND_WRITE2 \
+	DUAL_PWXFORM_SIMD_WRITE(X0, S0) \
+	DUAL_PWXFORM_SIMD_WRITE(X1, S1) \
+	w += 16; \
+	DUAL_PWXFORM_SIMD(X2) \
+	DUAL_PWXFORM_SIMD(X3)
+
+#define DUAL_PWXFORM \
+	DUAL_PWXFORM_ROUND_WRITE4 DUAL_PWXFORM_ROUND_WRITE2 DUAL_PWXFORM_ROUND_WRITE2 \
+	w &= Smask2_1_0; \
+	{ \
+		uint8_t *Stmp = S2; \
+		S2 = S1; \
+		S1 = S0; \
+		S0 = Stmp; \
+	}
+
+static inline void blockmix_salsa_dual(const salsa20_blk2_t *restrict Bin,
+    salsa20_blk2_t *restrict Bout)
+{
+	DUAL_DECL_X
+
+	DUAL_READ_X(Bin[1])
+	DUAL_XOR_X(Bin[0])
+	DUAL_SALSA20_2(Bout[0])
+	DUAL_XOR_X(Bin[1])
+	DUAL_SALSA20_2(Bout[1])
+}
+
+static inline void blockmix_salsa_xor_dual(const salsa20_blk2_t *restrict Bin1,
+    const salsa20_blk2_t *Bin2a, const salsa20_blk2_t *Bin2b,
+    salsa20_blk2_t *restrict Bout, uint32_t j[2])
+{
+	DUAL_DECL_X
+
+	DUAL_XOR_X_2(Bin1[1], Bin2a[1], Bin2b[1])
+	DUAL_XOR_X(Bin1[0])
+	DUAL_XOR_X_SPLIT(Bin2a[0], Bin2b[0])
+	DUAL_SALSA20_2(Bout[0])
+	DUAL_XOR_X(Bin1[1])
+	DUAL_XOR_X_SPLIT(Bin2a[1], Bin2b[1])
+	DUAL_SALSA20_2(Bout[1])
+
+	DUAL_INTEGERIFY(j)
+}
+
+static void blockmix_dual(const salsa20_blk2_t *restrict Bin,
+    salsa20_blk2_t *restrict Bout, size_t r, pwxform_ctx2_t *restrict ctx)
+{
+	if (unlikely(!ctx)) {
+		blockmix_salsa_dual(Bin, Bout);
+		return;
+	}
+
+	uint8_t *S0 = ctx->S0, *S1 = ctx->S1, *S2 = ctx->S2;
+	size_t w = ctx->w;
+	size_t i;
+	DUAL_DECL_X
+
+	/* Convert count of 128-byte blocks to max index of 64-byte block */
+	r = r * 2 - 1;
+
+	DUAL_READ_X(Bin[r])
+
+	i = 0;
+	do {
+		DUAL_XOR_X(Bin[i])
+		DUAL_PWXFORM
+		if (unlikely(i >= r))
+			break;
+		DUAL_WRITE_X(Bout[i])
+		i++;
+	} while (1);
+
+	ctx->S0 = S0; ctx->S1 = S1; ctx->S2 = S2;
+	ctx->w = w;
+
+	DUAL_SALSA20_2(Bout[i])
+}
+
+static void blockmix_xor_dual(const salsa20_blk2_t *restrict Bin1,
+    const salsa20_blk2_t *Bin2a, const salsa20_blk2_t *Bin2b,
+    salsa20_blk2_t *restrict Bout, size_t r, pwxform_ctx2_t *restrict ctx,
+    uint32_t j[2])
+{
+	if (unlikely(!ctx)) {
+		blockmix_salsa_xor_dual(Bin1, Bin2a, Bin2b, Bout, j);
+		return;
+	}
+
+	uint8_t *S0 = ctx->S0, *S1 = ctx->S1, *S2 = ctx->S2;
+	size_t w = ctx->w;
+	size_t i;
+	DUAL_DECL_X
+
+	/* Convert count of 128-byte blocks to max index of 64-byte block */
+	r = r * 2 - 1;
+
+	for (i = 0; i <= r; i++) {
+		_mm_prefetch((const char *)&Bin2a[i], _MM_HINT_T0);
+		_mm_prefetch((const char *)&Bin2b[i] + 16, _MM_HINT_T0);
+	}
+
+	DUAL_XOR_X_2(Bin1[r], Bin2a[r], Bin2b[r])
+
+	i = 0;
+	r--;
+	do {
+		DUAL_XOR_X(Bin1[i])
+		DUAL_XOR_X_SPLIT(Bin2a[i], Bin2b[i])
+		DUAL_PWXFORM
+		DUAL_WRITE_X(Bout[i])
+
+		DUAL_XOR_X(Bin1[i + 1])
+		DUAL_XOR_X_SPLIT(Bin2a[i + 1], Bin2b[i + 1])
+		DUAL_PWXFORM
+
+		if (unlikely(i >= r))
+			break;
+
+		DUAL_WRITE_X(Bout[i + 1])
+
+		i += 2;
+	} while (1);
+	i++;
+
+	ctx->S0 = S0; ctx->S1 = S1; ctx->S2 = S2;
+	ctx->w = w;
+
+	DUAL_SALSA20_2(Bout[i])
+
+	DUAL_INTEGERIFY(j)
+}
+
+static void blockmix_xor_save_dual(salsa20_blk2_t *restrict Bin1out,
+    salsa20_blk2_t *Bin2a, salsa20_blk2_t *Bin2b,
+    size_t r, pwxform_ctx2_t *restrict ctx, uint32_t j[2])
+{
+	uint8_t *S0 = ctx->S0, *S1 = ctx->S1, *S2 = ctx->S2;
+	size_t w = ctx->w;
+	size_t i;
+	DUAL_DECL_X
+	DUAL_DECL_Y
+
+	/* Convert count of 128-byte blocks to max index of 64-byte block */
+	r = r * 2 - 1;
+
+	for (i = 0; i <= r; i++) {
+		_mm_prefetch((const char *)&Bin2a[i], _MM_HINT_T0);
+		_mm_prefetch((const char *)&Bin2b[i] + 16, _MM_HINT_T0);
+	}
+
+	DUAL_XOR_X_2(Bin1out[r], Bin2a[r], Bin2b[r])
+
+	i = 0;
+	r--;
+	do {
+		DUAL_XOR_X_WRITE_XOR_Y_2(Bin2a[i], Bin2b[i], Bin1out[i])
+		DUAL_PWXFORM
+		DUAL_WRITE_X(Bin1out[i])
+
+		DUAL_XOR_X_WRITE_XOR_Y_2(Bin2a[i + 1], Bin2b[i + 1], Bin1out[i + 1])
+		DUAL_PWXFORM
+
+		if (unlikely(i >= r))
+			break;
+
+		DUAL_WRITE_X(Bin1out[i + 1])
+
+		i += 2;
+	} while (1);
+	i++;
+
+	ctx->S0 = S0; ctx->S1 = S1; ctx->S2 = S2;
+	ctx->w = w;
+
+	DUAL_SALSA20_2(Bin1out[i])
+
+	DUAL_INTEGERIFY(j)
+}
+
+static inline void integerify_dual(const salsa20_blk2_t *B, size_t r,
+    uint32_t j[2])
+{
+	j[0] = (uint32_t)_mm256_cvtsi256_si32(B[2 * r - 1].o[0]);
+	j[1] = (uint32_t)_mm256_extract_epi32(B[2 * r - 1].o[0], 4);
+}
+
+/* The i-th 64-byte block of both lanes' B, SIMD shuffled and interleaved */
+static inline void read_block_dual(uint8_t *const B[2], size_t i,
+    salsa20_blk2_t *dst)
+{
+	salsa20_blk_t tmp, blk[2];
+	size_t k, l;
+
+	for (l = 0; l < 2; l++) {
+		const salsa20_blk_t *src = (const salsa20_blk_t *)&B[l][i * 64];
+		for (k = 0; k < 16; k++)
+			tmp.w[k] = le32dec(&src->w[k]);
+		salsa20_simd_shuffle(&tmp, &blk[l]);
+	}
+
+	for (k = 0; k < 4; k++)
+		dst->o[k] = _mm256_inserti128_si256(
+		    _mm256_castsi128_si256(blk[0].q[k]), blk[1].q[k], 1);
+}
+
+static inline void write_block_dual(const salsa20_blk2_t *src,
+    uint8_t *const B[2], size_t i)
+{
+	salsa20_blk_t tmp, blk[2];
+	size_t k, l;
+
+	for (k = 0; k < 4; k++) {
+		blk[0].q[k] = _mm256_castsi256_si128(src->o[k]);
+		blk[1].q[k] = _mm256_extracti128_si256(src->o[k], 1);
+	}
+
+	for (l = 0; l < 2; l++) {
+		for (k = 0; k < 16; k++)
+			le32enc(&tmp.w[k], blk[l].w[k]);
+		salsa20_simd_unshuffle(&tmp, (salsa20_blk_t *)&B[l][i * 64]);
+	}
+}
+
+#define DUAL_V(j, l) (&V[(j)[l] * s])
+
+/**
+ * smix1_dual(B, r, N, V, XY, ctx):
+ * smix1() of yespower 1.0 for both lanes.
+ */
+static void smix1_dual(uint8_t *const B[2], size_t r, uint32_t N,
+    salsa20_blk2_t *V, salsa20_blk2_t *XY, pwxform_ctx2_t *ctx)
+{
+	size_t s = 2 * r;
+	salsa20_blk2_t *X = V, *Y = &V[s];
+	uint32_t i, n, j[2];
+
+	for (i = 0; i < 2; i++)
+		read_block_dual(B, i, &X[i]);
+
+	for (i = 1; i < r; i++)
+		blockmix_dual(&X[(i - 1) * 2], &X[i * 2], 1, ctx);
+
+	blockmix_dual(X, Y, r, ctx);
+	X = Y + s;
+	blockmix_dual(Y, X, r, ctx);
+	integerify_dual(X, r, j);
+
+	for (n = 2; n < N; n <<= 1) {
+		uint32_t m = (n < N / 2) ? n : (N - 1 - n);
+		for (i = 1; i < m; i += 2) {
+			Y = X + s;
+			j[0] &= n - 1; j[0] += i - 1;
+			j[1] &= n - 1; j[1] += i - 1;
+			blockmix_xor_dual(X, DUAL_V(j, 0), DUAL_V(j, 1), Y, r, ctx, j);
+			j[0] &= n - 1; j[0] += i;
+			j[1] &= n - 1; j[1] += i;
+			X = Y + s;
+			blockmix_xor_dual(Y, DUAL_V(j, 0), DUAL_V(j, 1), X, r, ctx, j);
+		}
+	}
+	n >>= 1;
+
+	j[0] &= n - 1; j[0] += N - 2 - n;
+	j[1] &= n - 1; j[1] += N - 2 - n;
+	Y = X + s;
+	blockmix_xor_dual(X, DUAL_V(j, 0), DUAL_V(j, 1), Y, r, ctx, j);
+	j[0] &= n - 1; j[0] += N - 1 - n;
+	j[1] &= n - 1; j[1] += N - 1 - n;
+	blockmix_xor_dual(Y, DUAL_V(j, 0), DUAL_V(j, 1), XY, r, ctx, j);
+
+	for (i = 0; i < 2 * r; i++)
+		write_block_dual(&XY[i], B, i);
+}
+
+/**
+ * smix2_dual(B, r, N, Nloop, V, XY, ctx):
+ * smix2() of yespower 1.0 for both lanes.
+ */
+static void smix2_dual(uint8_t *const B[2], size_t r, uint32_t N,
+    uint32_t Nloop, salsa20_blk2_t *V, salsa20_blk2_t *XY,
+    pwxform_ctx2_t *ctx)
+{
+	size_t s = 2 * r;
+	salsa20_blk2_t *X = XY;
+	uint32_t i, j[2];
+
+	for (i = 0; i < 2 * r; i++)
+		read_block_dual(B, i, &X[i]);
+
+	integerify_dual(X, r, j);
+	j[0] &= N - 1;
+	j[1] &= N - 1;
+
+	do {
+		blockmix_xor_save_dual(X, DUAL_V(j, 0), DUAL_V(j, 1), r, ctx, j);
+		j[0] &= N - 1;
+		j[1] &= N - 1;
+		blockmix_xor_save_dual(X, DUAL_V(j, 0), DUAL_V(j, 1), r, ctx, j);
+		j[0] &= N - 1;
+		j[1] &= N - 1;
+	} while (Nloop -= 2);
+
+	for (i = 0; i < 2 * r; i++)
+		write_block_dual(&X[i], B, i);
+}
+
+#undef DUAL_V
+
+static void smix_dual(uint8_t *const B[2], size_t r, uint32_t N,
+    salsa20_blk2_t *V, salsa20_blk2_t *XY, pwxform_ctx2_t *ctx)
+{
+	uint32_t Nloop_rw = (N + 2) / 3; /* 1/3, round up */
+	Nloop_rw++; Nloop_rw &= ~(uint32_t)1; /* round up to even */
+
+	smix1_dual(B, 1, ctx->Sbytes / 128, (salsa20_blk2_t *)ctx->S0, XY, NULL);
+	smix1_dual(B, r, N, V, XY, ctx);
+	smix2_dual(B, r, N, Nloop_rw /* must be > 2 */, V, XY, ctx);
+}
+
+int yespower_2way(yespower_local_t *local,
+    const uint8_t *const src[2], size_t srclen,
+    const yespower_params_t *params,
+    yespower_binary_t *const dst[2])
+{
+	uint32_t N = params->N;
+	uint32_t r = params->r;
+	const uint8_t *pers = params->pers;
+	size_t perslen = params->perslen;
+	size_t B_size, V_size, XY_size, Sbytes, need;
+	uint8_t *B[2], *S;
+	salsa20_blk2_t *V, *XY;
+	pwxform_ctx2_t ctx;
+	uint8_t sha256[2][32];
+	int l;
+
+	/* yespower 0.5 and invalid parameters take the single lane code */
+	if (params->version != YESPOWER_1_0 ||
+	    N < 1024 || N > 512 * 1024 || r < 8 || r > 32 ||
+	    (N & (N - 1)) != 0 ||
+	    (!pers && perslen)) {
+		int rc0 = yespower(local, src[0], srclen, params, dst[0]);
+		int rc1 = yespower(local, src[1], srclen, params, dst[1]);
+		return (rc0 || rc1) ? -1 : 0;
+	}
+
+	/* Allocate memory, the interleaved arrays first to keep them 64-byte aligned */
+	B_size = (size_t)128 * r;
+	V_size = B_size * N;
+	XY_size = B_size + 64;
+	Sbytes = 3 * Swidth_to_Sbytes1(Swidth_1_0);
+	need = 2 * (V_size + XY_size + Sbytes + B_size);
+	if (local->aligned_size < need) {
+		if (free_region(local))
+			goto fail;
+		if (!alloc_region(local, need))
+			goto fail;
+	}
+	V = (salsa20_blk2_t *)local->aligned;
+	XY = (salsa20_blk2_t *)((uint8_t *)V + 2 * V_size);
+	S = (uint8_t *)XY + 2 * XY_size;
+	B[0] = S + 2 * Sbytes;
+	B[1] = B[0] + B_size;
+	ctx.S0 = S;
+	ctx.S1 = S + 2 * Swidth_to_Sbytes1(Swidth_1_0);
+	ctx.S2 = S + 4 * Swidth_to_Sbytes1(Swidth_1_0);
+	ctx.w = 0;
+	ctx.Sbytes = (uint32_t)Sbytes;
+
+	if (!pers)
+		perslen = 0;
+
+	for (l = 0; l < 2; l++) {
+		SHA256_Buf(src[l], srclen, sha256[l]);
+		PBKDF2_SHA256(sha256[l], sizeof(sha256[l]), pers, perslen, 1, B[l], 128);
+		memcpy(sha256[l], B[l], sizeof(sha256[l]));
+	}
+
+	smix_dual(B, r, N, V, XY, &ctx);
+
+	for (l = 0; l < 2; l++) {
+		HMAC_SHA256_Buf(B[l] + B_size - 64, 64,
+		    sha256[l], sizeof(sha256[l]), (uint8_t *)dst[l]);
+	}
+
+	/* Success! */
+	return 0;
+
+fail:
+	memset(dst[0], 0xff, sizeof(*dst[0]));
+	memset(dst[1], 0xff, sizeof(*dst[1]));
+	return -1;
+}
+
+#else /* !defined(__AVX2__) */
+
+int yespower_2way(yespower_local_t *local,
+    const uint8_t *const src[2], size_t srclen,
+    const yespower_params_t *params,
+    yespower_binary_t *const dst[2])
+{
+	int rc0 = yespower(local, src[0], srclen, params, dst[0]);
+	int rc1 = yespower(local, src[1], srclen, params, dst[1]);
+	return (rc0 || rc1) ? -1 : 0;
+}
+#endif
@@ -1158,4 +1158,6 @@ int yespower_free_local(yespower_local_t *local)
 {
 	return free_region(local);
 }
+
+#include "yespower-2way.c"
 #endif
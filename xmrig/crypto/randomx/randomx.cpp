@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/vm_compiled.hpp"
 #include "crypto/randomx/vm_compiled_light.hpp"
 #include "crypto/randomx/blake2/blake2.h"
+#include "crypto/randomx/superscalar.hpp"
 
 #if defined(_M_X64) || defined(__x86_64__)
 #include "crypto/randomx/jit_compiler_x86_static.hpp"
@@ -43,7 +44,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "backend/cpu/Cpu.h"
 #include "crypto/common/VirtualMemory.h"
+#include <cstring>
 #include <mutex>
+#include <vector>
 
 #include <cassert>
 
@@ -238,6 +241,11 @@ void randomx_set_scratchpad_prefetch_mode(int mode)
 	scratchpadPrefetchMode = mode;
 }
 
+int randomx_get_scratchpad_prefetch_mode()
+{
+	return scratchpadPrefetchMode;
+}
+
 void RandomX_ConfigurationBase::Apply()
 {
 	const uint32_t ScratchpadL1Mask_Calculated = (ScratchpadL1_Size / sizeof(uint64_t) - 1) * 8;
@@ -297,9 +305,11 @@ void RandomX_ConfigurationBase::Apply()
 
 typedef void(randomx::JitCompilerX86::* InstructionGeneratorX86_2)(const randomx::Instruction&);
 
+static_assert(sizeof(InstructionGeneratorX86_2) * 256 <= sizeof(RandomX_ConfigurationBase::JitEngine_Calculated), "JIT handler table doesn't fit");
+
 #define JIT_HANDLE(x, prev) do { \
 		const InstructionGeneratorX86_2 p = &randomx::JitCompilerX86::h_##x; \
-		memcpy(randomx::JitCompilerX86::engine + k, &p, sizeof(p)); \
+		memcpy(JitEngine_Calculated + k * sizeof(randomx::InstructionGeneratorX86), &p, sizeof(p)); \
 	} while (0)
 
 #elif defined(XMRIG_ARMv8)
@@ -310,7 +320,12 @@ typedef void(randomx::JitCompilerX86::* InstructionGeneratorX86_2)(const randomx
 	Log2_DatasetBaseSize = Log2(DatasetBaseSize);
 	Log2_CacheSize = Log2((ArgonMemory * randomx::ArgonBlockSize) / randomx::CacheLineSize);
 
-#define JIT_HANDLE(x, prev) randomx::JitCompilerA64::engine[k] = &randomx::JitCompilerA64::h_##x
+static_assert(sizeof(randomx::InstructionGeneratorA64) * 256 <= sizeof(RandomX_ConfigurationBase::JitEngine_Calculated), "JIT handler table doesn't fit");
+
+#define JIT_HANDLE(x, prev) do { \
+		const randomx::InstructionGeneratorA64 p = &randomx::JitCompilerA64::h_##x; \
+		memcpy(JitEngine_Calculated + k * sizeof(p), &p, sizeof(p)); \
+	} while (0)
 
 #else
 #define JIT_HANDLE(x, prev)
@@ -399,18 +414,162 @@ RandomX_ConfigurationKeva RandomX_KevaConfig;
 RandomX_ConfigurationScala RandomX_ScalaConfig;
 RandomX_ConfigurationGraft RandomX_GraftConfig;
 
-alignas(64) RandomX_ConfigurationBase RandomX_CurrentConfig;
+alignas(64) static RandomX_ConfigurationBase RandomX_DefaultConfig;
+thread_local RandomX_ConfigurationBase* RandomX_CurrentConfigPtr = &RandomX_DefaultConfig;
+
+// Applied copies of the configs passed to randomx_apply_config, one per config object and
+// scratchpad prefetch mode. They are never released: caches and VMs of other threads keep
+// running code generated from them.
+struct AppliedConfig {
+	const RandomX_ConfigurationBase* source;
+	int prefetchMode;
+	RandomX_ConfigurationBase* applied;
+};
+
+static std::mutex applied_configs_mutex;
+static std::vector<AppliedConfig> applied_configs;
+
+RandomX_ConfigurationBase* randomx_applied_config(const RandomX_ConfigurationBase& config)
+{
+	static thread_local AppliedConfig last = {};
+	if (last.source == &config && last.prefetchMode == scratchpadPrefetchMode) {
+		return last.applied;
+	}
+
+	std::lock_guard<std::mutex> lock(applied_configs_mutex);
+
+	for (const AppliedConfig& c : applied_configs) {
+		if (c.source == &config && c.prefetchMode == scratchpadPrefetchMode) {
+			last = c;
+			return c.applied;
+		}
+	}
+
+	RandomX_ConfigurationBase* applied = new(rx_aligned_alloc(sizeof(RandomX_ConfigurationBase), 64)) RandomX_ConfigurationBase(config);
+	applied->Apply();
+
+	last = { &config, scratchpadPrefetchMode, applied };
+	applied_configs.push_back(last);
+
+	return applied;
+}
+
+// VMs are carved from per NUMA node chunks which are never unmapped. randomx_destroy_vm keeps
+// the VM constructed and puts it on the free list of its node and kind, so the next
+// randomx_create_vm with the same flags reuses it together with its JIT code buffer. JIT
+// buffers are allocated at construction, so the huge pages JIT setting is part of the kind.
+static constexpr uint32_t VM_POOL_NODES     = 64;
+static constexpr size_t   VM_POOL_CHUNK     = 2 * 1024 * 1024;
+static constexpr size_t   VM_SLOT_HEADER    = 64;
+static constexpr uint32_t VM_POOL_KIND_MASK = RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES;
+static constexpr uint32_t VM_POOL_HUGE_JIT  = 16;
+
+static_assert(VM_POOL_HUGE_JIT > VM_POOL_KIND_MASK, "Huge pages JIT bit overlaps the VM kind flags");
+
+struct VmSlot {
+	uint32_t node;
+	uint32_t kind;
+};
+
+struct VmPool {
+	uint8_t* chunk = nullptr;
+	size_t offset  = VM_POOL_CHUNK;
+	std::vector<randomx_vm*> free[VM_POOL_HUGE_JIT * 2];
+};
 
 static std::mutex vm_pool_mutex;
+static VmPool vm_pools[VM_POOL_NODES];
+
+// constexpr std::max of a list needs C++14
+static constexpr size_t vm_pool_max(size_t a) { return a; }
+
+template<typename... T>
+static constexpr size_t vm_pool_max(size_t a, size_t b, T... rest) { return vm_pool_max(a > b ? a : b, rest...); }
+
+static randomx_vm* vm_pool_construct(VmPool& pool, uint32_t node, uint32_t kind) {
+	static constexpr size_t max_vm_size = vm_pool_max(
+		sizeof(randomx::InterpretedLightVmDefault), sizeof(randomx::InterpretedVmDefault),
+		sizeof(randomx::CompiledLightVmDefault),    sizeof(randomx::CompiledVmDefault),
+		sizeof(randomx::InterpretedLightVmHardAes), sizeof(randomx::InterpretedVmHardAes),
+		sizeof(randomx::CompiledLightVmHardAes),    sizeof(randomx::CompiledVmHardAes)
+	);
+	static constexpr size_t slot_size = (VM_SLOT_HEADER + max_vm_size + 63) & ~size_t(63);
+	static_assert(slot_size <= VM_POOL_CHUNK, "RandomX VM doesn't fit into a pool chunk");
+
+	uint8_t* slot;
+	{
+		std::lock_guard<std::mutex> lock(vm_pool_mutex);
+
+		if (pool.offset + slot_size > VM_POOL_CHUNK) {
+			uint8_t* chunk = (uint8_t*) xmrig::VirtualMemory::allocateLargePagesMemory(VM_POOL_CHUNK);
+			if (!chunk) {
+				chunk = (uint8_t*) rx_aligned_alloc(VM_POOL_CHUNK, 4096);
+			}
+			if (!chunk) {
+				throw std::bad_alloc();
+			}
 
-int rx_yespower_k12(void *out, size_t outlen, const void *in, size_t inlen)
+			pool.chunk  = chunk;
+			pool.offset = 0;
+		}
+
+		slot = pool.chunk + pool.offset;
+		pool.offset += slot_size;
+	}
+
+	VmSlot* header = reinterpret_cast<VmSlot*>(slot);
+	header->node = node;
+	header->kind = kind;
+
+	void* p = slot + VM_SLOT_HEADER;
+	switch (kind & VM_POOL_KIND_MASK) {
+		case RANDOMX_FLAG_DEFAULT:                                             return new(p) randomx::InterpretedLightVmDefault();
+		case RANDOMX_FLAG_FULL_MEM:                                            return new(p) randomx::InterpretedVmDefault();
+		case RANDOMX_FLAG_JIT:                                                 return new(p) randomx::CompiledLightVmDefault();
+		case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT:                         return new(p) randomx::CompiledVmDefault();
+		case RANDOMX_FLAG_HARD_AES:                                            return new(p) randomx::InterpretedLightVmHardAes();
+		case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_HARD_AES:                    return new(p) randomx::InterpretedVmHardAes();
+		case RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES:                         return new(p) randomx::CompiledLightVmHardAes();
+		case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES: return new(p) randomx::CompiledVmHardAes();
+		default: UNREACHABLE;
+	}
+}
+
+static const yespower_params_t rx_yespower_params = { YESPOWER_1_0, 2048, 8, NULL, 0 };
+
+// Without an arena yespower keeps a thread local allocation which lives as long as the thread
+int rx_yespower_k12(yespower_local_t *local, void *out, size_t outlen, const void *in, size_t inlen)
 {
 	rx_blake2b_wrapper::run(out, outlen, in, inlen);
-	yespower_params_t params = { YESPOWER_1_0, 2048, 8, NULL };
-	if (yespower_tls((const uint8_t *)out, outlen, &params, (yespower_binary_t *)out)) return -1;
+	const int rc = local ? yespower(local, (const uint8_t *)out, outlen, &rx_yespower_params, (yespower_binary_t *)out)
+	                     : yespower_tls((const uint8_t *)out, outlen, &rx_yespower_params, (yespower_binary_t *)out);
+	if (rc) return -1;
 	return KangarooTwelve((const unsigned char *)out, outlen, (unsigned char *)out, 32, 0, 0);
 }
 
+// The yespower stages of both inputs run interleaved, which is where nearly all the time goes.
+// That needs twice the memory, so without an arena they run one after the other.
+static int rx_yespower_k12_2way(yespower_local_t *local, uint64_t (&out)[2][8], const void *const in[2], size_t inlen)
+{
+	if (!local) {
+		const int rc0 = rx_yespower_k12(nullptr, out[0], sizeof(out[0]), in[0], inlen);
+		const int rc1 = rx_yespower_k12(nullptr, out[1], sizeof(out[1]), in[1], inlen);
+		return (rc0 || rc1) ? -1 : 0;
+	}
+
+	rx_blake2b_wrapper::run(out[0], sizeof(out[0]), in[0], inlen);
+	rx_blake2b_wrapper::run(out[1], sizeof(out[1]), in[1], inlen);
+
+	const uint8_t *src[2] = { reinterpret_cast<const uint8_t *>(out[0]), reinterpret_cast<const uint8_t *>(out[1]) };
+	yespower_binary_t *dst[2] = { reinterpret_cast<yespower_binary_t *>(out[0]), reinterpret_cast<yespower_binary_t *>(out[1]) };
+	if (yespower_2way(local, src, sizeof(out[0]), &rx_yespower_params, dst)) return -1;
+
+	for (auto &hash : out) {
+		if (KangarooTwelve(reinterpret_cast<const unsigned char *>(hash), sizeof(hash), reinterpret_cast<unsigned char *>(hash), 32, 0, 0)) return -1;
+	}
+	return 0;
+}
+
 extern "C" {
 
 	randomx_cache *randomx_create_cache(randomx_flags flags, uint8_t *memory) {
@@ -457,7 +616,95 @@ extern "C" {
 		cache->initialize(cache, key, keySize);
 	}
 
+	// Serialized programs: for each of CacheAccesses programs its size, address register and
+	// instructions, followed by the reciprocal count and the reciprocals.
+	size_t randomx_cache_programs_size(randomx_cache *cache) {
+		assert(cache != nullptr && cache->isInitialized());
+		size_t size = sizeof(uint32_t);
+		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
+			size += 2 * sizeof(uint32_t) + cache->programs[i].getSize() * sizeof(randomx::Instruction);
+		}
+		return size + cache->reciprocalCache.size() * sizeof(uint64_t);
+	}
+
+	size_t randomx_cache_programs_max_size() {
+		// Every instruction of a program can add one reciprocal
+		const size_t program = 2 * sizeof(uint32_t) + randomx::SuperscalarMaxSize * (sizeof(randomx::Instruction) + sizeof(uint64_t));
+		return sizeof(uint32_t) + RandomX_CurrentConfig.CacheAccesses * program;
+	}
+
+	void randomx_save_cache_programs(randomx_cache *cache, void *out) {
+		assert(cache != nullptr && cache->isInitialized());
+		uint8_t* p = static_cast<uint8_t*>(out);
+		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
+			randomx::SuperscalarProgram& prog = cache->programs[i];
+			const uint32_t header[2] = { prog.getSize(), static_cast<uint32_t>(prog.getAddressRegister()) };
+			memcpy(p, header, sizeof(header));
+			memcpy(p + sizeof(header), prog.programBuffer, prog.getSize() * sizeof(randomx::Instruction));
+			p += sizeof(header) + prog.getSize() * sizeof(randomx::Instruction);
+		}
+		const uint32_t count = static_cast<uint32_t>(cache->reciprocalCache.size());
+		memcpy(p, &count, sizeof(count));
+		memcpy(p + sizeof(count), cache->reciprocalCache.data(), count * sizeof(uint64_t));
+	}
+
+	bool randomx_load_cache_programs(randomx_cache *cache, const void *in, size_t size) {
+		assert(cache != nullptr);
+		cache->timing = randomx_cache_timing();
+		const uint8_t* p = static_cast<const uint8_t*>(in);
+		const uint8_t* end = p + size;
+		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
+			uint32_t header[2];
+			if (end - p < static_cast<ptrdiff_t>(sizeof(header))) {
+				return false;
+			}
+			memcpy(header, p, sizeof(header));
+			p += sizeof(header);
+			if (header[0] == 0 || header[0] > randomx::SuperscalarMaxSize || header[1] >= 8 || static_cast<size_t>(end - p) < header[0] * sizeof(randomx::Instruction)) {
+				return false;
+			}
+			randomx::SuperscalarProgram& prog = cache->programs[i];
+			prog.setSize(header[0]);
+			prog.setAddressRegister(header[1]);
+			memcpy(prog.programBuffer, p, header[0] * sizeof(randomx::Instruction));
+			p += header[0] * sizeof(randomx::Instruction);
+		}
+		uint32_t count;
+		if (end - p < static_cast<ptrdiff_t>(sizeof(count))) {
+			return false;
+		}
+		memcpy(&count, p, sizeof(count));
+		p += sizeof(count);
+		if (static_cast<size_t>(end - p) != count * sizeof(uint64_t)) {
+			return false;
+		}
+		cache->reciprocalCache.resize(count);
+		memcpy(cache->reciprocalCache.data(), p, count * sizeof(uint64_t));
+
+		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
+			randomx::SuperscalarProgram& prog = cache->programs[i];
+			for (uint32_t j = 0; j < prog.getSize(); ++j) {
+				const auto type = static_cast<randomx::SuperscalarInstructionType>(prog(j).opcode);
+				if (type >= randomx::SuperscalarInstructionType::COUNT || (type == randomx::SuperscalarInstructionType::IMUL_RCP && prog(j).getImm32() >= count)) {
+					return false;
+				}
+			}
+		}
+
+		if (cache->jit) {
+			cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache);
+			cache->jit->generateDatasetInitCode();
+		}
+		return true;
+	}
+
+	randomx_cache_timing randomx_get_cache_timing(randomx_cache* cache) {
+		assert(cache != nullptr);
+		return cache->timing;
+	}
+
 	void randomx_release_cache(randomx_cache* cache) {
+		delete cache->jit;
 		delete cache;
 	}
 
@@ -500,74 +747,29 @@ extern "C" {
 		assert(cache == nullptr || cache->isInitialized());
 		assert(dataset != nullptr || !(flags & RANDOMX_FLAG_FULL_MEM));
 
-		randomx_vm* vm = nullptr;
-
-		std::lock_guard<std::mutex> lock(vm_pool_mutex);
-
-		static uint8_t* vm_pool[64] = {};
-		static size_t vm_pool_offset[64] = {};
-
-		constexpr size_t VM_POOL_SIZE = 2 * 1024 * 1024;
-
-		if (node >= 64) {
+		if (node >= VM_POOL_NODES) {
 			node = 0;
 		}
 
-		if (!vm_pool[node]) {
-			vm_pool[node] = (uint8_t*) xmrig::VirtualMemory::allocateLargePagesMemory(VM_POOL_SIZE);
-			if (!vm_pool[node]) {
-				vm_pool[node] = (uint8_t*) rx_aligned_alloc(VM_POOL_SIZE, 4096);
-			}
+		uint32_t kind = flags & VM_POOL_KIND_MASK;
+		if ((flags & RANDOMX_FLAG_JIT) && randomx_get_huge_pages_jit()) {
+			kind |= VM_POOL_HUGE_JIT;
 		}
+		VmPool& pool = vm_pools[node];
+		randomx_vm* vm = nullptr;
 
+		{
+			std::lock_guard<std::mutex> lock(vm_pool_mutex);
 
-		void* p = vm_pool[node] + vm_pool_offset[node];
-		size_t vm_size = 0;
+			if (!pool.free[kind].empty()) {
+				vm = pool.free[kind].back();
+				pool.free[kind].pop_back();
+			}
+		}
 
 		try {
-			switch (flags & (RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES)) {
-				case RANDOMX_FLAG_DEFAULT:
-					vm = new(p) randomx::InterpretedLightVmDefault();
-					vm_size = sizeof(randomx::InterpretedLightVmDefault);
-					break;
-
-				case RANDOMX_FLAG_FULL_MEM:
-					vm = new(p) randomx::InterpretedVmDefault();
-					vm_size = sizeof(randomx::InterpretedVmDefault);
-					break;
-
-				case RANDOMX_FLAG_JIT:
-					vm = new(p) randomx::CompiledLightVmDefault();
-					vm_size = sizeof(randomx::CompiledLightVmDefault);
-					break;
-
-				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT:
-					vm = new(p) randomx::CompiledVmDefault();
-					vm_size = sizeof(randomx::CompiledVmDefault);
-					break;
-
-				case RANDOMX_FLAG_HARD_AES:
-					vm = new(p) randomx::InterpretedLightVmHardAes();
-					vm_size = sizeof(randomx::InterpretedLightVmHardAes);
-					break;
-
-				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_HARD_AES:
-					vm = new(p) randomx::InterpretedVmHardAes();
-					vm_size = sizeof(randomx::InterpretedVmHardAes);
-					break;
-
-				case RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES:
-					vm = new(p) randomx::CompiledLightVmHardAes();
-					vm_size = sizeof(randomx::CompiledLightVmHardAes);
-					break;
-
-				case RANDOMX_FLAG_FULL_MEM | RANDOMX_FLAG_JIT | RANDOMX_FLAG_HARD_AES:
-					vm = new(p) randomx::CompiledVmHardAes();
-					vm_size = sizeof(randomx::CompiledVmHardAes);
-					break;
-
-				default:
-					UNREACHABLE;
+			if (!vm) {
+				vm = vm_pool_construct(pool, node, kind);
 			}
 
 			if (cache != nullptr) {
@@ -579,17 +781,14 @@ extern "C" {
 			}
 
 			vm->setScratchpad(scratchpad);
+			vm->setYespowerArena(nullptr, 0);
 			vm->setFlags(flags);
 		}
 		catch (std::exception &ex) {
-			vm = nullptr;
-		}
-
-		if (vm) {
-			vm_pool_offset[node] += vm_size;
-			if (vm_pool_offset[node] + 4096 > VM_POOL_SIZE) {
-				vm_pool_offset[node] = 0;
+			if (vm) {
+				randomx_destroy_vm(vm);
 			}
+			vm = nullptr;
 		}
 
 		return vm;
@@ -607,8 +806,23 @@ extern "C" {
 		machine->setDataset(dataset);
 	}
 
+	size_t randomx_yespower_arena_size() {
+		// B, V, XY and the three 32 KiB S-boxes of yespower, for both lanes of yespower_2way()
+		const size_t B = 128 * rx_yespower_params.r;
+		return 2 * (B + B * rx_yespower_params.N + B + 64 + 3 * 32 * 1024);
+	}
+
+	void randomx_vm_set_yespower_arena(randomx_vm *machine, void *arena, size_t size) {
+		assert(machine != nullptr);
+		assert(arena == nullptr || size >= randomx_yespower_arena_size());
+		machine->setYespowerArena(arena, size);
+	}
+
 	void randomx_destroy_vm(randomx_vm* vm) {
-		vm->~randomx_vm();
+		const VmSlot* slot = reinterpret_cast<const VmSlot*>(reinterpret_cast<uint8_t*>(vm) - VM_SLOT_HEADER);
+
+		std::lock_guard<std::mutex> lock(vm_pool_mutex);
+		vm_pools[slot->node].free[slot->kind].push_back(vm);
 	}
 
 	void randomx_calculate_hash(randomx_vm *machine, const void *input, size_t inputSize, void *output, const xmrig::Algorithm algo) {
@@ -617,7 +831,7 @@ extern "C" {
 		assert(output != nullptr);
 		alignas(16) uint64_t tempHash[8];
                 switch (algo) {
-                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(tempHash, sizeof(tempHash), input, inputSize); break;
+                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(machine->getYespowerArena(), tempHash, sizeof(tempHash), input, inputSize); break;
 		    default: rx_blake2b_wrapper::run(tempHash, sizeof(tempHash), input, inputSize);
 		}
 		machine->initScratchpad(&tempHash);
@@ -630,9 +844,32 @@ extern "C" {
 		machine->getFinalResult(output);
 	}
 
+	void randomx_calculate_hash_2(randomx_vm *machine, const void *const input[2], size_t inputSize, void *const output[2], const xmrig::Algorithm algo) {
+		assert(machine != nullptr);
+		assert(inputSize == 0 || (input[0] != nullptr && input[1] != nullptr));
+		assert(output[0] != nullptr && output[1] != nullptr);
+		alignas(16) uint64_t tempHash[2][8];
+		switch (algo) {
+			case xmrig::Algorithm::RX_XLA: rx_yespower_k12_2way(machine->getYespowerArena(), tempHash, input, inputSize); break;
+			default:
+				rx_blake2b_wrapper::run(tempHash[0], sizeof(tempHash[0]), input[0], inputSize);
+				rx_blake2b_wrapper::run(tempHash[1], sizeof(tempHash[1]), input[1], inputSize);
+		}
+		for (int i = 0; i < 2; ++i) {
+			machine->initScratchpad(&tempHash[i]);
+			machine->resetRoundingMode();
+			for (uint32_t chain = 0; chain < RandomX_CurrentConfig.ProgramCount - 1; ++chain) {
+				machine->run(&tempHash[i]);
+				rx_blake2b_wrapper::run(tempHash[i], sizeof(tempHash[i]), machine->getRegisterFile(), sizeof(randomx::RegisterFile));
+			}
+			machine->run(&tempHash[i]);
+			machine->getFinalResult(output[i]);
+		}
+	}
+
 	void randomx_calculate_hash_first(randomx_vm* machine, uint64_t (&tempHash)[8], const void* input, size_t inputSize, const xmrig::Algorithm algo) {
                 switch (algo) {
-                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(tempHash, sizeof(tempHash), input, inputSize); break;
+                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(machine->getYespowerArena(), tempHash, sizeof(tempHash), input, inputSize); break;
 		    default: rx_blake2b_wrapper::run(tempHash, sizeof(tempHash), input, inputSize);
 		}
 		machine->initScratchpad(tempHash);
@@ -650,7 +887,7 @@ extern "C" {
 
 		// Finish current hash and fill the scratchpad for the next hash at the same time
                 switch (algo) {
-                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(tempHash, sizeof(tempHash), nextInput, nextInputSize); break;
+                    case xmrig::Algorithm::RX_XLA:   rx_yespower_k12(machine->getYespowerArena(), tempHash, sizeof(tempHash), nextInput, nextInputSize); break;
 		    default: rx_blake2b_wrapper::run(tempHash, sizeof(tempHash), nextInput, nextInputSize);
 		}
 		machine->hashAndFill(output, tempHash);
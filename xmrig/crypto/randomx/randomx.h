@@ -58,6 +58,14 @@ struct randomx_dataset;
 struct randomx_cache;
 class randomx_vm;
 
+// Wall time of randomx_init_cache in nanoseconds. The SuperscalarHash programs (and their JIT
+// code) are generated on a helper thread during the Argon2d fill, so total is about the larger one.
+struct randomx_cache_timing {
+  uint64_t argon2;
+  uint64_t superscalar;
+  uint64_t total;
+};
+
 
 struct RandomX_ConfigurationBase
 {
@@ -139,6 +147,11 @@ struct RandomX_ConfigurationBase
 	uint32_t ScratchpadL3Mask_Calculated;
 	uint32_t ScratchpadL3Mask64_Calculated;
 
+#if defined(_M_X64) || defined(__x86_64__) || defined(XMRIG_ARMv8)
+	// JIT compiler instruction handlers (member function pointers) by opcode
+	alignas(64) uint8_t JitEngine_Calculated[256 * 16];
+#endif
+
 #if defined(XMRIG_ARMv8)
 	uint32_t Log2_ScratchpadL1;
 	uint32_t Log2_ScratchpadL2;
@@ -164,19 +177,27 @@ extern RandomX_ConfigurationKeva RandomX_KevaConfig;
 extern RandomX_ConfigurationScala RandomX_ScalaConfig;
 extern RandomX_ConfigurationGraft RandomX_GraftConfig;
 
-extern RandomX_ConfigurationBase RandomX_CurrentConfig;
+// Configuration used by the calling thread: each thread can hash a different RandomX variant
+extern thread_local RandomX_ConfigurationBase* RandomX_CurrentConfigPtr;
+#define RandomX_CurrentConfig (*RandomX_CurrentConfigPtr)
+
+RandomX_ConfigurationBase* randomx_applied_config(const RandomX_ConfigurationBase& config);
 
+// Selects the configuration for the calling thread. Every config object is applied (tweaked code
+// templates, JIT handlers) only once and is identified by its address, so it must not be changed
+// after it was first used.
 template<typename T>
 void randomx_apply_config(const T& config)
 {
 	static_assert(sizeof(T) == sizeof(RandomX_ConfigurationBase), "Invalid RandomX configuration struct size");
 	static_assert(std::is_base_of<RandomX_ConfigurationBase, T>::value, "Incompatible RandomX configuration struct");
-	RandomX_CurrentConfig = config;
-	RandomX_CurrentConfig.Apply();
+	RandomX_CurrentConfigPtr = randomx_applied_config(config);
 }
 
 void randomx_set_scratchpad_prefetch_mode(int mode);
+int randomx_get_scratchpad_prefetch_mode();
 void randomx_set_huge_pages_jit(bool hugePages);
+bool randomx_get_huge_pages_jit();
 
 #if defined(__cplusplus)
 extern "C" {
@@ -205,6 +226,50 @@ RANDOMX_EXPORT randomx_cache *randomx_create_cache(randomx_flags flags, uint8_t
 */
 RANDOMX_EXPORT void randomx_init_cache(randomx_cache *cache, const void *key, size_t keySize);
 
+/**
+ * Returns how long the last randomx_init_cache of the cache took, all zero for caches
+ * initialized by randomx_load_cache_programs.
+ *
+ * @param cache is a pointer to a randomx_cache structure. Must not be NULL.
+*/
+RANDOMX_EXPORT randomx_cache_timing randomx_get_cache_timing(randomx_cache *cache);
+
+/**
+ * Returns the size of the serialized SuperscalarHash programs of an initialized cache,
+ * see randomx_save_cache_programs.
+ *
+ * @param cache is a pointer to an initialized randomx_cache structure. Must not be NULL.
+*/
+RANDOMX_EXPORT size_t randomx_cache_programs_size(randomx_cache *cache);
+
+/**
+ * Returns an upper bound of randomx_cache_programs_size for any cache of the current
+ * configuration, for callers which reserve the space before the cache is initialized.
+*/
+RANDOMX_EXPORT size_t randomx_cache_programs_max_size();
+
+/**
+ * Serializes the SuperscalarHash programs and reciprocals of an initialized cache.
+ * Together with the cache memory this is everything randomx_init_cache computes.
+ *
+ * @param cache is a pointer to an initialized randomx_cache structure. Must not be NULL.
+ * @param out is a pointer to randomx_cache_programs_size(cache) bytes. Must not be NULL.
+*/
+RANDOMX_EXPORT void randomx_save_cache_programs(randomx_cache *cache, void *out);
+
+/**
+ * Initializes a cache from its memory (already filled in by the caller) and programs serialized
+ * by randomx_save_cache_programs under the same RandomX configuration, instead of running
+ * randomx_init_cache.
+ *
+ * @param cache is a pointer to a previously allocated randomx_cache structure. Must not be NULL.
+ * @param in is a pointer to the serialized programs. Must not be NULL.
+ * @param size is the number of bytes at in.
+ *
+ * @return false if the serialized programs are malformed.
+*/
+RANDOMX_EXPORT bool randomx_load_cache_programs(randomx_cache *cache, const void *in, size_t size);
+
 /**
  * Releases all memory occupied by the randomx_cache structure.
  *
@@ -304,6 +369,23 @@ RANDOMX_EXPORT void randomx_vm_set_cache(randomx_vm *machine, randomx_cache* cac
 */
 RANDOMX_EXPORT void randomx_vm_set_dataset(randomx_vm *machine, randomx_dataset *dataset);
 
+/**
+ * Returns the size of the memory randomx_vm_set_yespower_arena expects.
+*/
+RANDOMX_EXPORT size_t randomx_yespower_arena_size();
+
+/**
+ * Sets the memory used by the yespower stage of RandomX Scala hashes. Without it
+ * the memory is allocated per thread and kept until the thread exits.
+ *
+ * @param machine is a pointer to a randomx_vm structure. Must not be NULL.
+ * @param arena is a pointer to at least randomx_yespower_arena_size() bytes aligned to
+ *        64 bytes, owned by the caller until the machine is destroyed or gets another
+ *        arena. NULL goes back to the per thread memory.
+ * @param size is the size of the arena.
+*/
+RANDOMX_EXPORT void randomx_vm_set_yespower_arena(randomx_vm *machine, void *arena, size_t size);
+
 /**
  * Releases all memory occupied by the randomx_vm structure.
  *
@@ -322,6 +404,18 @@ RANDOMX_EXPORT void randomx_destroy_vm(randomx_vm *machine);
 */
 RANDOMX_EXPORT void randomx_calculate_hash(randomx_vm *machine, const void *input, size_t inputSize, void *output, const xmrig::Algorithm algo);
 
+/**
+ * Calculates two RandomX hashes of inputs of the same size. For RandomX Scala the
+ * yespower stages of both run together, which is faster than two randomx_calculate_hash calls.
+ *
+ * @param machine is a pointer to a randomx_vm structure. Must not be NULL.
+ * @param input are pointers to the memory to be hashed. Must not be NULL.
+ * @param inputSize is the number of bytes to be hashed of each input.
+ * @param output are pointers to memory where the hashes will be stored. Must not
+ *        be NULL and at least RANDOMX_HASH_SIZE bytes must be available for writing.
+*/
+RANDOMX_EXPORT void randomx_calculate_hash_2(randomx_vm *machine, const void *const input[2], size_t inputSize, void *const output[2], const xmrig::Algorithm algo);
+
 RANDOMX_EXPORT void randomx_calculate_hash_first(randomx_vm* machine, uint64_t (&tempHash)[8], const void* input, size_t inputSize, const xmrig::Algorithm algo);
 RANDOMX_EXPORT void randomx_calculate_hash_next(randomx_vm* machine, uint64_t (&tempHash)[8], const void* nextInput, size_t nextInputSize, void* output, const xmrig::Algorithm algo);
 
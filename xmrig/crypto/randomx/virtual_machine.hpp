@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstdint>
 #include "crypto/randomx/common.hpp"
 #include "crypto/randomx/program.hpp"
+#include "crypto/randomx/panthera/yespower.h"
 
 /* Global namespace for C binding */
 class randomx_vm
@@ -62,6 +63,17 @@ public:
 		return program;
 	}
 
+	// Caller owned memory for the yespower stage of RandomX Scala, nullptr for the thread local one
+	void setYespowerArena(void* arena, size_t size) {
+		yespower_free_local(&yespowerArena);
+		yespowerArena.aligned = arena;
+		yespowerArena.aligned_size = arena ? size : 0;
+	}
+
+	yespower_local_t* getYespowerArena() {
+		return yespowerArena.aligned ? &yespowerArena : nullptr;
+	}
+
 protected:
 	void initialize();
 	alignas(64) randomx::Program program;
@@ -75,6 +87,7 @@ protected:
 	};
 	uint64_t datasetOffset;
 	uint32_t vm_flags;
+	yespower_local_t yespowerArena = {};
 };
 
 namespace randomx {
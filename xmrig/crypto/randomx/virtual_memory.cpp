@@ -43,6 +43,21 @@ void* allocExecutableMemory(std::size_t bytes, bool hugePages) {
 }
 
 
+void* allocDualMappedMemory(std::size_t bytes, bool hugePages, void** rw, std::size_t* mapped) {
+    void *mem = xmrig::VirtualMemory::allocateDualMappedMemory(bytes, hugePages, rw, mapped);
+    if (mem == nullptr) {
+        throw std::runtime_error("Failed to allocate executable memory");
+    }
+
+    return mem;
+}
+
+
+void freeDualMappedMemory(void* rx, void* rw, std::size_t bytes) {
+    xmrig::VirtualMemory::freeDualMappedMemory(rx, rw, bytes);
+}
+
+
 void* allocLargePagesMemory(std::size_t bytes) {
     void *mem = xmrig::VirtualMemory::allocateLargePagesMemory(bytes);
     if (mem == nullptr) {
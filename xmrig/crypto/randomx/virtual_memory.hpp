@@ -31,5 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstddef>
 
 void* allocExecutableMemory(std::size_t, bool);
+void* allocDualMappedMemory(std::size_t, bool, void**, std::size_t*);
+void freeDualMappedMemory(void*, void*, std::size_t);
 void* allocLargePagesMemory(std::size_t);
 void freePagedMemory(void*, std::size_t);
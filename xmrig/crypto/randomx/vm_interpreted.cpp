@@ -69,11 +69,22 @@ namespace randomx {
 			for (unsigned i = 0; i < RegistersCount; ++i)
 				nreg.r[i] ^= load64(scratchpad + spAddr0 + 8 * i);
 
+#if defined(__AVX__)
+			//two registers per conversion, f and e lie on aligned cache lines of the register file
+			const __m256d mantissaMask = _mm256_castsi256_pd(_mm256_set1_epi64x(dynamicMantissaMask));
+			const __m256d exponentMask = _mm256_broadcast_pd((const __m128d*)&config.eMask);
+			for (unsigned i = 0; i < RegisterCountFlt; i += 2) {
+				_mm256_store_pd((double*)&nreg.f[i], _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(scratchpad + spAddr1 + 8 * i))));
+				const __m256d e = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(scratchpad + spAddr1 + 8 * (RegisterCountFlt + i))));
+				_mm256_store_pd((double*)&nreg.e[i], _mm256_or_pd(_mm256_and_pd(e, mantissaMask), exponentMask));
+			}
+#else
 			for (unsigned i = 0; i < RegisterCountFlt; ++i)
 				nreg.f[i] = rx_cvt_packed_int_vec_f128(scratchpad + spAddr1 + 8 * i);
 
 			for (unsigned i = 0; i < RegisterCountFlt; ++i)
 				nreg.e[i] = maskRegisterExponentMantissa(config, rx_cvt_packed_int_vec_f128(scratchpad + spAddr1 + 8 * (RegisterCountFlt + i)));
+#endif
 
 			executeBytecode(bytecode, scratchpad, config);
 
@@ -86,11 +97,19 @@ namespace randomx {
 			for (unsigned i = 0; i < RegistersCount; ++i)
 				store64(scratchpad + spAddr1 + 8 * i, nreg.r[i]);
 
+#if defined(__AVX__)
+			for (unsigned i = 0; i < RegisterCountFlt; i += 2) {
+				const __m256d f = _mm256_xor_pd(_mm256_load_pd((const double*)&nreg.f[i]), _mm256_load_pd((const double*)&nreg.e[i]));
+				_mm256_store_pd((double*)&nreg.f[i], f);
+				_mm256_storeu_pd((double*)(scratchpad + spAddr0 + 16 * i), f);
+			}
+#else
 			for (unsigned i = 0; i < RegisterCountFlt; ++i)
 				nreg.f[i] = rx_xor_vec_f128(nreg.f[i], nreg.e[i]);
 
 			for (unsigned i = 0; i < RegisterCountFlt; ++i)
 				rx_store_vec_f128((double*)(scratchpad + spAddr0 + 16 * i), nreg.f[i]);
+#endif
 
 			spAddr0 = 0;
 			spAddr1 = 0;